@@ -1,33 +1,101 @@
-#include "ALU.hpp"
-
-int ALU::add(int op1, int op2) {
-    return op1 + op2;
-}
-
-int ALU::sub(int op1, int op2) {
-    return op1 - op2;
-}
-
-int ALU::mul(int op1, int op2) {
-    return op1 * op2;
-}
-
-int ALU::div(int op1, int op2) {
-    if (op2 == 0) {
-        return 0; // Handle divide-by-zero appropriately.
-    }
-    return op1 / op2;
-}
-
-int ALU::sll(int op1, int op2) {
-    // Use lower 5 bits of op2 as shift amount.
-    return op1 << (op2 & 0x1F);
-}
-
-int ALU::srl(int op1, int op2) {
-    return static_cast<unsigned int>(op1) >> (op2 & 0x1F);
-}
-
-int ALU::sra(int op1, int op2) {
-    return op1 >> (op2 & 0x1F);
-}
+#include "ALU.hpp"
+
+int ALU::add(int op1, int op2) {
+    return op1 + op2;
+}
+
+int ALU::sub(int op1, int op2) {
+    return op1 - op2;
+}
+
+int ALU::mul(int op1, int op2) {
+    return op1 * op2;
+}
+
+int ALU::div(int op1, int op2) {
+    if (op2 == 0) {
+        return 0; // Handle divide-by-zero appropriately.
+    }
+    return op1 / op2;
+}
+
+int ALU::sll(int op1, int op2) {
+    // Use lower 5 bits of op2 as shift amount.
+    return op1 << (op2 & 0x1F);
+}
+
+int ALU::srl(int op1, int op2) {
+    return static_cast<unsigned int>(op1) >> (op2 & 0x1F);
+}
+
+int ALU::sra(int op1, int op2) {
+    return op1 >> (op2 & 0x1F);
+}
+
+int ALU::execute(ALUOp op, int op1, int op2) {
+    switch (op) {
+        case ALUOp::ADD:
+            return add(op1, op2);
+        case ALUOp::SUB:
+            return sub(op1, op2);
+        case ALUOp::MUL:
+            return mul(op1, op2);
+        case ALUOp::DIV:
+            return div(op1, op2);
+        case ALUOp::SLL:
+        case ALUOp::SLLI:
+            return sll(op1, op2);
+        case ALUOp::SRL:
+        case ALUOp::SRLI:
+            return srl(op1, op2);
+        case ALUOp::SRA:
+        case ALUOp::SRAI:
+            return sra(op1, op2);
+        default:
+            return 0;
+    }
+}
+
+uint32_t ALU::amo(ALUOp op, uint32_t old, uint32_t operand) {
+    switch (op) {
+        case ALUOp::AMOSWAP:
+            return operand;
+        case ALUOp::AMOADD:
+            return old + operand;
+        case ALUOp::AMOXOR:
+            return old ^ operand;
+        case ALUOp::AMOAND:
+            return old & operand;
+        case ALUOp::AMOOR:
+            return old | operand;
+        case ALUOp::AMOMIN:
+            return (int32_t)old < (int32_t)operand ? old : operand;
+        case ALUOp::AMOMAX:
+            return (int32_t)old > (int32_t)operand ? old : operand;
+        case ALUOp::AMOMINU:
+            return old < operand ? old : operand;
+        case ALUOp::AMOMAXU:
+            return old > operand ? old : operand;
+        default:
+            return old;
+    }
+}
+
+bool ALU::branchTaken(uint8_t funct3, uint32_t op1, uint32_t op2) {
+    switch (funct3) {
+        case 0: // BEQ
+            return op1 == op2;
+        case 1: // BNE
+            return op1 != op2;
+        case 4: // BLT
+            return (int32_t)op1 < (int32_t)op2;
+        case 5: // BGE
+            return (int32_t)op1 >= (int32_t)op2;
+        case 6: // BLTU
+            return op1 < op2;
+        case 7: // BGEU
+            return op1 >= op2;
+        default:
+            return false;
+    }
+}
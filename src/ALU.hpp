@@ -1,6 +1,8 @@
 #ifndef ALU_HPP
 #define ALU_HPP
 
+#include <cstdint>
+#include "ControlUnit.hpp"
 
 class ALU {
 public:
@@ -11,6 +13,14 @@ public:
     static int sll(int op1, int op2);
     static int srl(int op1, int op2);
     static int sra(int op1, int op2);
+
+    // Dispatches on the resolved ALU operation (NONE yields 0).
+    static int execute(ALUOp op, int op1, int op2);
+    // New memory value of a read-modify-write atomic (AMOSWAP .. AMOMAXU):
+    // op applied to the old memory value and the rs2 operand.
+    static uint32_t amo(ALUOp op, uint32_t old, uint32_t operand);
+    // Evaluates a branch condition (BEQ/BNE/BLT/BGE/BLTU/BGEU by funct3).
+    static bool branchTaken(uint8_t funct3, uint32_t op1, uint32_t op2);
 };
 
 #endif
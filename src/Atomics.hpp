@@ -0,0 +1,46 @@
+#ifndef ATOMICS_HPP
+#define ATOMICS_HPP
+
+#include <cstdint>
+#include "ALU.hpp"
+#include "DataMemory.hpp"
+
+// RV32A semantics on a DataMemory, shared by the pipeline's MEM stage, the
+// functional core and the multicore CoherentMemory. Each hart holds at most
+// one LR.W reservation; SC.W succeeds (writes rd = 0) only if it still holds
+// one for the same address, and always drops it. Other harts' writes to the
+// reserved line cancel it (see CoherentMemory).
+struct Reservation {
+    bool valid = false;
+    uint32_t addr = 0;
+};
+
+namespace Atomics {
+    // Performs the A_TYPE operation op (ALUOp::LR .. AMOMAXU) at addr with
+    // the rs2 value and returns the value for rd. Sets `wrote` if memory changed.
+    inline uint32_t execute(DataMemory &memory, ALUOp op, uint32_t addr, uint32_t value, Reservation &reservation,
+                            bool &wrote) {
+        const uint8_t word = 2;   // funct3 of LW/SW.
+        wrote = false;
+        if (op == ALUOp::LR) {
+            reservation.valid = true;
+            reservation.addr = addr;
+            return memory.load(word, addr);
+        }
+        if (op == ALUOp::SC) {
+            bool held = reservation.valid && reservation.addr == addr;
+            reservation.valid = false;
+            if (!held)
+                return 1;
+            memory.store(word, addr, value);
+            wrote = true;
+            return 0;
+        }
+        uint32_t old = memory.load(word, addr);
+        memory.store(word, addr, ALU::amo(op, old, value));
+        wrote = true;
+        return old;
+    }
+}
+
+#endif // ATOMICS_HPP
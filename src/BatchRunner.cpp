@@ -0,0 +1,124 @@
+#include "BatchRunner.hpp"
+#include "Processor.hpp"
+#include "ThreadPool.hpp"
+#include "ProgramFile.hpp"
+#include "PerfCounters.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace {
+    void runJob(const BatchJob &job, const ProgramFile &program, BatchResult &result) {
+        result.ok = false;
+        result.cycles = 0;
+        result.retired = 0;
+        result.seconds = 0.0;
+        if (program.program.empty()) {
+            result.error = "no instructions in " + job.inputFile;
+            return;
+        }
+        std::ofstream out(job.outputFile);
+        if (!out.is_open()) {
+            result.error = "cannot open " + job.outputFile;
+            return;
+        }
+
+        // Same rule as main: a drain job logs only the table cycles asked for.
+        int cycleCount = job.drain ? (job.cycles > 0 ? job.cycles : INT_MAX) : job.cycles;
+        int logCycles = job.tableCycles < 0 ? (job.drain ? 0 : cycleCount) : std::min(job.tableCycles, cycleCount);
+        // The jobs share the loaded file: each Processor only views its text.
+        Processor processor(program.program, program.hex, job.forwarding, cycleCount, program.labels);
+        processor.logCycleCount = logCycles;
+
+        auto start = std::chrono::steady_clock::now();
+        if (job.drain) {
+            processor.runUntilDrained(job.cycles, 0);
+        } else {
+            for (int cycle = 0; cycle < job.cycles; ++cycle)
+                processor.runCycle();
+        }
+        auto stop = std::chrono::steady_clock::now();
+
+        if (logCycles > 0)
+            processor.printFullPipelineLogSimple(out);
+        if (!job.statsFile.empty() && !PerfReport::writeJson(processor, job.statsFile)) {
+            result.error = "cannot write " + job.statsFile;
+            return;
+        }
+        result.ok = true;
+        result.cycles = processor.currentCycle;
+        result.retired = processor.instructionsRetired;
+        result.seconds = std::chrono::duration<double>(stop - start).count();
+    }
+}
+
+bool readBatchJobs(const std::string &filename, std::vector<BatchJob> &jobs) {
+    std::ifstream infile(filename);
+    if (!infile) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(infile, line)) {
+        ++lineNumber;
+        std::istringstream iss(line);
+        std::string input, mode, cycles;
+        if (!(iss >> input) || input[0] == '#')
+            continue;
+        BatchJob job;
+        job.inputFile = input;
+        job.drain = false;
+        job.cycles = 0;
+        job.tableCycles = -1;
+        bool ok = static_cast<bool>(iss >> mode >> cycles) && (mode == "forward" || mode == "noforward");
+        job.forwarding = (mode == "forward");
+        if (ok && cycles == "drain") {
+            job.drain = true;
+            std::string cap;
+            if (iss >> cap)
+                ok = (std::istringstream(cap) >> job.cycles) && job.cycles >= 0;
+        } else if (ok) {
+            ok = (std::istringstream(cycles) >> job.cycles) && job.cycles >= 0;
+        }
+        std::string table, extra;
+        if (ok && iss >> table)
+            ok = (std::istringstream(table) >> job.tableCycles) && job.tableCycles >= 0 && !(iss >> extra);
+        if (!ok) {
+            std::cerr << filename << ":" << lineNumber
+                      << ": expected <input_file> <forward|noforward> <cycles [table_cycles]|drain [max_cycles [table_cycles]]>" << std::endl;
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+std::vector<BatchResult> runBatch(const std::vector<BatchJob> &jobs, unsigned threads) {
+    ThreadPool pool(threads);
+
+    // Load and decode each distinct input once, in parallel.
+    std::map<std::string, ProgramFile> programs;
+    for (const auto &job : jobs)
+        programs[job.inputFile];
+    for (auto &entry : programs) {
+        const std::string &file = entry.first;
+        ProgramFile &program = entry.second;
+        pool.submit([&file, &program] { program.load(file); });
+    }
+    pool.wait();
+
+    std::vector<BatchResult> results(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob &job = jobs[i];
+        const ProgramFile &program = programs[job.inputFile];
+        BatchResult &result = results[i];
+        pool.submit([&job, &program, &result] { runJob(job, program, result); });
+    }
+    pool.wait();
+    return results;
+}
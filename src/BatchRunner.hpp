@@ -0,0 +1,40 @@
+#ifndef BATCHRUNNER_HPP
+#define BATCHRUNNER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One simulation: an input program, a forwarding mode and how long to run.
+struct BatchJob {
+    std::string inputFile;
+    bool forwarding;
+    bool drain;           // Run until drained instead of a fixed cycle count.
+    int cycles;           // Cycle count, or the drain cycle cap (0 = no cap).
+    int tableCycles;      // Pipeline-table columns; -1 = every cycle run, or none for a drain job.
+    std::string outputFile;
+    std::string statsFile;   // JSON counter report (see PerfCounters.hpp); empty = none.
+};
+
+struct BatchResult {
+    bool ok;
+    std::string error;
+    int cycles;           // Cycles actually simulated.
+    uint64_t retired;
+    double seconds;       // Wall time of the simulation (excluding program load).
+};
+
+// Reads a job list: one job per line, "<input_file> <forward|noforward> <cycles>
+// [table_cycles]" or "<input_file> <forward|noforward> drain [max_cycles
+// [table_cycles]]" (like main's --table-cycles). Blank lines and lines
+// starting with '#' are skipped. Output files are left empty.
+// Returns false (and reports on std::cerr) on a malformed line.
+bool readBatchJobs(const std::string &filename, std::vector<BatchJob> &jobs);
+
+// Runs every job on its own Processor across `threads` workers (0 = all cores).
+// Each distinct input file is read and decoded once and shared by its jobs;
+// each job writes its pipeline table (empty if it has none) to its own outputFile and, if set, its
+// counters to its own statsFile.
+std::vector<BatchResult> runBatch(const std::vector<BatchJob> &jobs, unsigned threads);
+
+#endif // BATCHRUNNER_HPP
@@ -0,0 +1,176 @@
+#include "BranchPredictor.hpp"
+#include <iostream>
+#include <sstream>
+
+namespace {
+    bool isPowerOfTwo(uint32_t x) {
+        return x != 0 && (x & (x - 1)) == 0;
+    }
+
+    bool parseCount(const std::string &text, uint32_t &value) {
+        if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        value = static_cast<uint32_t>(std::stoul(text));
+        return true;
+    }
+
+    // x1 (ra) and x5 (t0) are the link registers of the RISC-V calling convention.
+    bool isLink(uint8_t reg) {
+        return reg == 1 || reg == 5;
+    }
+}
+
+BranchPredictor::BranchPredictor() : BranchPredictor(PredictorConfig()) {}
+
+BranchPredictor::BranchPredictor(const PredictorConfig &config)
+    : cfg(config), history(0), resolved(0), mispredicted(0) {
+    if (enabled()) {
+        counters.assign(cfg.entries, 1);   // Weakly not-taken.
+        btb.assign(cfg.btbEntries, BtbEntry());
+    }
+}
+
+bool BranchPredictor::parseConfig(const std::string &spec, PredictorConfig &config) {
+    PredictorConfig parsed = config;
+    std::stringstream fields(spec);
+    std::string field;
+    bool first = true;
+    while (std::getline(fields, field, ',')) {
+        if (first) {
+            first = false;
+            if (field == "none")
+                parsed.kind = PredictorKind::NONE;
+            else if (field == "not-taken")
+                parsed.kind = PredictorKind::NOT_TAKEN;
+            else if (field == "bimodal")
+                parsed.kind = PredictorKind::BIMODAL;
+            else if (field == "gshare")
+                parsed.kind = PredictorKind::GSHARE;
+            else {
+                std::cerr << "Unknown branch predictor: " << field << std::endl;
+                return false;
+            }
+            continue;
+        }
+        size_t eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+        uint32_t *target = nullptr;
+        if (key == "entries")
+            target = &parsed.entries;
+        else if (key == "history")
+            target = &parsed.historyBits;
+        else if (key == "btb")
+            target = &parsed.btbEntries;
+        else if (key == "ras")
+            target = &parsed.rasDepth;
+        else {
+            std::cerr << "Unknown branch predictor parameter: " << key << std::endl;
+            return false;
+        }
+        if (!parseCount(value, *target)) {
+            std::cerr << "Invalid value for branch predictor parameter " << key << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    if (!isPowerOfTwo(parsed.entries) || !isPowerOfTwo(parsed.btbEntries)) {
+        std::cerr << "Branch predictor and BTB sizes must be powers of two" << std::endl;
+        return false;
+    }
+    if (parsed.historyBits > 31) {
+        std::cerr << "Global history is limited to 31 bits" << std::endl;
+        return false;
+    }
+    config = parsed;
+    return true;
+}
+
+const char *BranchPredictor::kindName(PredictorKind kind) {
+    switch (kind) {
+        case PredictorKind::NOT_TAKEN: return "not-taken";
+        case PredictorKind::BIMODAL: return "bimodal";
+        case PredictorKind::GSHARE: return "gshare";
+        default: return "none";
+    }
+}
+
+BranchPredictor::Kind BranchPredictor::classify(const MicroOp &inst) {
+    if (inst.type == InstType::B_TYPE)
+        return Kind::CONDITIONAL;
+    if (inst.type == InstType::J_TYPE)
+        return isLink(inst.rd) ? Kind::CALL : Kind::JUMP;
+    // JALR. A call that also reads a link register (e.g. jalr ra, 0(t0)) is treated as a call.
+    if (isLink(inst.rd))
+        return Kind::CALL;
+    return isLink(inst.rs1) ? Kind::RETURN : Kind::INDIRECT;
+}
+
+uint32_t BranchPredictor::counterIndex(uint32_t pc) const {
+    uint32_t index = pc >> 2;
+    if (cfg.kind == PredictorKind::GSHARE)
+        index ^= history;
+    return index & (cfg.entries - 1);
+}
+
+bool BranchPredictor::predictTaken(uint32_t pc) const {
+    if (cfg.kind == PredictorKind::NOT_TAKEN)
+        return false;
+    return counters[counterIndex(pc)] >= 2;
+}
+
+uint32_t BranchPredictor::predict(uint32_t pc, uint32_t size) const {
+    if (!enabled())
+        return pc + size;
+    const BtbEntry &entry = btb[(pc >> 2) & (cfg.btbEntries - 1)];
+    if (!entry.valid || entry.pc != pc)
+        return pc + size;
+    switch (entry.kind) {
+        case Kind::CONDITIONAL:
+            return predictTaken(pc) ? entry.target : pc + size;
+        case Kind::RETURN:
+            return ras.empty() ? entry.target : ras.back();
+        default:
+            return entry.target;
+    }
+}
+
+bool BranchPredictor::resolve(uint32_t pc, const MicroOp &inst, bool taken, uint32_t actualNextPC,
+                              uint32_t predictedNextPC) {
+    if (!enabled())
+        return false;
+    bool correct = actualNextPC == predictedNextPC;
+    BranchStats &branch = stats[pc];
+    branch.executed++;
+    resolved++;
+    if (!correct) {
+        branch.mispredicted++;
+        mispredicted++;
+    }
+
+    Kind kind = classify(inst);
+    if (kind == Kind::CONDITIONAL) {
+        uint8_t &counter = counters[counterIndex(pc)];
+        if (taken && counter < 3)
+            counter++;
+        else if (!taken && counter > 0)
+            counter--;
+        history = ((history << 1) | (taken ? 1 : 0)) & ((1u << cfg.historyBits) - 1);
+    } else if (kind == Kind::CALL) {
+        if (cfg.rasDepth > 0) {
+            if (ras.size() == cfg.rasDepth)
+                ras.erase(ras.begin());   // Overflow drops the oldest return address.
+            ras.push_back(pc + inst.size);
+        }
+    } else if (kind == Kind::RETURN && !ras.empty()) {
+        ras.pop_back();
+    }
+
+    // Conditional branches remember their taken target even while falling through.
+    BtbEntry &entry = btb[(pc >> 2) & (cfg.btbEntries - 1)];
+    entry.pc = pc;
+    entry.target = kind == Kind::CONDITIONAL ? pc + inst.imm : actualNextPC;
+    entry.kind = kind;
+    entry.valid = true;
+    return correct;
+}
@@ -0,0 +1,89 @@
+#ifndef BRANCHPREDICTOR_HPP
+#define BRANCHPREDICTOR_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "MicroOp.hpp"
+
+// Direction predictor for conditional branches. NONE is the original
+// pipeline: nothing is predicted and every branch and jump resolved in ID
+// squashes the fetch behind it, whether it was taken or not.
+enum class PredictorKind { NONE, NOT_TAKEN, BIMODAL, GSHARE };
+
+struct PredictorConfig {
+    PredictorKind kind = PredictorKind::NONE;
+    uint32_t entries = 1024;      // 2-bit counters (bimodal and gshare).
+    uint32_t historyBits = 10;    // Global history length (gshare).
+    uint32_t btbEntries = 64;     // Direct-mapped branch target buffer.
+    uint32_t rasDepth = 8;        // Return-address stack.
+};
+
+// Next-PC prediction for the fetch stage. A BTB hit at the fetch PC says
+// that a branch or jump lives there and where it goes; conditional branches
+// then ask the direction predictor, returns take the top of the
+// return-address stack, and other jumps go to the BTB target. A BTB miss
+// falls through to the next instruction (PC + 4, or PC + 2 after a 16-bit
+// compressed one).
+//
+// All state is trained when the instruction resolves in ID, never at fetch,
+// so a fetch that is squashed or repeated during a stall cannot corrupt the
+// history or the stack.
+class BranchPredictor {
+public:
+    struct BranchStats {
+        uint64_t executed = 0;
+        uint64_t mispredicted = 0;
+    };
+
+    BranchPredictor();
+    explicit BranchPredictor(const PredictorConfig &config);
+
+    // Parses "gshare,entries=4096,history=12,btb=128,ras=16" on top of config.
+    // The first field is the predictor (none, not-taken, bimodal, gshare);
+    // the others are optional. Returns false and reports on std::cerr if the
+    // spec is invalid.
+    static bool parseConfig(const std::string &spec, PredictorConfig &config);
+    static const char *kindName(PredictorKind kind);
+
+    bool enabled() const { return cfg.kind != PredictorKind::NONE; }
+    const PredictorConfig &config() const { return cfg; }
+
+    // Next fetch PC after the instruction at pc, which is size bytes long.
+    uint32_t predict(uint32_t pc, uint32_t size = 4) const;
+    // Trains on a branch or jump resolved in ID. Returns true if the fetch
+    // that followed it (predictedNextPC) was on the right path and can stay;
+    // always false without a predictor.
+    bool resolve(uint32_t pc, const MicroOp &inst, bool taken, uint32_t actualNextPC, uint32_t predictedNextPC);
+
+    uint64_t branches() const { return resolved; }
+    uint64_t mispredictions() const { return mispredicted; }
+    double accuracy() const { return resolved ? 1.0 - static_cast<double>(mispredicted) / resolved : 0.0; }
+    // Per static branch or jump, keyed by PC.
+    const std::map<uint32_t, BranchStats> &branchStats() const { return stats; }
+
+private:
+    enum class Kind : uint8_t { CONDITIONAL, JUMP, CALL, RETURN, INDIRECT };
+
+    struct BtbEntry {
+        uint32_t pc;
+        uint32_t target;
+        Kind kind;
+        bool valid;
+    };
+
+    PredictorConfig cfg;
+    std::vector<uint8_t> counters;      // 2-bit saturating, >= 2 predicts taken.
+    uint32_t history;                   // Outcomes of the last historyBits branches, newest in bit 0.
+    std::vector<BtbEntry> btb;
+    std::vector<uint32_t> ras;          // Return addresses, top at the back.
+    uint64_t resolved, mispredicted;
+    std::map<uint32_t, BranchStats> stats;
+
+    static Kind classify(const MicroOp &inst);
+    uint32_t counterIndex(uint32_t pc) const;
+    bool predictTaken(uint32_t pc) const;
+};
+
+#endif // BRANCHPREDICTOR_HPP
@@ -0,0 +1,165 @@
+#include "Cache.hpp"
+#include <iostream>
+#include <sstream>
+
+namespace {
+    bool isPowerOfTwo(uint32_t x) {
+        return x != 0 && (x & (x - 1)) == 0;
+    }
+
+    uint32_t log2(uint32_t x) {
+        uint32_t bits = 0;
+        while (x >>= 1)
+            bits++;
+        return bits;
+    }
+
+    // "32768", "32K" or "1M".
+    bool parseSize(const std::string &text, uint32_t &value) {
+        if (text.empty())
+            return false;
+        uint64_t scale = 1;
+        std::string digits = text;
+        char suffix = text[text.size() - 1];
+        if (suffix == 'K' || suffix == 'k')
+            scale = 1024;
+        else if (suffix == 'M' || suffix == 'm')
+            scale = 1024 * 1024;
+        if (scale != 1)
+            digits = text.substr(0, text.size() - 1);
+        // At most 9 digits, so the scaled value cannot overflow (or throw in stoull).
+        if (digits.empty() || digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        uint64_t v = std::stoull(digits) * scale;
+        if (v > 0xFFFFFFFFull)
+            return false;
+        value = static_cast<uint32_t>(v);
+        return true;
+    }
+}
+
+Cache::Cache() : Cache(CacheConfig()) {}
+
+Cache::Cache(const CacheConfig &config)
+    : cfg(config), clock(0), randomState(2463534242u), hits(0), misses(0), evictions(0), writebacks(0) {
+    numSets = cfg.size / (cfg.lineSize * cfg.associativity);
+    offsetBits = log2(cfg.lineSize);
+    setBits = log2(numSets);
+    lines.resize(static_cast<size_t>(numSets) * cfg.associativity);
+    flush();
+}
+
+bool Cache::parseConfig(const std::string &spec, CacheConfig &config) {
+    CacheConfig parsed = config;
+    std::stringstream fields(spec);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+        if (field.empty())
+            continue;
+        size_t eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+        bool ok = true;
+        if (key == "size") {
+            ok = parseSize(value, parsed.size);
+        } else if (key == "ways") {
+            ok = parseSize(value, parsed.associativity);
+        } else if (key == "line") {
+            ok = parseSize(value, parsed.lineSize);
+        } else if (key == "hit") {
+            ok = parseSize(value, parsed.hitLatency);
+        } else if (key == "miss") {
+            ok = parseSize(value, parsed.missLatency);
+        } else if (key == "policy") {
+            if (value == "lru")
+                parsed.policy = ReplacementPolicy::LRU;
+            else if (value == "fifo")
+                parsed.policy = ReplacementPolicy::FIFO;
+            else if (value == "random")
+                parsed.policy = ReplacementPolicy::RANDOM;
+            else
+                ok = false;
+        } else {
+            std::cerr << "Unknown cache parameter: " << key << std::endl;
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Invalid value for cache parameter " << key << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    if (!isPowerOfTwo(parsed.lineSize) || parsed.lineSize < 4 || !isPowerOfTwo(parsed.associativity) ||
+        !isPowerOfTwo(parsed.size) || parsed.size < static_cast<uint64_t>(parsed.lineSize) * parsed.associativity) {
+        std::cerr << "Cache size, associativity and line size must be powers of two, with room for at least one set"
+                  << std::endl;
+        return false;
+    }
+    if (parsed.hitLatency == 0 || parsed.missLatency < parsed.hitLatency) {
+        std::cerr << "Cache latencies must satisfy 1 <= hit <= miss" << std::endl;
+        return false;
+    }
+    parsed.enabled = true;
+    config = parsed;
+    return true;
+}
+
+void Cache::flush() {
+    for (auto &line : lines) {
+        line.tag = 0;
+        line.valid = false;
+        line.dirty = false;
+        line.stamp = 0;
+    }
+}
+
+uint32_t Cache::victim(uint32_t set) {
+    Line *ways = &lines[static_cast<size_t>(set) * cfg.associativity];
+    for (uint32_t w = 0; w < cfg.associativity; ++w)
+        if (!ways[w].valid)
+            return w;
+    if (cfg.policy == ReplacementPolicy::RANDOM) {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return randomState & (cfg.associativity - 1);
+    }
+    // LRU and FIFO both evict the smallest stamp; they differ in when it is set.
+    uint32_t oldest = 0;
+    for (uint32_t w = 1; w < cfg.associativity; ++w)
+        if (ways[w].stamp < ways[oldest].stamp)
+            oldest = w;
+    return oldest;
+}
+
+uint32_t Cache::access(uint32_t addr, bool write) {
+    if (!cfg.enabled)
+        return 1;
+    clock++;
+    uint32_t set = (addr >> offsetBits) & (numSets - 1);
+    uint32_t tag = addr >> (offsetBits + setBits);
+    Line *ways = &lines[static_cast<size_t>(set) * cfg.associativity];
+
+    for (uint32_t w = 0; w < cfg.associativity; ++w) {
+        if (ways[w].valid && ways[w].tag == tag) {
+            hits++;
+            if (cfg.policy == ReplacementPolicy::LRU)
+                ways[w].stamp = clock;
+            ways[w].dirty |= write;
+            return cfg.hitLatency;
+        }
+    }
+
+    misses++;
+    Line &line = ways[victim(set)];
+    if (line.valid) {
+        evictions++;
+        if (line.dirty)
+            writebacks++;
+    }
+    line.tag = tag;
+    line.valid = true;
+    line.dirty = write;
+    line.stamp = clock;
+    return cfg.missLatency;
+}
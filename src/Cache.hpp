@@ -0,0 +1,74 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Replacement policy of a set-associative cache.
+enum class ReplacementPolicy { LRU, FIFO, RANDOM };
+
+struct CacheConfig {
+    bool enabled = false;           // A disabled cache answers every access in one cycle.
+    uint32_t size = 16 * 1024;      // Total capacity in bytes.
+    uint32_t associativity = 4;     // Ways per set.
+    uint32_t lineSize = 32;         // Bytes per line.
+    ReplacementPolicy policy = ReplacementPolicy::LRU;
+    uint32_t hitLatency = 1;        // Cycles for a hit (1 = no stall).
+    uint32_t missLatency = 10;      // Cycles for a miss, including the refill.
+};
+
+// Timing model of one L1 cache: tags, valid and dirty bits only. The data
+// itself stays in DataMemory (or the instruction memory), so the cache never
+// changes what a program computes, only how many cycles its accesses take.
+// Stores are write-back and write-allocate; a dirty line that is evicted is
+// counted as a write-back but does not add to the miss latency.
+class Cache {
+public:
+    Cache();
+    explicit Cache(const CacheConfig &config);
+
+    // Parses "size=32K,ways=4,line=64,policy=lru,hit=1,miss=20" on top of
+    // config (every key is optional) and enables the cache. Returns false and
+    // reports on std::cerr if the spec or the resulting geometry is invalid.
+    static bool parseConfig(const std::string &spec, CacheConfig &config);
+
+    // Looks up addr, updates the replacement state and counters, and returns
+    // the access latency in cycles.
+    uint32_t access(uint32_t addr, bool write);
+
+    // Invalidates every line; the counters are kept.
+    void flush();
+
+    const CacheConfig &config() const { return cfg; }
+    bool enabled() const { return cfg.enabled; }
+    uint32_t sets() const { return numSets; }
+
+    uint64_t accesses() const { return hits + misses; }
+    uint64_t hitCount() const { return hits; }
+    uint64_t missCount() const { return misses; }
+    uint64_t evictionCount() const { return evictions; }
+    uint64_t writebackCount() const { return writebacks; }
+    double missRate() const { return accesses() ? static_cast<double>(misses) / accesses() : 0.0; }
+
+private:
+    struct Line {
+        uint32_t tag;
+        bool valid;
+        bool dirty;
+        uint64_t stamp;   // Last use (LRU) or fill time (FIFO).
+    };
+
+    CacheConfig cfg;
+    uint32_t numSets;
+    uint32_t offsetBits;
+    uint32_t setBits;
+    std::vector<Line> lines;   // numSets x associativity, set-major.
+    uint64_t clock;            // Advances on every access; orders the stamps.
+    uint32_t randomState;      // xorshift state for RANDOM replacement (deterministic).
+    uint64_t hits, misses, evictions, writebacks;
+
+    uint32_t victim(uint32_t set);
+};
+
+#endif // CACHE_HPP
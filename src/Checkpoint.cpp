@@ -0,0 +1,184 @@
+#include "Checkpoint.hpp"
+#include "Processor.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char magic[8] = {'R', 'V', 'C', 'K', 'P', 'T', '0', '1'};
+    const uint32_t version = 9;
+
+    // On-disk layout. The header is followed by pageCount resident memory pages,
+    // each a uint32_t page number and DataMemory::pageSize bytes, in ascending order.
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;     // sizeof(Header), guards against layout changes.
+        uint64_t programHash;
+        uint32_t programSize;    // Number of instructions.
+        uint32_t pageCount;      // Memory pages following the header.
+        uint32_t PC;
+        int32_t currentCycle;
+        uint64_t instructionsRetired;
+        uint64_t stallCycles;
+        uint64_t flushedFetches;
+        uint64_t cacheStallCycles;
+        PerfCounters counters;
+        uint8_t stallIF;
+        uint8_t stallNeeded;
+        uint8_t forwardingEnabled;   // Informational; the restoring Processor keeps its own mode.
+        uint8_t reservationValid;    // LR.W reservation (see Atomics.hpp).
+        uint32_t reservationAddr;
+        int32_t regs[32];
+        IF_ID_Latch if_id;
+        ID_EX_Latch id_ex;
+        EX_MEM_Latch ex_mem;
+        MEM_WB_Latch mem_wb;
+        IF_ID_Latch next_if_id;
+        ID_EX_Latch next_id_ex;
+        EX_MEM_Latch next_ex_mem;
+        MEM_WB_Latch next_mem_wb;
+    };
+
+    const uint64_t pageRecordSize = sizeof(uint32_t) + DataMemory::pageSize;
+
+    // FNV-1a over the instruction words, to refuse snapshots of another program.
+    uint64_t hashProgram(const Processor &cpu) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (const auto &hex : cpu.instructionHex) {
+            for (uint32_t i = 0; i < hex.size; ++i) {
+                hash ^= static_cast<unsigned char>(hex.data[i]);
+                hash *= 1099511628211ULL;
+            }
+            hash ^= '\n';
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+namespace Checkpoint {
+    bool save(const Processor &cpu, const std::string &filename) {
+        Header h = Header();   // Value-initialized, so padding is written as zeros.
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.headerSize = sizeof(Header);
+        h.programHash = hashProgram(cpu);
+        h.programSize = cpu.instructionMemory.size();
+        std::vector<uint32_t> pageNumbers = cpu.stack_memory.pageNumbers();
+        h.pageCount = pageNumbers.size();
+        h.PC = cpu.PC;
+        h.currentCycle = cpu.currentCycle;
+        h.instructionsRetired = cpu.instructionsRetired;
+        h.stallCycles = cpu.stallCycles;
+        h.flushedFetches = cpu.flushedFetches;
+        h.cacheStallCycles = cpu.cacheStallCycles;
+        h.counters = cpu.counters;
+        h.stallIF = cpu.stallIF;
+        h.stallNeeded = cpu.stallNeeded;
+        h.forwardingEnabled = cpu.forwardingEnabled;
+        h.reservationValid = cpu.reservation.valid;
+        h.reservationAddr = cpu.reservation.addr;
+        for (int i = 0; i < 32; ++i)
+            h.regs[i] = cpu.regs[i];
+        h.if_id = cpu.if_id;
+        h.id_ex = cpu.id_ex;
+        h.ex_mem = cpu.ex_mem;
+        h.mem_wb = cpu.mem_wb;
+        h.next_if_id = cpu.next_if_id;
+        h.next_id_ex = cpu.next_id_ex;
+        h.next_ex_mem = cpu.next_ex_mem;
+        h.next_mem_wb = cpu.next_mem_wb;
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error opening checkpoint for writing: " << filename << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        for (uint32_t page : pageNumbers) {
+            out.write(reinterpret_cast<const char *>(&page), sizeof(page));
+            out.write(reinterpret_cast<const char *>(cpu.stack_memory.pageData(page)), DataMemory::pageSize);
+        }
+        if (!out) {
+            std::cerr << "Error writing checkpoint: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool restore(Processor &cpu, const std::string &filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error opening checkpoint: " << filename << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+            std::cerr << "Checkpoint is truncated: " << filename << std::endl;
+            close(fd);
+            return false;
+        }
+        void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            std::cerr << "Error mapping checkpoint: " << filename << std::endl;
+            return false;
+        }
+
+        const char *bytes = static_cast<const char *>(map);
+        Header h;
+        std::memcpy(&h, bytes, sizeof(h));
+        bool ok = true;
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version ||
+            h.headerSize != sizeof(Header)) {
+            std::cerr << "Not a compatible checkpoint: " << filename << std::endl;
+            ok = false;
+        } else if (static_cast<uint64_t>(st.st_size) < sizeof(Header) + static_cast<uint64_t>(h.pageCount) * pageRecordSize) {
+            std::cerr << "Checkpoint is truncated: " << filename << std::endl;
+            ok = false;
+        } else if (h.programSize != cpu.instructionMemory.size() || h.programHash != hashProgram(cpu)) {
+            std::cerr << "Checkpoint was taken from a different program: " << filename << std::endl;
+            ok = false;
+        }
+
+        if (ok) {
+            cpu.PC = h.PC;
+            cpu.currentCycle = h.currentCycle;
+            cpu.logStartCycle = h.currentCycle;   // The log of the resumed run starts here.
+            cpu.instructionsRetired = h.instructionsRetired;
+            cpu.stallCycles = h.stallCycles;
+            cpu.flushedFetches = h.flushedFetches;
+            cpu.cacheStallCycles = h.cacheStallCycles;
+            cpu.counters = h.counters;
+            cpu.stallIF = h.stallIF;
+            cpu.stallNeeded = h.stallNeeded;
+            cpu.reservation.valid = h.reservationValid != 0;
+            cpu.reservation.addr = h.reservationAddr;
+            cpu.regs.assign(h.regs, h.regs + 32);
+            cpu.if_id = h.if_id;
+            cpu.id_ex = h.id_ex;
+            cpu.ex_mem = h.ex_mem;
+            cpu.mem_wb = h.mem_wb;
+            cpu.next_if_id = h.next_if_id;
+            cpu.next_id_ex = h.next_id_ex;
+            cpu.next_ex_mem = h.next_ex_mem;
+            cpu.next_mem_wb = h.next_mem_wb;
+            cpu.scoreboard.update(cpu.id_ex, cpu.ex_mem, cpu.mem_wb);
+            cpu.stack_memory.clear();
+            const char *record = bytes + sizeof(Header);
+            for (uint32_t i = 0; i < h.pageCount; ++i, record += pageRecordSize) {
+                uint32_t page;
+                std::memcpy(&page, record, sizeof(page));
+                cpu.stack_memory.setPage(page, reinterpret_cast<const uint8_t *>(record + sizeof(page)));
+            }
+            cpu.pipelineLog.clear();
+        }
+        munmap(map, st.st_size);
+        return ok;
+    }
+}
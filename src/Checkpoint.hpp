@@ -0,0 +1,29 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <string>
+
+class Processor;
+
+// Binary snapshots of a running Processor: PC, registers, stack memory, all
+// eight pipeline latches, the stall flags, and the cycle, retire, stall and
+// performance counters.
+// The pipeline log and the program itself are not stored; a snapshot is
+// restored into a fresh Processor built from the same program, which is
+// checked with a hash of the instruction words. Cache contents are not stored
+// either: the restored run starts with cold caches and no access in flight.
+//
+// The file is a fixed-size header (the latches are trivially copyable and are
+// stored as-is) followed by the resident memory pages only, so the snapshot
+// grows with the memory footprint, not the address space. Restore maps the file and
+// copies straight out of the mapping, so resuming costs about as much as
+// touching the snapshot once.
+namespace Checkpoint {
+    // Writes the snapshot. Returns false (and reports on std::cerr) on failure.
+    bool save(const Processor &cpu, const std::string &filename);
+    // Loads a snapshot into cpu. Returns false (and leaves cpu untouched) if the
+    // file cannot be read or was taken from a different program.
+    bool restore(Processor &cpu, const std::string &filename);
+}
+
+#endif // CHECKPOINT_HPP
@@ -0,0 +1,22 @@
+#include "CodeMap.hpp"
+
+CodeMap::CodeMap(const std::vector<MicroOp> &program)
+    : count(program.size()), size(0), compressed(0) {
+    for (const MicroOp &op : program) {
+        size += op.size;
+        if (op.size == 2)
+            ++compressed;
+    }
+    if (compressed == 0)
+        return;
+
+    slots.assign(size / 2, -1);
+    addresses.resize(count + 1);
+    uint32_t pc = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        addresses[i] = pc;
+        slots[pc / 2] = i;
+        pc += program[i].size;
+    }
+    addresses[count] = pc;
+}
@@ -0,0 +1,46 @@
+#ifndef CODEMAP_HPP
+#define CODEMAP_HPP
+
+#include <cstdint>
+#include <vector>
+#include "MicroOp.hpp"
+
+// Byte layout of a decoded program in instruction memory. Instructions are
+// placed back to back from address 0, each taking MicroOp::size bytes, so
+// once the program holds 16-bit instructions the index of the instruction at
+// a PC is no longer PC / 4. indexAt answers that lookup for every engine.
+//
+// A program of only 32-bit instructions needs no table and keeps the plain
+// PC / 4 lookup (the low bits ignored, as they always were); otherwise there
+// is one slot per halfword.
+class CodeMap {
+public:
+    CodeMap() : count(0), size(0), compressed(0) {}
+    explicit CodeMap(const std::vector<MicroOp> &program);
+
+    // Index of the instruction starting at pc, or -1 if none does (past the
+    // end of the program, or in the middle of an instruction).
+    int32_t indexAt(uint32_t pc) const {
+        if (slots.empty())
+            return pc / 4 < count ? static_cast<int32_t>(pc / 4) : -1;
+        return (pc & 1) == 0 && pc / 2 < slots.size() ? slots[pc / 2] : -1;
+    }
+    // Address of the instruction with the given index (bytes() for the end).
+    uint32_t addressOf(uint32_t index) const {
+        return slots.empty() ? index * 4 : addresses[index];
+    }
+
+    uint32_t bytes() const { return size; }                  // Code size.
+    uint32_t instructions() const { return count; }
+    uint32_t compressedCount() const { return compressed; }  // 16-bit instructions.
+    bool fixedWidth() const { return slots.empty(); }
+
+private:
+    uint32_t count;
+    uint32_t size;
+    uint32_t compressed;
+    std::vector<int32_t> slots;         // Per halfword: index of the instruction starting there, or -1.
+    std::vector<uint32_t> addresses;    // Per instruction (and one past the end): its address.
+};
+
+#endif // CODEMAP_HPP
@@ -0,0 +1,237 @@
+#include "CoherentMemory.hpp"
+#include <iostream>
+#include <sstream>
+
+namespace {
+    bool isPowerOfTwo(uint32_t x) {
+        return x != 0 && (x & (x - 1)) == 0;
+    }
+
+    bool parseCount(const std::string &text, uint32_t &value) {
+        if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        value = static_cast<uint32_t>(std::stoul(text));
+        return true;
+    }
+
+    // Bytes touched by a load or store with this funct3 (SD writes 8).
+    unsigned accessWidth(uint8_t funct3) {
+        static const unsigned widths[4] = {1, 2, 4, 8};
+        return widths[funct3 & 3];
+    }
+}
+
+const unsigned CoherentMemory::shardCount;
+
+CoherentMemory::CoherentMemory(unsigned cores, const CoherenceConfig &config)
+    : cfg(config), lineShift(0), shards(shardCount), reservedShard(cores, shardCount) {
+    while ((1u << lineShift) < cfg.lineSize)
+        lineShift++;
+    granuleShift = lineShift;
+    if (granuleShift < DataMemory::pageBits)
+        granuleShift = DataMemory::pageBits;
+    for (Shard &shard : shards) {
+        shard.perCore.resize(cores);
+        shard.reservations.resize(cores);
+    }
+}
+
+bool CoherentMemory::parseConfig(const std::string &spec, CoherenceConfig &config) {
+    CoherenceConfig parsed = config;
+    std::stringstream fields(spec);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+        if (field.empty())
+            continue;
+        size_t eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+        uint32_t *target = nullptr;
+        if (key == "line")
+            target = &parsed.lineSize;
+        else if (key == "memory")
+            target = &parsed.memoryLatency;
+        else if (key == "transfer")
+            target = &parsed.transferLatency;
+        else if (key == "upgrade")
+            target = &parsed.upgradeLatency;
+        else {
+            std::cerr << "Unknown coherence parameter: " << key << std::endl;
+            return false;
+        }
+        if (!parseCount(value, *target)) {
+            std::cerr << "Invalid value for coherence parameter " << key << ": " << value << std::endl;
+            return false;
+        }
+    }
+    if (!isPowerOfTwo(parsed.lineSize) || parsed.lineSize < 4) {
+        std::cerr << "Coherence line size must be a power of two of at least 4 bytes" << std::endl;
+        return false;
+    }
+    if (parsed.memoryLatency == 0 || parsed.transferLatency == 0 || parsed.upgradeLatency == 0) {
+        std::cerr << "Coherence latencies must be at least 1 cycle" << std::endl;
+        return false;
+    }
+    config = parsed;
+    return true;
+}
+
+void CoherentMemory::invalidateOthers(Shard &shard, unsigned core, Line &line) {
+    uint32_t others = line.sharers & ~(1u << core);
+    for (unsigned c = 0; others; ++c, others >>= 1) {
+        if (others & 1) {
+            shard.perCore[c].invalidationsReceived++;
+            shard.perCore[core].invalidationsSent++;
+        }
+    }
+    line.invalidated |= line.sharers & ~(1u << core);
+    line.sharers = 1u << core;
+}
+
+uint32_t CoherentMemory::transition(Shard &shard, unsigned core, uint32_t addr, bool write) {
+    CoherenceCounters &stats = shard.perCore[core];
+    Line &line = shard.lines[addr >> lineShift];
+    uint32_t self = 1u << core;
+    stats.accesses++;
+
+    if (line.owner == static_cast<int>(core) || (!write && (line.sharers & self))) {
+        stats.hits++;
+        return 1;
+    }
+    shard.transactions++;
+    if (write && (line.sharers & self)) {
+        // Shared -> modified: only the other copies have to go.
+        stats.upgrades++;
+        invalidateOthers(shard, core, line);
+        line.owner = core;
+        return cfg.upgradeLatency;
+    }
+
+    if (line.invalidated & self) {
+        stats.coherenceMisses++;
+        line.invalidated &= ~self;
+    } else {
+        stats.coldMisses++;
+    }
+    uint32_t latency = cfg.memoryLatency;
+    if (line.owner >= 0) {
+        // The modified copy supplies the data (and is written back on a read).
+        stats.transfers++;
+        latency = cfg.transferLatency;
+        if (!write)
+            line.owner = -1;
+    }
+    if (write) {
+        invalidateOthers(shard, core, line);
+        line.owner = core;
+    } else {
+        line.sharers |= self;
+    }
+    return latency;
+}
+
+template <class Op>
+uint32_t CoherentMemory::perform(unsigned core, uint32_t addr, unsigned width, bool write, Op op) {
+    Shard &home = shardOf(addr);
+    Shard &next = shardOf(addr + width - 1);
+    if (&next == &home) {
+        std::lock_guard<std::mutex> guard(home.lock);
+        uint32_t latency = transition(home, core, addr, write);
+        op(home, home.data);
+        return latency;
+    }
+    // An unaligned access across a granule boundary (rare): work on a copy of its bytes.
+    std::lock(home.lock, next.lock);
+    std::lock_guard<std::mutex> homeGuard(home.lock, std::adopt_lock);
+    std::lock_guard<std::mutex> nextGuard(next.lock, std::adopt_lock);
+    uint32_t latency = transition(home, core, addr, write);
+    DataMemory bytes;
+    for (unsigned i = 0; i < width; ++i)
+        bytes.writeByte(addr + i, shardOf(addr + i).data.readByte(addr + i));
+    op(home, bytes);
+    if (write)
+        for (unsigned i = 0; i < width; ++i)
+            shardOf(addr + i).data.writeByte(addr + i, bytes.readByte(addr + i));
+    return latency;
+}
+
+uint32_t CoherentMemory::load(unsigned core, uint8_t funct3, uint32_t addr, uint32_t &latency) {
+    uint32_t value = 0;
+    latency = perform(core, addr, accessWidth(funct3), false, [&](Shard &, DataMemory &data) {
+        value = data.load(funct3, addr);
+    });
+    return value;
+}
+
+void CoherentMemory::store(unsigned core, uint8_t funct3, uint32_t addr, uint32_t value, uint32_t &latency) {
+    latency = perform(core, addr, accessWidth(funct3), true, [&](Shard &shard, DataMemory &data) {
+        data.store(funct3, addr, value);
+        cancelReservations(shard, core, addr);
+    });
+}
+
+uint32_t CoherentMemory::atomic(unsigned core, ALUOp op, uint32_t addr, uint32_t value, uint32_t &latency) {
+    uint32_t result = 0;
+    unsigned index = &shardOf(addr) - &shards[0];
+    latency = perform(core, addr, 4, op != ALUOp::LR, [&](Shard &shard, DataMemory &data) {
+        // A core's one reservation is the one its latest LR left in that LR's shard.
+        if (op == ALUOp::LR)
+            reservedShard[core] = index;
+        Reservation none;
+        Reservation &reservation = reservedShard[core] == index ? shard.reservations[core] : none;
+        bool wrote = false;
+        result = Atomics::execute(data, op, addr, value, reservation, wrote);
+        if (wrote)
+            cancelReservations(shard, core, addr);
+        else if (op == ALUOp::SC)
+            shard.perCore[core].scFailures++;
+    });
+    return result;
+}
+
+void CoherentMemory::cancelReservations(Shard &shard, unsigned core, uint32_t addr) {
+    for (unsigned c = 0; c < shard.reservations.size(); ++c) {
+        Reservation &r = shard.reservations[c];
+        if (c != core && r.valid && (r.addr >> lineShift) == (addr >> lineShift))
+            r.valid = false;
+    }
+}
+
+DataMemory CoherentMemory::memory() const {
+    DataMemory merged;
+    for (const Shard &shard : shards)
+        for (uint32_t page : shard.data.pageNumbers())
+            merged.setPage(page, shard.data.pageData(page));
+    return merged;
+}
+
+uint64_t CoherentMemory::pageFaults() const {
+    uint64_t faults = 0;
+    for (const Shard &shard : shards)
+        faults += shard.data.pageFaults();
+    return faults;
+}
+
+CoherenceCounters CoherentMemory::counters(unsigned core) const {
+    CoherenceCounters sum;
+    for (const Shard &shard : shards) {
+        const CoherenceCounters &k = shard.perCore[core];
+        sum.accesses += k.accesses;
+        sum.hits += k.hits;
+        sum.coldMisses += k.coldMisses;
+        sum.coherenceMisses += k.coherenceMisses;
+        sum.transfers += k.transfers;
+        sum.upgrades += k.upgrades;
+        sum.invalidationsSent += k.invalidationsSent;
+        sum.invalidationsReceived += k.invalidationsReceived;
+        sum.scFailures += k.scFailures;
+    }
+    return sum;
+}
+
+uint64_t CoherentMemory::busTransactions() const {
+    uint64_t total = 0;
+    for (const Shard &shard : shards)
+        total += shard.transactions;
+    return total;
+}
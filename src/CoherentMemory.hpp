@@ -0,0 +1,111 @@
+#ifndef COHERENTMEMORY_HPP
+#define COHERENTMEMORY_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Atomics.hpp"
+#include "ControlUnit.hpp"
+#include "DataMemory.hpp"
+
+struct CoherenceConfig {
+    uint32_t lineSize = 32;          // Coherence granule in bytes.
+    uint32_t memoryLatency = 10;     // Miss served by memory.
+    uint32_t transferLatency = 6;    // Miss served by another core's modified copy.
+    uint32_t upgradeLatency = 3;     // Write to a shared line: invalidate the other copies.
+};
+
+// Per-core coherence traffic.
+struct CoherenceCounters {
+    uint64_t accesses = 0;
+    uint64_t hits = 0;
+    uint64_t coldMisses = 0;             // First touch of a line by this core.
+    uint64_t coherenceMisses = 0;        // The core's copy had been invalidated by another core.
+    uint64_t transfers = 0;              // Misses served cache-to-cache from a modified copy.
+    uint64_t upgrades = 0;               // Shared -> modified.
+    uint64_t invalidationsSent = 0;
+    uint64_t invalidationsReceived = 0;
+    uint64_t scFailures = 0;
+};
+
+// Data memory shared by the cores of a Multicore, behind an MSI directory.
+//
+// Every core has an unbounded private cache (capacity and conflict misses
+// are the per-core Cache's business); the directory keeps, per line, the set
+// of cores holding it shared and the core holding it modified. load(),
+// store() and atomic() run the MSI transition for a core's access, perform
+// it on the data and return its latency, which the Processor folds into its
+// cache timing. Transition and data change together, so values are
+// sequentially consistent regardless of timing.
+//
+// Cores may run on different host threads. The directory, the data and the
+// counters are split into shards by granule (a page, or a line if lines are
+// larger), each behind its own lock, so cores touching different granules do
+// not contend. A core's own calls must come from one thread at a time.
+class CoherentMemory {
+public:
+    static const unsigned maxCores = 32;   // Sharer sets are 32-bit masks.
+
+    explicit CoherentMemory(unsigned cores, const CoherenceConfig &config = CoherenceConfig());
+
+    // Parses "line=64,memory=20,transfer=8,upgrade=4" on top of config.
+    // Returns false and reports on std::cerr if the spec is invalid.
+    static bool parseConfig(const std::string &spec, CoherenceConfig &config);
+
+    unsigned cores() const { return static_cast<unsigned>(reservedShard.size()); }
+    const CoherenceConfig &config() const { return cfg; }
+
+    // Each sets latency to the access's cycles (1 = hit).
+    uint32_t load(unsigned core, uint8_t funct3, uint32_t addr, uint32_t &latency);
+    void store(unsigned core, uint8_t funct3, uint32_t addr, uint32_t value, uint32_t &latency);
+    // LR.W / SC.W / AMO*.W (see Atomics.hpp); returns the value for rd.
+    uint32_t atomic(unsigned core, ALUOp op, uint32_t addr, uint32_t value, uint32_t &latency);
+
+    // Not synchronized: only while no core is running.
+    // A copy of the whole memory (its own page-fault count is meaningless).
+    DataMemory memory() const;
+    uint64_t pageFaults() const;
+    CoherenceCounters counters(unsigned core) const;
+    // Directory requests on the interconnect (misses and upgrades).
+    uint64_t busTransactions() const;
+
+private:
+    struct Line {
+        uint32_t sharers = 0;     // Cores with a valid copy (including the owner).
+        int owner = -1;           // Core holding it modified, or -1.
+        uint32_t invalidated = 0; // Cores whose copy another core invalidated since they last had it.
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<uint32_t, Line> lines;
+        DataMemory data;                          // Only this shard's pages.
+        std::vector<CoherenceCounters> perCore;
+        // Per core; only meaningful if reservedShard says the core's one reservation is here.
+        std::vector<Reservation> reservations;
+        uint64_t transactions = 0;
+    };
+    static const unsigned shardCount = 64;
+
+    CoherenceConfig cfg;
+    uint32_t lineShift;
+    uint32_t granuleShift;   // max(lineShift, DataMemory::pageBits)
+    std::vector<Shard> shards;
+    std::vector<unsigned> reservedShard;   // Per core, written only by that core's calls.
+
+    Shard &shardOf(uint32_t addr) { return shards[(addr >> granuleShift) & (shardCount - 1)]; }
+    // MSI transition for core's access to addr; returns its latency. Needs the shard's lock.
+    uint32_t transition(Shard &shard, unsigned core, uint32_t addr, bool write);
+    void invalidateOthers(Shard &shard, unsigned core, Line &line);
+    // A write by core to addr cancels the other cores' reservations on its line.
+    void cancelReservations(Shard &shard, unsigned core, uint32_t addr);
+    // Under the lock of addr's shard (and of the next one if the width bytes
+    // at addr span two), runs the MSI transition and then op(shard, data) on
+    // memory holding those bytes. Returns the transition's latency.
+    template <class Op>
+    uint32_t perform(unsigned core, uint32_t addr, unsigned width, bool write, Op op);
+};
+
+#endif // COHERENTMEMORY_HPP
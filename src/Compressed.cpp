@@ -0,0 +1,303 @@
+#include "Compressed.hpp"
+#include <cstddef>
+
+namespace {
+    // Bits hi..lo of value, shifted down to bit 0.
+    uint32_t field(uint32_t value, int hi, int lo) {
+        return (value >> lo) & ((1u << (hi - lo + 1)) - 1);
+    }
+    int32_t signExtend(uint32_t value, int width) {
+        return static_cast<int32_t>(value << (32 - width)) >> (32 - width);
+    }
+    bool fits(int32_t value, int32_t low, int32_t high, int32_t multiple) {
+        return value >= low && value <= high && value % multiple == 0;
+    }
+    // x8..x15, the registers the 3-bit fields name.
+    bool isPrime(uint32_t reg) {
+        return reg >= 8 && reg <= 15;
+    }
+
+    uint32_t rType(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd) {
+        return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | 0x33;
+    }
+    uint32_t iType(uint32_t opcode, int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd) {
+        return (static_cast<uint32_t>(imm) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+    }
+    uint32_t sType(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3) {
+        uint32_t u = imm;
+        return ((u >> 5) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | ((u & 0x1F) << 7) | 0x23;
+    }
+    uint32_t bType(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3) {
+        uint32_t u = imm;
+        return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) |
+               (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0x63;
+    }
+    uint32_t jType(int32_t imm, uint32_t rd) {
+        uint32_t u = imm;
+        return (((u >> 20) & 1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 1) << 20) |
+               (((u >> 12) & 0xFF) << 12) | (rd << 7) | 0x6F;
+    }
+
+    int32_t bImm(uint32_t w) {
+        return signExtend((field(w, 31, 31) << 12) | (field(w, 7, 7) << 11) | (field(w, 30, 25) << 5) |
+                          (field(w, 11, 8) << 1), 13);
+    }
+    int32_t jImm(uint32_t w) {
+        return signExtend((field(w, 31, 31) << 20) | (field(w, 19, 12) << 12) | (field(w, 20, 20) << 11) |
+                          (field(w, 30, 21) << 1), 21);
+    }
+
+    // C.J / C.JAL offset: [11|4|9:8|10|6|7|3:1|5] in bits 12..2.
+    int32_t cjOffset(uint32_t c) {
+        return signExtend((field(c, 12, 12) << 11) | (field(c, 11, 11) << 4) | (field(c, 10, 9) << 8) |
+                          (field(c, 8, 8) << 10) | (field(c, 7, 7) << 6) | (field(c, 6, 6) << 7) |
+                          (field(c, 5, 3) << 1) | (field(c, 2, 2) << 5), 12);
+    }
+    uint32_t cjBits(int32_t imm) {
+        uint32_t u = imm;
+        return (field(u, 11, 11) << 12) | (field(u, 4, 4) << 11) | (field(u, 9, 8) << 9) | (field(u, 10, 10) << 8) |
+               (field(u, 6, 6) << 7) | (field(u, 7, 7) << 6) | (field(u, 3, 1) << 3) | (field(u, 5, 5) << 2);
+    }
+    // CI format: funct3, a 6-bit immediate split over bits 12 and 6..2, rd, quadrant.
+    uint32_t ciType(uint32_t f3, int32_t imm, uint32_t rd, uint32_t op) {
+        uint32_t u = imm;
+        return (f3 << 13) | (field(u, 5, 5) << 12) | (rd << 7) | (field(u, 4, 0) << 2) | op;
+    }
+    // C.LW / C.SW: offset[5:3] in bits 12..10, offset[2] in bit 6, offset[6] in bit 5.
+    uint32_t clBits(int32_t imm) {
+        uint32_t u = imm;
+        return (field(u, 5, 3) << 10) | (field(u, 2, 2) << 6) | (field(u, 6, 6) << 5);
+    }
+
+    bool isBranchOrJal(uint32_t word) {
+        uint32_t opcode = word & 0x7F;
+        return opcode == 0x63 || opcode == 0x6F;
+    }
+    int32_t offsetOf(uint32_t word) {
+        return (word & 0x7F) == 0x63 ? bImm(word) : jImm(word);
+    }
+    // The branch or JAL with its offset replaced.
+    uint32_t withOffset(uint32_t word, int32_t offset) {
+        if ((word & 0x7F) == 0x63)
+            return bType(offset, field(word, 24, 20), field(word, 19, 15), field(word, 14, 12));
+        return jType(offset, field(word, 11, 7));
+    }
+}
+
+namespace Compressed {
+
+uint32_t expand(uint16_t half) {
+    uint32_t c = half;
+    uint32_t f3 = field(c, 15, 13);
+    uint32_t rd = field(c, 11, 7), rs2 = field(c, 6, 2);                  // Full register fields.
+    uint32_t rdp = 8 + field(c, 4, 2), rs1p = 8 + field(c, 9, 7);         // x8..x15 fields.
+    int32_t imm6 = signExtend((field(c, 12, 12) << 5) | field(c, 6, 2), 6);
+    uint32_t shamt = field(c, 6, 2);
+    bool bit12 = field(c, 12, 12) != 0;
+
+    switch ((c & 3) << 3 | f3) {
+        case 0x00: {   // C.ADDI4SPN
+            int32_t imm = (field(c, 12, 11) << 4) | (field(c, 10, 7) << 6) | (field(c, 6, 6) << 2) |
+                          (field(c, 5, 5) << 3);
+            return imm ? iType(0x13, imm, 2, 0, rdp) : 0;
+        }
+        case 0x02:     // C.LW
+            return iType(0x03, (field(c, 12, 10) << 3) | (field(c, 6, 6) << 2) | (field(c, 5, 5) << 6), rs1p, 2,
+                         rdp);
+        case 0x06:     // C.SW
+            return sType((field(c, 12, 10) << 3) | (field(c, 6, 6) << 2) | (field(c, 5, 5) << 6), rdp, rs1p, 2);
+        case 0x08:     // C.ADDI (C.NOP with rd = x0)
+            return iType(0x13, imm6, rd, 0, rd);
+        case 0x09:     // C.JAL
+            return jType(cjOffset(c), 1);
+        case 0x0A:     // C.LI
+            return iType(0x13, imm6, 0, 0, rd);
+        case 0x0B:
+            if (rd == 2) {   // C.ADDI16SP
+                int32_t imm = signExtend((field(c, 12, 12) << 9) | (field(c, 6, 6) << 4) | (field(c, 5, 5) << 6) |
+                                         (field(c, 4, 3) << 7) | (field(c, 2, 2) << 5), 10);
+                return imm ? iType(0x13, imm, 2, 0, 2) : 0;
+            }
+            // C.LUI
+            return imm6 ? (static_cast<uint32_t>(imm6) << 12) | (rd << 7) | 0x37 : 0;
+        case 0x0C:
+            switch (field(c, 11, 10)) {
+                case 0:   // C.SRLI (shamt[5] must be 0 on RV32)
+                    return bit12 ? 0 : iType(0x13, shamt, rs1p, 5, rs1p);
+                case 1:   // C.SRAI
+                    return bit12 ? 0 : iType(0x13, 0x400 | shamt, rs1p, 5, rs1p);
+                case 2:   // C.ANDI
+                    return iType(0x13, imm6, rs1p, 7, rs1p);
+                default: {
+                    if (bit12)
+                        return 0;   // C.SUBW / C.ADDW are RV64 only.
+                    static const uint32_t f7[4] = {0x20, 0, 0, 0}, funct3[4] = {0, 4, 6, 7};   // SUB XOR OR AND
+                    uint32_t k = field(c, 6, 5);
+                    return rType(f7[k], rdp, rs1p, funct3[k], rs1p);
+                }
+            }
+        case 0x0D:     // C.J
+            return jType(cjOffset(c), 0);
+        case 0x0E:     // C.BEQZ
+        case 0x0F: {   // C.BNEZ
+            int32_t imm = signExtend((field(c, 12, 12) << 8) | (field(c, 11, 10) << 3) | (field(c, 6, 5) << 6) |
+                                     (field(c, 4, 3) << 1) | (field(c, 2, 2) << 5), 9);
+            return bType(imm, 0, rs1p, f3 & 1);
+        }
+        case 0x10:     // C.SLLI
+            return bit12 ? 0 : iType(0x13, shamt, rd, 1, rd);
+        case 0x12:     // C.LWSP
+            return rd ? iType(0x03, (field(c, 12, 12) << 5) | (field(c, 6, 4) << 2) | (field(c, 3, 2) << 6), 2, 2, rd)
+                      : 0;
+        case 0x14:
+            if (!bit12) {
+                if (rs2 == 0)   // C.JR
+                    return rd ? iType(0x67, 0, rd, 0, 0) : 0;
+                return rType(0, rs2, 0, 0, rd);     // C.MV
+            }
+            if (rs2 == 0)       // C.JALR (C.EBREAK with rd = x0)
+                return rd ? iType(0x67, 0, rd, 0, 1) : 0;
+            return rType(0, rs2, rd, 0, rd);        // C.ADD
+        case 0x16:     // C.SWSP
+            return sType((field(c, 12, 9) << 2) | (field(c, 8, 7) << 6), rs2, 2, 2);
+        default:
+            return 0;   // Floating point, reserved, or not a 16-bit instruction at all.
+    }
+}
+
+uint16_t compress(uint32_t w) {
+    uint32_t opcode = w & 0x7F, rd = field(w, 11, 7), f3 = field(w, 14, 12);
+    uint32_t rs1 = field(w, 19, 15), rs2 = field(w, 24, 20), f7 = field(w, 31, 25);
+    int32_t imm = static_cast<int32_t>(w) >> 20;
+    uint32_t c = 0;
+
+    switch (opcode) {
+        case 0x13:
+            if (w == 0x00000013) {
+                c = 0x0001;                                                      // C.NOP
+            } else if (f3 == 0) {
+                if (rd != 0 && rs1 == 0 && fits(imm, -32, 31, 1))
+                    c = ciType(2, imm, rd, 1);                                   // C.LI
+                else if (rd != 0 && rd == rs1 && imm != 0 && fits(imm, -32, 31, 1))
+                    c = ciType(0, imm, rd, 1);                                   // C.ADDI
+                else if (rd == 2 && rs1 == 2 && imm != 0 && fits(imm, -512, 496, 16))
+                    c = (3u << 13) | (field(imm, 9, 9) << 12) | (2 << 7) | (field(imm, 4, 4) << 6) |
+                        (field(imm, 6, 6) << 5) | (field(imm, 8, 7) << 3) | (field(imm, 5, 5) << 2) | 1;   // C.ADDI16SP
+                else if (isPrime(rd) && rs1 == 2 && imm != 0 && fits(imm, 4, 1020, 4))
+                    c = (field(imm, 5, 4) << 11) | (field(imm, 9, 6) << 7) | (field(imm, 2, 2) << 6) |
+                        (field(imm, 3, 3) << 5) | ((rd - 8) << 2);                // C.ADDI4SPN
+            } else if (f3 == 1 && f7 == 0 && rd != 0 && rd == rs1 && rs2 != 0) {
+                c = ciType(0, rs2, rd, 2);                                       // C.SLLI
+            } else if (f3 == 5 && (f7 == 0 || f7 == 0x20) && isPrime(rd) && rd == rs1 && rs2 != 0) {
+                c = (4u << 13) | ((f7 ? 1u : 0u) << 10) | ((rd - 8) << 7) | (rs2 << 2) | 1;   // C.SRLI / C.SRAI
+            } else if (f3 == 7 && isPrime(rd) && rd == rs1 && fits(imm, -32, 31, 1)) {
+                c = (4u << 13) | (field(imm, 5, 5) << 12) | (2 << 10) | ((rd - 8) << 7) | (field(imm, 4, 0) << 2) | 1;   // C.ANDI
+            }
+            break;
+        case 0x33:
+            if (f7 == 0 && f3 == 0 && rd != 0 && rs2 != 0 && (rs1 == 0 || rs1 == rd)) {
+                c = (4u << 13) | ((rs1 ? 1u : 0u) << 12) | (rd << 7) | (rs2 << 2) | 2;   // C.MV / C.ADD
+            } else if (isPrime(rd) && rd == rs1 && isPrime(rs2)) {
+                int k = (f7 == 0x20 && f3 == 0) ? 0 : (f7 == 0 && f3 == 4) ? 1 : (f7 == 0 && f3 == 6) ? 2
+                      : (f7 == 0 && f3 == 7) ? 3 : -1;
+                if (k >= 0)
+                    c = (4u << 13) | (3 << 10) | ((rd - 8) << 7) | (k << 5) | ((rs2 - 8) << 2) | 1;   // C.SUB .. C.AND
+            }
+            break;
+        case 0x03:
+            if (f3 == 2 && isPrime(rd) && isPrime(rs1) && fits(imm, 0, 124, 4))
+                c = (2u << 13) | clBits(imm) | ((rs1 - 8) << 7) | ((rd - 8) << 2);   // C.LW
+            else if (f3 == 2 && rd != 0 && rs1 == 2 && fits(imm, 0, 252, 4))
+                c = (2u << 13) | (field(imm, 5, 5) << 12) | (rd << 7) | (field(imm, 4, 2) << 4) |
+                    (field(imm, 7, 6) << 2) | 2;                                  // C.LWSP
+            break;
+        case 0x23: {
+            int32_t s = signExtend((f7 << 5) | rd, 12);
+            if (f3 == 2 && isPrime(rs2) && isPrime(rs1) && fits(s, 0, 124, 4))
+                c = (6u << 13) | clBits(s) | ((rs1 - 8) << 7) | ((rs2 - 8) << 2);     // C.SW
+            else if (f3 == 2 && rs1 == 2 && fits(s, 0, 252, 4))
+                c = (6u << 13) | (field(s, 5, 2) << 9) | (field(s, 7, 6) << 7) | (rs2 << 2) | 2;   // C.SWSP
+            break;
+        }
+        case 0x63: {
+            int32_t b = bImm(w);
+            if (f3 <= 1 && rs2 == 0 && isPrime(rs1) && fits(b, -256, 254, 2))
+                c = ((6u | f3) << 13) | (field(b, 8, 8) << 12) | (field(b, 4, 3) << 10) | ((rs1 - 8) << 7) |
+                    (field(b, 7, 6) << 5) | (field(b, 2, 1) << 3) | (field(b, 5, 5) << 2) | 1;   // C.BEQZ / C.BNEZ
+            break;
+        }
+        case 0x6F: {
+            int32_t j = jImm(w);
+            if (rd <= 1 && fits(j, -2048, 2046, 2))
+                c = ((rd ? 1u : 5u) << 13) | cjBits(j) | 1;                       // C.JAL / C.J
+            break;
+        }
+        case 0x67:
+            if (f3 == 0 && imm == 0 && rs1 != 0 && rd <= 1)
+                c = (4u << 13) | (rd << 12) | (rs1 << 7) | 2;                     // C.JR / C.JALR
+            break;
+        case 0x37: {
+            int32_t upper = static_cast<int32_t>(w) >> 12;
+            if (rd != 0 && rd != 2 && upper != 0 && fits(upper, -32, 31, 1))
+                c = ciType(3, upper, rd, 1);                                     // C.LUI
+            break;
+        }
+        default:
+            break;
+    }
+    return static_cast<uint16_t>(c);
+}
+
+bool isHalfwordToken(const char *begin, const char *end) {
+    if (end - begin > 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X'))
+        begin += 2;
+    return end - begin == 4;
+}
+
+std::vector<uint32_t> compressProgram(const std::vector<uint32_t> &words, std::vector<uint8_t> &sizes) {
+    size_t n = words.size();
+    // Instruction each PC-relative branch or jump lands on (n = the end of the program), or -1.
+    std::vector<int64_t> target(n, -1);
+    sizes.assign(n, 4);
+    for (size_t i = 0; i < n; ++i) {
+        bool relative = isBranchOrJal(words[i]);
+        if (relative) {
+            int64_t t = static_cast<int64_t>(i) * 4 + offsetOf(words[i]);
+            if (t >= 0 && t % 4 == 0 && t / 4 <= static_cast<int64_t>(n))
+                target[i] = t / 4;
+            else
+                continue;   // Lands outside the program: keep it as it is.
+        }
+        if (compress(relative ? withOffset(words[i], 0) : words[i]))
+            sizes[i] = 2;
+    }
+
+    // Shrinking only ever shortens distances, but a compressed branch may
+    // still not reach; widen those until every offset fits.
+    std::vector<uint32_t> address(n + 1);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < n; ++i)
+            address[i + 1] = address[i] + sizes[i];
+        for (size_t i = 0; i < n; ++i) {
+            if (target[i] < 0 || sizes[i] != 2)
+                continue;
+            int32_t offset = static_cast<int32_t>(address[target[i]] - address[i]);
+            if (!compress(withOffset(words[i], offset))) {
+                sizes[i] = 4;
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<uint32_t> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t word = words[i];
+        if (target[i] >= 0)
+            word = withOffset(word, static_cast<int32_t>(address[target[i]] - address[i]));
+        out[i] = sizes[i] == 2 ? compress(word) : word;
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,34 @@
+#ifndef COMPRESSED_HPP
+#define COMPRESSED_HPP
+
+#include <cstdint>
+#include <vector>
+
+// RV32C, the 16-bit compressed encodings. Every compressed instruction is an
+// abbreviation of a 32-bit one, so the simulator expands it at load time and
+// decodes the result as usual; only the instruction's size (MicroOp::size)
+// tells the two apart afterwards. In the input files a compressed
+// instruction is a 4-digit hex token, a 32-bit one an 8-digit token.
+//
+// The floating-point loads and stores (C.FLW, C.FSW, C.FLD, C.FSD and their
+// SP forms) and C.EBREAK have no 32-bit counterpart in this simulator and
+// expand to 0, which decodes as an unsupported instruction, like the
+// reserved and illegal encodings.
+namespace Compressed {
+    // The 32-bit equivalent of a 16-bit instruction, or 0 if there is none.
+    uint32_t expand(uint16_t half);
+    // The 16-bit form of a 32-bit instruction, or 0 if it has none.
+    uint16_t compress(uint32_t word);
+    // True for a token of exactly 4 hex digits (after an optional 0x).
+    bool isHalfwordToken(const char *begin, const char *end);
+
+    // Re-lays out a program of 32-bit words with every instruction that has a
+    // 16-bit form compressed. Branch and jump offsets are retargeted to the new
+    // layout; one whose compressed form cannot reach its target stays 32-bit.
+    // Jump targets computed at run time (jalr through anything but a link
+    // register) are not adjusted. Returns the encodings, with the size of
+    // each (2 or 4 bytes) in `sizes`.
+    std::vector<uint32_t> compressProgram(const std::vector<uint32_t> &words, std::vector<uint8_t> &sizes);
+}
+
+#endif // COMPRESSED_HPP
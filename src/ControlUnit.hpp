@@ -5,7 +5,7 @@
 
 
 // Define ALU operation types.
-enum class ALUOp {
+enum class ALUOp : uint8_t {
     NONE,
     ADD,
     SUB,
@@ -16,7 +16,19 @@ enum class ALUOp {
     SRA,
     SLLI,
     SRLI,
-    SRAI
+    SRAI,
+    // RV32A: the memory operation of an A_TYPE instruction (see ALU::amo).
+    LR,
+    SC,
+    AMOSWAP,
+    AMOADD,
+    AMOXOR,
+    AMOAND,
+    AMOOR,
+    AMOMIN,
+    AMOMAX,
+    AMOMINU,
+    AMOMAXU
 };
 
 
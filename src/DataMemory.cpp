@@ -0,0 +1,153 @@
+#include "DataMemory.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const uint32_t offsetMask = DataMemory::pageSize - 1;
+
+    // The aligned fast paths copy straight between the page and a host integer.
+    const bool hostIsLittleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+}
+
+DataMemory::DataMemory() : faults(0) {
+    invalidateCache();
+}
+
+DataMemory::DataMemory(const DataMemory &other) : faults(other.faults) {
+    invalidateCache();
+    for (const auto &entry : other.pages)
+        pages[entry.first].reset(new Page(*entry.second));
+}
+
+DataMemory &DataMemory::operator=(const DataMemory &other) {
+    if (this != &other) {
+        pages.clear();
+        for (const auto &entry : other.pages)
+            pages[entry.first].reset(new Page(*entry.second));
+        faults = other.faults;
+        invalidateCache();
+    }
+    return *this;
+}
+
+void DataMemory::invalidateCache() {
+    for (unsigned i = 0; i < cacheSize; ++i) {
+        cacheTag[i] = noPage;
+        cachePage[i] = nullptr;
+    }
+}
+
+uint8_t *DataMemory::findPage(uint32_t pageNumber) const {
+    unsigned slot = pageNumber % cacheSize;
+    if (cacheTag[slot] == pageNumber)
+        return cachePage[slot];
+    auto it = pages.find(pageNumber);
+    if (it == pages.end())
+        return nullptr;
+    cacheTag[slot] = pageNumber;
+    cachePage[slot] = it->second->bytes;
+    return cachePage[slot];
+}
+
+uint8_t *DataMemory::touchPage(uint32_t pageNumber) {
+    uint8_t *page = findPage(pageNumber);
+    if (page)
+        return page;
+    std::unique_ptr<Page> &entry = pages[pageNumber];
+    entry.reset(new Page());   // Value-initialized: zero-filled.
+    faults++;
+    unsigned slot = pageNumber % cacheSize;
+    cacheTag[slot] = pageNumber;
+    cachePage[slot] = entry->bytes;
+    return entry->bytes;
+}
+
+uint8_t DataMemory::readByte(uint32_t addr) const {
+    const uint8_t *page = findPage(addr >> pageBits);
+    return page ? page[addr & offsetMask] : 0;
+}
+
+void DataMemory::writeByte(uint32_t addr, uint8_t value) {
+    touchPage(addr >> pageBits)[addr & offsetMask] = value;
+}
+
+uint32_t DataMemory::load(uint8_t funct3, uint32_t addr) const {
+    // Width in bytes from funct3 (LB/LBU = 1, LH/LHU = 2, LW/LWU = 4).
+    unsigned width;
+    switch (funct3) {
+        case 0: case 4: width = 1; break;
+        case 1: case 5: width = 2; break;
+        case 2: case 6: width = 4; break;
+        default: return 0;   // Unsupported load type.
+    }
+
+    uint32_t raw = 0;
+    if (hostIsLittleEndian && (addr & (width - 1)) == 0) {
+        // Aligned: the access cannot cross a page.
+        const uint8_t *page = findPage(addr >> pageBits);
+        if (page)
+            std::memcpy(&raw, page + (addr & offsetMask), width);
+    } else {
+        for (unsigned i = 0; i < width; ++i)
+            raw |= static_cast<uint32_t>(readByte(addr + i)) << (8 * i);
+    }
+
+    switch (funct3) {
+        case 0: return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(raw)));   // LB
+        case 1: return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(raw)));  // LH
+        default: return raw;                                                                     // LBU, LHU, LW, LWU
+    }
+}
+
+void DataMemory::store(uint8_t funct3, uint32_t addr, uint32_t value) {
+    unsigned width;
+    switch (funct3) {
+        case 0: width = 1; break;   // SB
+        case 1: width = 2; break;   // SH
+        case 2: width = 4; break;   // SW
+        case 3:                     // SD: value in the low word, zeros in the high word.
+            for (unsigned i = 0; i < 8; ++i)
+                writeByte(addr + i, i < 4 ? (value >> (8 * i)) & 0xFF : 0);
+            return;
+        default: return;            // Unsupported store type.
+    }
+
+    if (hostIsLittleEndian && (addr & (width - 1)) == 0) {
+        std::memcpy(touchPage(addr >> pageBits) + (addr & offsetMask), &value, width);
+    } else {
+        for (unsigned i = 0; i < width; ++i)
+            writeByte(addr + i, (value >> (8 * i)) & 0xFF);
+    }
+}
+
+void DataMemory::clear() {
+    pages.clear();
+    invalidateCache();
+}
+
+bool DataMemory::operator==(const DataMemory &other) const {
+    static const Page zero = Page();
+    for (const auto &entry : pages) {
+        const uint8_t *theirs = other.findPage(entry.first);
+        if (std::memcmp(entry.second->bytes, theirs ? theirs : zero.bytes, pageSize) != 0)
+            return false;
+    }
+    for (const auto &entry : other.pages) {
+        if (!findPage(entry.first) && std::memcmp(entry.second->bytes, zero.bytes, pageSize) != 0)
+            return false;
+    }
+    return true;
+}
+
+std::vector<uint32_t> DataMemory::pageNumbers() const {
+    std::vector<uint32_t> numbers;
+    numbers.reserve(pages.size());
+    for (const auto &entry : pages)
+        numbers.push_back(entry.first);
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+void DataMemory::setPage(uint32_t pageNumber, const uint8_t *data) {
+    std::memcpy(touchPage(pageNumber), data, pageSize);
+}
@@ -0,0 +1,72 @@
+#ifndef DATAMEMORY_HPP
+#define DATAMEMORY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Sparse, byte-addressed little-endian data memory covering the full 32-bit
+// address space, shared by the pipeline's MEM stage and the functional core.
+//
+// Memory is split into 4 KiB pages that are allocated on the first store to
+// them (a "page fault"); loads from a page that was never written read 0
+// without allocating it. Lookups go through a small direct-mapped cache of
+// recently used pages in front of the page table, and naturally aligned
+// halfword and word accesses are served straight from the page. Unaligned
+// accesses are assembled byte by byte and may span two pages.
+class DataMemory {
+public:
+    static const uint32_t pageBits = 12;
+    static const uint32_t pageSize = 1u << pageBits;
+
+    DataMemory();
+    DataMemory(const DataMemory &other);
+    DataMemory &operator=(const DataMemory &other);
+
+    // Load selected by funct3: LB, LH, LW, LBU, LHU, LWU.
+    uint32_t load(uint8_t funct3, uint32_t addr) const;
+    // Store selected by funct3: SB, SH, SW, SD (registers are 32-bit, the upper word of SD is 0).
+    void store(uint8_t funct3, uint32_t addr, uint32_t value);
+
+    uint8_t readByte(uint32_t addr) const;
+    void writeByte(uint32_t addr, uint8_t value);
+
+    // Drops every page (all of memory reads 0 again); the counters are kept.
+    void clear();
+
+    // Never-written pages compare equal to zero-filled ones.
+    bool operator==(const DataMemory &other) const;
+    bool operator!=(const DataMemory &other) const { return !(*this == other); }
+
+    size_t residentPages() const { return pages.size(); }
+    size_t residentBytes() const { return pages.size() * pageSize; }
+    uint64_t pageFaults() const { return faults; }
+
+    // Page numbers (address >> pageBits) of every resident page, ascending.
+    std::vector<uint32_t> pageNumbers() const;
+    // Contents of a resident page (pageSize bytes), or nullptr.
+    const uint8_t *pageData(uint32_t pageNumber) const { return findPage(pageNumber); }
+    // Copies pageSize bytes into a page, allocating it if needed.
+    void setPage(uint32_t pageNumber, const uint8_t *data);
+
+private:
+    struct Page {
+        uint8_t bytes[pageSize];
+    };
+    static const unsigned cacheSize = 8;   // Direct-mapped on the low page-number bits.
+    static const uint32_t noPage = 0xFFFFFFFFu;  // Tag of an empty cache slot (no real page number).
+
+    std::unordered_map<uint32_t, std::unique_ptr<Page>> pages;
+    mutable uint32_t cacheTag[cacheSize];
+    mutable uint8_t *cachePage[cacheSize];
+    uint64_t faults;
+
+    void invalidateCache();
+    // The page holding pageNumber, or nullptr if it was never written.
+    uint8_t *findPage(uint32_t pageNumber) const;
+    // The page holding pageNumber, allocated (zero-filled) on first use.
+    uint8_t *touchPage(uint32_t pageNumber);
+};
+
+#endif // DATAMEMORY_HPP
@@ -0,0 +1,59 @@
+#ifndef ENCODE_HPP
+#define ENCODE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// RV32 instruction encoders for programs built in code (the program
+// generator, simbench's scaled workloads and the tests). Operands follow the
+// order of the fields in the encoding, most significant first. Note that
+// LUI adds the PC in this simulator, so position-independent constants are
+// better built with addi and slli.
+namespace Encode {
+    inline uint32_t rType(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd) {
+        return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | 0x33;
+    }
+    inline uint32_t iType(uint32_t opcode, int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd) {
+        return (static_cast<uint32_t>(imm) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+    }
+    inline uint32_t sType(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3) {
+        uint32_t u = imm;
+        return ((u >> 5) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | ((u & 0x1F) << 7) | 0x23;
+    }
+    inline uint32_t bType(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3) {
+        uint32_t u = imm;
+        return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) |
+               (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0x63;
+    }
+    inline uint32_t jType(int32_t imm, uint32_t rd) {
+        uint32_t u = imm;
+        return (((u >> 20) & 1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 1) << 20) |
+               (((u >> 12) & 0xFF) << 12) | (rd << 7) | 0x6F;
+    }
+    // LUI.
+    inline uint32_t uType(uint32_t upper, uint32_t rd) {
+        return (upper << 12) | (rd << 7) | 0x37;
+    }
+    // RV32A, word-sized, without the aq/rl bits.
+    inline uint32_t aType(uint32_t f5, uint32_t rs2, uint32_t rs1, uint32_t rd) {
+        return (f5 << 27) | (rs2 << 20) | (rs1 << 15) | (2 << 12) | (rd << 7) | 0x2F;
+    }
+
+    // An 8-digit hex token, as in the input files.
+    inline std::string hex(uint32_t word) {
+        char text[9];
+        snprintf(text, sizeof(text), "%08x", word);
+        return text;
+    }
+    inline std::vector<std::string> hex(const std::vector<uint32_t> &words) {
+        std::vector<std::string> tokens;
+        tokens.reserve(words.size());
+        for (uint32_t word : words)
+            tokens.push_back(hex(word));
+        return tokens;
+    }
+}
+
+#endif
@@ -0,0 +1,276 @@
+#include "FunctionalCore.hpp"
+#include "Processor.hpp"
+#include "ALU.hpp"
+#include "DataMemory.hpp"
+
+FunctionalCore::FunctionalCore(const std::vector<MicroOp> &program)
+    : PC(0), regs(32, 0), instructionsExecuted(0), program(program), code(program),
+      blockAt(program.size(), -1), lookups(0),
+      jitEnabled(JitCompiler::available()), compiled(0) {}
+
+void FunctionalCore::loadState(const Processor &cpu) {
+    PC = cpu.PC;
+    regs = cpu.regs;
+    stack_memory = cpu.stack_memory;
+    reservation = cpu.reservation;
+}
+
+bool FunctionalCore::step() {
+    if (finished())
+        return false;
+    PC = execute(program[code.indexAt(PC)], PC);
+    instructionsExecuted++;
+    return true;
+}
+
+uint32_t FunctionalCore::execute(const MicroOp &op, uint32_t pc) {
+    uint32_t rs1Val = regs[op.rs1];
+    uint32_t rs2Val = regs[op.rs2];
+    uint32_t nextPC = pc + op.size;
+    int result = 0;
+    bool writes = op.regWrite;
+
+    switch (op.type) {
+        case InstType::R_TYPE:
+            result = ALU::execute(op.aluOp, rs1Val, rs2Val);
+            break;
+        case InstType::I_TYPE:
+            if (op.opcode == 0x67) {
+                // JALR: link address to rd, jump to (rs1 + imm) with bit 0 cleared.
+                result = nextPC;
+                nextPC = (rs1Val + op.imm) & ~1u;
+            } else if (op.memRead) {
+                result = stack_memory.load(op.funct3, rs1Val + op.imm);
+            } else {
+                result = ALU::execute(op.aluOp, rs1Val, op.imm);
+            }
+            break;
+        case InstType::S_TYPE:
+            stack_memory.store(op.funct3, rs1Val + op.imm, rs2Val);
+            break;
+        case InstType::B_TYPE:
+            if (ALU::branchTaken(op.funct3, rs1Val, rs2Val))
+                nextPC = pc + op.imm;
+            break;
+        case InstType::U_TYPE:
+            // The pipeline feeds the PC as the first operand for U-type.
+            result = ALU::execute(op.aluOp, pc, op.imm);
+            break;
+        case InstType::J_TYPE:
+            result = nextPC;
+            nextPC = pc + op.imm;
+            break;
+        case InstType::A_TYPE:
+            if (op.memRead) {
+                bool wrote;
+                result = Atomics::execute(stack_memory, op.aluOp, rs1Val, rs2Val, reservation, wrote);
+            }
+            break;
+        default:
+            // NOP / UNKNOWN: no architectural effect.
+            writes = false;
+            break;
+    }
+
+    if (writes && op.rd != 0)
+        regs[op.rd] = result;
+    return nextPC;
+}
+
+// Handlers for translated instructions. Each one only does the work of its
+// instruction class; the operands were resolved at translation time and
+// instructions whose result would go to x0 use a handler without the write.
+struct ThreadedHandlers {
+    typedef FunctionalCore::ThreadedOp Op;
+
+    // Anything without a specialized handler runs through the interpreter.
+    static uint32_t generic(FunctionalCore &core, const Op &op) {
+        return core.execute(*op.source, op.pc);
+    }
+    static uint32_t skip(FunctionalCore &, const Op &op) {
+        return op.next;
+    }
+    template <int (*Fn)(int, int)>
+    static uint32_t aluRegReg(FunctionalCore &core, const Op &op) {
+        core.regs[op.rd] = Fn(core.regs[op.rs1], core.regs[op.rs2]);
+        return op.next;
+    }
+    template <int (*Fn)(int, int)>
+    static uint32_t aluRegImm(FunctionalCore &core, const Op &op) {
+        core.regs[op.rd] = Fn(core.regs[op.rs1], op.imm);
+        return op.next;
+    }
+    static uint32_t constant(FunctionalCore &core, const Op &op) {
+        core.regs[op.rd] = op.imm;
+        return op.next;
+    }
+    static uint32_t load(FunctionalCore &core, const Op &op) {
+        core.regs[op.rd] = core.stack_memory.load(op.funct3, static_cast<uint32_t>(core.regs[op.rs1]) + op.imm);
+        return op.next;
+    }
+    static uint32_t store(FunctionalCore &core, const Op &op) {
+        core.stack_memory.store(op.funct3, static_cast<uint32_t>(core.regs[op.rs1]) + op.imm, core.regs[op.rs2]);
+        return op.next;
+    }
+    static uint32_t branch(FunctionalCore &core, const Op &op) {
+        bool taken = ALU::branchTaken(op.funct3, core.regs[op.rs1], core.regs[op.rs2]);
+        return taken ? op.pc + op.imm : op.next;
+    }
+    template <bool Link>
+    static uint32_t jal(FunctionalCore &core, const Op &op) {
+        if (Link)
+            core.regs[op.rd] = op.next;
+        return op.pc + op.imm;
+    }
+    template <bool Link>
+    static uint32_t jalr(FunctionalCore &core, const Op &op) {
+        uint32_t target = (static_cast<uint32_t>(core.regs[op.rs1]) + op.imm) & ~1u;
+        if (Link)
+            core.regs[op.rd] = op.next;
+        return target;
+    }
+
+    static FunctionalCore::Handler forAluOp(ALUOp aluOp, bool immediate) {
+        switch (aluOp) {
+            case ALUOp::ADD: return immediate ? aluRegImm<ALU::add> : aluRegReg<ALU::add>;
+            case ALUOp::SUB: return immediate ? aluRegImm<ALU::sub> : aluRegReg<ALU::sub>;
+            case ALUOp::MUL: return immediate ? aluRegImm<ALU::mul> : aluRegReg<ALU::mul>;
+            case ALUOp::DIV: return immediate ? aluRegImm<ALU::div> : aluRegReg<ALU::div>;
+            case ALUOp::SLL:
+            case ALUOp::SLLI: return immediate ? aluRegImm<ALU::sll> : aluRegReg<ALU::sll>;
+            case ALUOp::SRL:
+            case ALUOp::SRLI: return immediate ? aluRegImm<ALU::srl> : aluRegReg<ALU::srl>;
+            case ALUOp::SRA:
+            case ALUOp::SRAI: return immediate ? aluRegImm<ALU::sra> : aluRegReg<ALU::sra>;
+            default: return generic;
+        }
+    }
+};
+
+// Translates the basic block starting at pc: straight-line instructions up to
+// and including the first branch or jump (or the end of the program).
+void FunctionalCore::translate(uint32_t pc, uint32_t index) {
+    typedef ThreadedHandlers H;
+    for (uint32_t length = 0; index < program.size() && length < maxBlockLength; ++index, ++length) {
+        const MicroOp &m = program[index];
+        ThreadedOp op = {H::generic, &m, pc, pc + m.size, m.imm, m.rd, m.rs1, m.rs2, m.funct3};
+        pc = op.next;
+        bool writesRd = m.regWrite && m.rd != 0;
+        bool endsBlock = false;
+
+        switch (m.type) {
+            case InstType::R_TYPE:
+                op.handler = writesRd ? H::forAluOp(m.aluOp, false) : H::skip;
+                break;
+            case InstType::I_TYPE:
+                if (m.opcode == 0x67) {
+                    op.handler = writesRd ? H::jalr<true> : H::jalr<false>;
+                    endsBlock = true;
+                } else if (m.memRead) {
+                    op.handler = writesRd ? H::load : H::skip;   // Loads have no side effects.
+                } else {
+                    op.handler = writesRd ? H::forAluOp(m.aluOp, true) : H::skip;
+                }
+                break;
+            case InstType::S_TYPE:
+                op.handler = H::store;
+                break;
+            case InstType::B_TYPE:
+                op.handler = H::branch;
+                endsBlock = true;
+                break;
+            case InstType::U_TYPE:
+                // The result only depends on the PC and the immediate.
+                op.imm = ALU::execute(m.aluOp, op.pc, m.imm);
+                op.handler = writesRd ? H::constant : H::skip;
+                break;
+            case InstType::J_TYPE:
+                op.handler = writesRd ? H::jal<true> : H::jal<false>;
+                endsBlock = true;
+                break;
+            case InstType::A_TYPE:
+                break;   // Rare; the interpreter (generic handler) does the read-modify-write.
+            default:
+                // NOP / UNKNOWN: no architectural effect.
+                op.handler = H::skip;
+                break;
+        }
+        // An ALU op without a specialized handler (e.g. ALUOp::NONE) keeps the generic one.
+        ops.push_back(op);
+        if (endsBlock)
+            break;
+    }
+}
+
+FunctionalCore::Block &FunctionalCore::lookupBlock(uint32_t pc, uint32_t first) {
+    lookups++;
+    int32_t index = blockAt[first];
+    if (index >= 0)
+        return blocks[index];
+    blockAt[first] = blocks.size();
+    Block block;
+    block.first = ops.size();
+    block.heat = 0;
+    block.native = nullptr;
+    translate(pc, first);
+    block.length = ops.size() - block.first;
+    blocks.push_back(block);
+    return blocks.back();
+}
+
+uint64_t FunctionalCore::run(uint64_t maxInstructions) {
+    uint64_t executed = 0;
+    uint32_t pc = PC;
+    int32_t index;
+    while (executed < maxInstructions && (index = code.indexAt(pc)) >= 0) {
+        // Blocks start on instruction boundaries; anything else (or a block
+        // longer than what is left to run) goes through the interpreter.
+        if (code.addressOf(index) == pc) {
+            Block &block = lookupBlock(pc, index);
+            uint32_t start = pc;
+            size_t length = block.length;
+            if (length <= maxInstructions - executed) {
+                if (jitEnabled && !block.native && block.heat == jitThreshold) {
+                    block.heat++;   // One attempt only; a block that cannot be compiled stays threaded.
+                    block.native = jit.compile(&program[index], length, start);
+                    if (block.native)
+                        compiled++;
+                }
+                // A block that branches back to its own start (a tight loop)
+                // is re-entered directly, without another lookup.
+                if (block.native) {
+                    for (;;) {
+                        pc = block.native(regs.data(), this);
+                        executed += length;
+                        if (pc != start || length > maxInstructions - executed)
+                            break;
+                        lookups++;
+                    }
+                    continue;
+                }
+                const ThreadedOp *first = &ops[block.first], *end = first + length;
+                for (;;) {
+                    for (const ThreadedOp *op = first; op != end; ++op)
+                        pc = op->handler(*this, *op);
+                    executed += length;
+                    // Once the block is hot it goes back through the lookup, where it is compiled.
+                    bool hot = ++block.heat == jitThreshold;
+                    if (pc != start || length > maxInstructions - executed || hot)
+                        break;
+                    lookups++;
+                }
+                continue;
+            }
+        }
+        pc = execute(program[index], pc);
+        executed++;
+    }
+    PC = pc;
+    instructionsExecuted += executed;
+    return executed;
+}
+
+void FunctionalCore::handOff(Processor &cpu) const {
+    cpu.restoreArchState(PC, regs, stack_memory);
+    cpu.reservation = reservation;
+}
@@ -0,0 +1,107 @@
+#ifndef FUNCTIONALCORE_HPP
+#define FUNCTIONALCORE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "MicroOp.hpp"
+#include "DataMemory.hpp"
+#include "Jit.hpp"
+#include "Atomics.hpp"
+#include "CodeMap.hpp"
+
+class Processor;
+
+// Instruction-set level execution of the pre-decoded program: one instruction
+// per step with no latches, hazards or logging. Used to fast-forward through
+// warm-up phases, after which the architectural state (registers, PC and
+// stack memory) is handed over to the cycle-accurate Processor.
+//
+// The semantics mirror the pipeline exactly (including its ALU, branch,
+// JAL/JALR and memory behaviour), so a hand-over at any instruction boundary
+// continues as if the pipeline had run from the start.
+//
+// step() interprets one MicroOp at a time. run() instead translates each basic
+// block (up to and including its branch or jump) once into an array of
+// handler pointers with the operands baked in, caches it by start PC, and then
+// executes whole blocks through those handlers. Blocks that run often enough
+// are compiled to native code by the JitCompiler where the host supports it.
+class FunctionalCore {
+public:
+    uint32_t PC;
+    std::vector<int> regs;              // 32 general-purpose registers, x0 stays 0.
+    DataMemory stack_memory;            // Same address space as the Processor's.
+    Reservation reservation;            // LR.W reservation, handed over with the rest.
+    uint64_t instructionsExecuted;
+
+    // The program is not copied; it must outlive the core.
+    explicit FunctionalCore(const std::vector<MicroOp> &program);
+
+    // Copies the architectural state of a Processor (PC, registers and memory).
+    // Only meaningful when the Processor's pipeline is empty.
+    void loadState(const Processor &cpu);
+
+    // True once PC is past the end of the program (no instruction starts at PC).
+    bool finished() const { return code.indexAt(PC) < 0; }
+
+    // Executes one instruction. Returns false if the program has finished.
+    bool step();
+    // Executes up to maxInstructions instructions through the block cache; returns how many ran.
+    uint64_t run(uint64_t maxInstructions);
+
+    // Block cache statistics.
+    size_t blockCount() const { return blocks.size(); }
+    uint64_t blockLookups() const { return lookups; }
+    uint64_t blockHits() const { return lookups - blocks.size(); }   // Every miss translates one block.
+    double blockHitRate() const { return lookups ? static_cast<double>(blockHits()) / lookups : 0.0; }
+    size_t compiledBlocks() const { return compiled; }
+
+    // Native compilation of hot blocks (on by default where available).
+    void setJitEnabled(bool enabled) { jitEnabled = enabled && JitCompiler::available(); }
+    bool isJitEnabled() const { return jitEnabled; }
+
+    // Hands registers, PC and memory to the pipeline, which restarts empty at PC.
+    void handOff(Processor &cpu) const;
+
+private:
+    struct ThreadedOp;
+    // Executes one translated instruction and returns the next PC.
+    typedef uint32_t (*Handler)(FunctionalCore &core, const ThreadedOp &op);
+
+    struct ThreadedOp {
+        Handler handler;
+        const MicroOp *source;  // Original micro-op, for the generic handler.
+        uint32_t pc;
+        uint32_t next;          // PC of the following instruction (pc + its size).
+        int32_t imm;            // Immediate, or the precomputed result of a U-type.
+        uint8_t rd, rs1, rs2, funct3;
+    };
+    // A translated block: ops[first, first + length), plus its native code once hot.
+    struct Block {
+        uint32_t first;
+        uint32_t length;
+        uint32_t heat;                      // Executions so far, until it is compiled.
+        JitCompiler::NativeBlock native;    // nullptr until compiled (or if it cannot be).
+    };
+    friend struct ThreadedHandlers;
+
+    static const size_t maxBlockLength = 64;
+    static const uint32_t jitThreshold = 16;   // Executions before a block is compiled.
+
+    const std::vector<MicroOp> &program;
+    CodeMap code;
+    std::vector<ThreadedOp> ops;    // Every translated block, back to back.
+    std::vector<Block> blocks;
+    std::vector<int32_t> blockAt;   // Block index by index of its first instruction, -1 if not translated.
+    uint64_t lookups;
+    JitCompiler jit;
+    bool jitEnabled;
+    size_t compiled;
+
+    // Interprets op at pc and returns the next PC (does not count it).
+    uint32_t execute(const MicroOp &op, uint32_t pc);
+    Block &lookupBlock(uint32_t pc, uint32_t index);
+    // Appends the translation of the block starting at pc (instruction index) to ops.
+    void translate(uint32_t pc, uint32_t index);
+};
+
+#endif // FUNCTIONALCORE_HPP
@@ -0,0 +1,93 @@
+#include "FunctionalUnits.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    bool parseCount(const std::string &text, uint32_t &value) {
+        if (text.empty() || text.size() > 4 || text.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        value = static_cast<uint32_t>(std::stoul(text));
+        return value > 0;
+    }
+}
+
+FunctionalUnits::FunctionalUnits() : FunctionalUnits(UnitConfig()) {}
+
+FunctionalUnits::FunctionalUnits(const UnitConfig &config) : cfg(config), multiCycle(false) {
+    for (int op = 0; op < UnitConfig::ops; ++op) {
+        latency[op] = cfg.timing[op].latency;
+        if (cfg.timing[op].latency > 1 || cfg.timing[op].interval > 1)
+            multiCycle = true;
+    }
+    reset();
+}
+
+bool FunctionalUnits::parseConfig(const std::string &spec, UnitConfig &config) {
+    static const struct {
+        const char *name;
+        ALUOp ops[2];
+    } names[] = {
+        {"add", {ALUOp::ADD, ALUOp::ADD}},
+        {"sub", {ALUOp::SUB, ALUOp::SUB}},
+        {"mul", {ALUOp::MUL, ALUOp::MUL}},
+        {"div", {ALUOp::DIV, ALUOp::DIV}},
+        {"sll", {ALUOp::SLL, ALUOp::SLLI}},
+        {"srl", {ALUOp::SRL, ALUOp::SRLI}},
+        {"sra", {ALUOp::SRA, ALUOp::SRAI}},
+    };
+
+    UnitConfig parsed = config;
+    std::stringstream fields(spec);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+        if (field.empty())
+            continue;
+        size_t eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+        int index = -1;
+        for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(names[0])); ++i)
+            if (key == names[i].name)
+                index = i;
+        if (index < 0) {
+            std::cerr << "Unknown functional-unit operation: " << key << std::endl;
+            return false;
+        }
+        size_t colon = value.find(':');
+        OpTiming timing;
+        if (!parseCount(value.substr(0, colon), timing.latency) ||
+            (colon != std::string::npos && !parseCount(value.substr(colon + 1), timing.interval))) {
+            std::cerr << "Invalid timing for " << key << " (expected LATENCY[:INTERVAL], 1 to 9999): " << value
+                      << std::endl;
+            return false;
+        }
+        for (ALUOp op : names[index].ops)
+            parsed.timing[static_cast<int>(op)] = timing;
+    }
+    config = parsed;
+    return true;
+}
+
+const char *FunctionalUnits::unitName(Unit unit) {
+    return unit == MULDIV_UNIT ? "mul/div" : "alu";
+}
+
+int FunctionalUnits::start(ALUOp op, unsigned slot, int cycle) {
+    const OpTiming &timing = cfg.timing[static_cast<int>(op)];
+    Unit unit = unitFor(op);
+    freeAt[unit][slotOf(op, slot)] = cycle + timing.interval;
+    int ready = cycle + timing.latency;
+    UnitCounters &c = stats[unit];
+    c.operations++;
+    c.busyCycles += ready - std::max(cycle, std::min(busyUntil[unit], ready));
+    busyUntil[unit] = std::max(busyUntil[unit], ready);
+    return ready;
+}
+
+void FunctionalUnits::reset() {
+    for (int unit = 0; unit < UNIT_KINDS; ++unit) {
+        std::fill(freeAt[unit], freeAt[unit] + slots, 0);
+        busyUntil[unit] = 0;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef FUNCTIONALUNITS_HPP
+#define FUNCTIONALUNITS_HPP
+
+#include <cstdint>
+#include <string>
+#include "MicroOp.hpp"
+
+// Timing of one ALU operation in EX.
+struct OpTiming {
+    uint32_t latency = 1;    // Cycles from entering EX until the result can be used (1 = next cycle).
+    uint32_t interval = 1;   // Cycles until its unit accepts the next operation (= latency: unpipelined).
+};
+
+struct UnitConfig {
+    static const int ops = static_cast<int>(ALUOp::SRAI) + 1;   // The R- and I-type ALU operations.
+    OpTiming timing[ops];    // Indexed by ALUOp.
+};
+
+// Per-unit events.
+struct UnitCounters {
+    uint64_t operations = 0;
+    uint64_t busyCycles = 0;      // Cycles with at least one operation in progress.
+    uint64_t issueStalls = 0;     // Frozen cycles: an operation waited in EX for the unit.
+    uint64_t resultStalls = 0;    // Frozen cycles: write-back waited for the unit's result.
+};
+
+// The EX-stage execution units and their occupancy. Every R-type and
+// register-immediate operation runs on an ALU (one per issue slot), except
+// MUL and DIV, which share one multiply/divide unit. By default every
+// operation takes one cycle and the units never block, which is the plain
+// 5-stage pipeline; enabled() is false then and the Processor skips all of
+// this.
+//
+// Otherwise an operation starts when it enters EX, occupies its unit for its
+// interval and has its result after its latency. The Processor freezes the
+// pipeline (like a cache stall) while the operation about to enter EX finds
+// its unit busy, and while an instruction about to write back is still
+// waiting for its result. Dependent instructions wait in ID through the
+// Scoreboard, which takes its latencies from latencies().
+class FunctionalUnits {
+public:
+    enum Unit : uint8_t { ALU_UNIT, MULDIV_UNIT, UNIT_KINDS };
+
+    FunctionalUnits();
+    explicit FunctionalUnits(const UnitConfig &config);
+
+    // Parses "mul=4,div=20:20" on top of config: each key is an operation
+    // (add, sub, mul, div, sll, srl, sra; shifts cover their immediate forms)
+    // and each value a latency with an optional ":interval" (default 1, fully
+    // pipelined). Returns false and reports on std::cerr if the spec is invalid.
+    static bool parseConfig(const std::string &spec, UnitConfig &config);
+    static const char *unitName(Unit unit);
+
+    static Unit unitFor(ALUOp op) {
+        return op == ALUOp::MUL || op == ALUOp::DIV ? MULDIV_UNIT : ALU_UNIT;
+    }
+    // Operations timed here: R-type and register-immediate ALU work (not loads or JALR).
+    static bool usesUnit(const MicroOp &op) {
+        return op.type == InstType::R_TYPE || (op.type == InstType::I_TYPE && !op.memRead && op.opcode != 0x67);
+    }
+
+    // True if some operation takes more than a cycle or blocks its unit.
+    bool enabled() const { return multiCycle; }
+    const UnitConfig &config() const { return cfg; }
+    // Latency per ALUOp (see UnitConfig), for the Scoreboard.
+    const uint32_t *latencies() const { return latency; }
+
+    // True if op cannot start in the given issue slot's unit in this cycle.
+    bool busy(ALUOp op, unsigned slot, int cycle) const { return cycle < freeAt[unitFor(op)][slotOf(op, slot)]; }
+    // Starts op in this cycle; returns the first cycle its result can be used.
+    int start(ALUOp op, unsigned slot, int cycle);
+    // Every unit idle (the pipeline was flushed or restored).
+    void reset();
+
+    const UnitCounters &counters(Unit unit) const { return stats[unit]; }
+    UnitCounters &counters(Unit unit) { return stats[unit]; }
+
+private:
+    static const unsigned slots = 2;   // One ALU per issue slot (Processor::maxIssueWidth).
+
+    UnitConfig cfg;
+    bool multiCycle;
+    uint32_t latency[UnitConfig::ops];
+    int freeAt[UNIT_KINDS][slots];     // First cycle each unit accepts a new operation.
+    int busyUntil[UNIT_KINDS];         // End of the latest result window, for busyCycles.
+    UnitCounters stats[UNIT_KINDS];
+
+    // The ALUs are per slot; the multiply/divide unit is shared.
+    static unsigned slotOf(ALUOp op, unsigned slot) { return unitFor(op) == ALU_UNIT ? slot : 0; }
+};
+
+#endif // FUNCTIONALUNITS_HPP
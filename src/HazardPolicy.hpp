@@ -0,0 +1,74 @@
+#ifndef HAZARDPOLICY_HPP
+#define HAZARDPOLICY_HPP
+
+#include "PipelineStage.hpp"
+#include "Scoreboard.hpp"
+
+// Hazard detection and operand forwarding, one policy type per pipeline
+// variant. The Processor's stages are instantiated once per policy, so the
+// checks below are inlined and nothing in the per-cycle path tests a mode flag.
+// Both policies decide from the register scoreboard (see Scoreboard.hpp)
+// rather than by comparing against each latch.
+//
+// Every policy provides:
+//   mustStall(inst, sb)                      -> true if the instruction in ID must wait a cycle
+//   bypass(reg, value, ex_mem, mem_wb, ex_mem2, mem_wb2, sb)
+//                                            -> value of reg for ID (branch/JALR) or EX operands
+//   storeData(reg, value, mem_wb, mem_wb2, sb) -> value a store in MEM writes for register reg
+// The ...2 latches are the second issue slot's (see Processor::setIssueWidth);
+// a writer there is the younger of its pair, so it wins over the first slot.
+
+namespace HazardPolicy {
+    // Branches and JALR resolve in ID, a cycle before other instructions need their operands.
+    inline bool resolvesInID(const MicroOp &inst) {
+        return inst.type == InstType::B_TYPE || inst.opcode == 0x67;
+    }
+}
+
+// No bypass paths: an instruction waits in ID until every older producer of
+// its sources has reached write-back.
+struct NoForwardingPolicy {
+    static const bool forwarding = false;
+
+    static bool mustStall(const MicroOp &inst, const Scoreboard &sb) {
+        return (Scoreboard::sources(inst) & sb.unwritten) != 0;
+    }
+    static uint32_t bypass(uint8_t, uint32_t value, const EX_MEM_Latch &, const MEM_WB_Latch &,
+                           const EX_MEM_Latch &, const MEM_WB_Latch &, const Scoreboard &) {
+        return value;
+    }
+    static uint32_t storeData(uint8_t, uint32_t value, const MEM_WB_Latch &, const MEM_WB_Latch &,
+                              const Scoreboard &) {
+        return value;
+    }
+};
+
+// Full forwarding from EX/MEM and MEM/WB. Only load-use hazards stall, plus
+// branches and JALR, which resolve in ID and so also wait for a producer
+// still in EX and for a load in MEM.
+struct ForwardingPolicy {
+    static const bool forwarding = true;
+
+    static bool mustStall(const MicroOp &inst, const Scoreboard &sb) {
+        return (Scoreboard::sources(inst) & sb.unforwardable[HazardPolicy::resolvesInID(inst) ? 0 : 1]) != 0;
+    }
+    // The youngest producer (EX/MEM) wins over MEM/WB.
+    static uint32_t bypass(uint8_t reg, uint32_t value, const EX_MEM_Latch &ex_mem, const MEM_WB_Latch &mem_wb,
+                           const EX_MEM_Latch &ex_mem2, const MEM_WB_Latch &mem_wb2, const Scoreboard &sb) {
+        uint32_t b = Scoreboard::bit(reg);
+        if (sb.writers[Scoreboard::MEM] & b)
+            return (sb.second[Scoreboard::MEM] & b) ? ex_mem2.aluResult : ex_mem.aluResult;
+        if (sb.writers[Scoreboard::WB] & b)
+            return (sb.second[Scoreboard::WB] & b) ? mem_wb2.writeData : mem_wb.writeData;
+        return value;
+    }
+    static uint32_t storeData(uint8_t reg, uint32_t value, const MEM_WB_Latch &mem_wb, const MEM_WB_Latch &mem_wb2,
+                              const Scoreboard &sb) {
+        uint32_t b = Scoreboard::bit(reg);
+        if (sb.writers[Scoreboard::WB] & b)
+            return (sb.second[Scoreboard::WB] & b) ? mem_wb2.writeData : mem_wb.writeData;
+        return value;
+    }
+};
+
+#endif // HAZARDPOLICY_HPP
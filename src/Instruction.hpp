@@ -4,8 +4,9 @@
 #include <string>
 #include <cstdint>
 
-// Supported instruction types.
-enum class InstType { R_TYPE, I_TYPE, S_TYPE, B_TYPE, U_TYPE, J_TYPE, NOP, UNKNOWN };
+// Supported instruction types. A_TYPE is the RV32A atomics (R format, opcode
+// 0x2F); it comes last so the values of the others stay as checkpoints store them.
+enum class InstType : uint8_t { R_TYPE, I_TYPE, S_TYPE, B_TYPE, U_TYPE, J_TYPE, NOP, UNKNOWN, A_TYPE };
 
 class Instruction {
 public:
@@ -66,6 +67,8 @@ public:
     Instruction() : rawHex("00000000"), rawOpcode(0), opcode(0), type(InstType::NOP), id(-1) {}
                     
     Instruction(const std::string &hex);
+    // From an already parsed 32-bit word (rawHex is its 8-digit hex form).
+    explicit Instruction(uint32_t word);
 
     // Decodes the raw opcode into fields.
     void decode();
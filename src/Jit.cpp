@@ -0,0 +1,263 @@
+#include "Jit.hpp"
+#include "FunctionalCore.hpp"
+#include "ALU.hpp"
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+    // Host registers used by the generated code.
+    enum Reg : uint8_t { EAX = 0, ECX = 1, EDX = 2, ESI = 6 };
+
+    const size_t bufferSize = 4 << 20;   // 4 MiB of generated code.
+
+    // Memory accesses go through the same DataMemory as the interpreter.
+    uint32_t loadHelper(FunctionalCore *core, uint32_t funct3, uint32_t addr) {
+        return core->stack_memory.load(funct3, addr);
+    }
+    void storeHelper(FunctionalCore *core, uint32_t funct3, uint32_t addr, uint32_t value) {
+        core->stack_memory.store(funct3, addr, value);
+    }
+
+    // Minimal x86-64 encoder for the handful of instructions the blocks need.
+    // The guest register file is addressed through rbx, the core through r12.
+    class Emitter {
+    public:
+        std::vector<uint8_t> code;
+
+        void byte(uint8_t b) { code.push_back(b); }
+        void bytes(std::initializer_list<uint8_t> bs) { code.insert(code.end(), bs); }
+        void imm32(uint32_t v) {
+            for (int i = 0; i < 4; ++i)
+                byte((v >> (8 * i)) & 0xFF);
+        }
+        void imm64(uint64_t v) {
+            for (int i = 0; i < 8; ++i)
+                byte((v >> (8 * i)) & 0xFF);
+        }
+
+        // push rbx; push r12; push r13 (keeps rsp 16-byte aligned for calls)
+        // mov rbx, rdi; mov r12, rsi
+        void prologue() { bytes({0x53, 0x41, 0x54, 0x41, 0x55, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4}); }
+        // pop r13; pop r12; pop rbx; ret
+        void epilogue() { bytes({0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3}); }
+
+        // host = x[guest]
+        void loadGuest(Reg host, uint8_t guest) {
+            if (guest == 0)
+                bytes({0x31, static_cast<uint8_t>(0xC0 | (host << 3) | host)});   // xor host, host
+            else
+                bytes({0x8B, static_cast<uint8_t>(0x40 | (host << 3) | 3), static_cast<uint8_t>(guest * 4)});
+        }
+        // x[guest] = host
+        void storeGuest(uint8_t guest, Reg host) {
+            bytes({0x89, static_cast<uint8_t>(0x40 | (host << 3) | 3), static_cast<uint8_t>(guest * 4)});
+        }
+        // host = value
+        void movImm(Reg host, uint32_t value) {
+            byte(0xB8 + host);
+            imm32(value);
+        }
+        // eax += value
+        void addEaxImm(uint32_t value) {
+            byte(0x05);
+            imm32(value);
+        }
+        // eax = alu(eax, ecx), with the ALU class's semantics.
+        void alu(ALUOp op) {
+            switch (op) {
+                case ALUOp::ADD: bytes({0x01, 0xC8}); break;          // add eax, ecx
+                case ALUOp::SUB: bytes({0x29, 0xC8}); break;          // sub eax, ecx
+                case ALUOp::MUL: bytes({0x0F, 0xAF, 0xC1}); break;    // imul eax, ecx
+                case ALUOp::SLL:
+                case ALUOp::SLLI: bytes({0xD3, 0xE0}); break;         // shl eax, cl (count masked to 5 bits)
+                case ALUOp::SRL:
+                case ALUOp::SRLI: bytes({0xD3, 0xE8}); break;         // shr eax, cl
+                case ALUOp::SRA:
+                case ALUOp::SRAI: bytes({0xD3, 0xF8}); break;         // sar eax, cl
+                case ALUOp::DIV:
+                    // x / 0 = 0 (as in ALU::div); x / -1 = -x without the idiv overflow trap.
+                    bytes({0x85, 0xC9,          // test ecx, ecx
+                           0x74, 0x0A,          // jz zero
+                           0x83, 0xF9, 0xFF,    // cmp ecx, -1
+                           0x74, 0x09,          // je negate
+                           0x99,                // cdq
+                           0xF7, 0xF9,          // idiv ecx
+                           0xEB, 0x06,          // jmp done
+                           0x31, 0xC0,          // zero: xor eax, eax
+                           0xEB, 0x02,          // jmp done
+                           0xF7, 0xD8});        // negate: neg eax
+                    break;                      // done:
+                default:
+                    bytes({0x31, 0xC0});        // Unsupported ALU ops yield 0, as ALU::execute does.
+                    break;
+            }
+        }
+        // edx = eax (address argument); mov rdi, r12; mov esi, funct3; call helper
+        void callMemoryHelper(const void *helper, uint8_t funct3) {
+            bytes({0x89, 0xC2});                // mov edx, eax
+            bytes({0x4C, 0x89, 0xE7});          // mov rdi, r12
+            movImm(ESI, funct3);               // mov esi, funct3
+            bytes({0x48, 0xB8});                // movabs rax, helper
+            imm64(reinterpret_cast<uint64_t>(helper));
+            bytes({0xFF, 0xD0});                // call rax
+        }
+        // eax = condition(eax ? ecx) ? taken : notTaken, then leave the block.
+        void branch(uint8_t funct3, uint32_t taken, uint32_t notTaken) {
+            int cc;
+            switch (funct3) {
+                case 0: cc = 0x4; break;   // BEQ  -> e
+                case 1: cc = 0x5; break;   // BNE  -> ne
+                case 4: cc = 0xC; break;   // BLT  -> l
+                case 5: cc = 0xD; break;   // BGE  -> ge
+                case 6: cc = 0x2; break;   // BLTU -> b
+                case 7: cc = 0x3; break;   // BGEU -> ae
+                default: cc = -1; break;   // Never taken.
+            }
+            if (cc < 0) {
+                movImm(EAX, notTaken);
+                return;
+            }
+            bytes({0x39, 0xC8});           // cmp eax, ecx
+            movImm(EAX, notTaken);
+            movImm(EDX, taken);
+            bytes({0x0F, static_cast<uint8_t>(0x40 + cc), 0xC2});   // cmovcc eax, edx
+        }
+    };
+}
+
+bool JitCompiler::available() {
+    return true;
+}
+
+JitCompiler::JitCompiler() : buffer(nullptr), capacity(0), used(0) {}
+
+JitCompiler::~JitCompiler() {
+    if (buffer)
+        munmap(buffer, capacity);
+}
+
+JitCompiler::NativeBlock JitCompiler::compile(const MicroOp *ops, size_t count, uint32_t pc) {
+    Emitter e;
+    e.prologue();
+    bool exited = false;   // The last instruction already left the next PC in eax.
+
+    for (size_t i = 0; i < count; ++i) {
+        const MicroOp &op = ops[i];
+        uint32_t next = pc + op.size;
+        bool writesRd = op.regWrite && op.rd != 0;
+        switch (op.type) {
+            case InstType::R_TYPE:
+                if (!writesRd)
+                    break;
+                e.loadGuest(EAX, op.rs1);
+                e.loadGuest(ECX, op.rs2);
+                e.alu(op.aluOp);
+                e.storeGuest(op.rd, EAX);
+                break;
+            case InstType::I_TYPE:
+                if (op.opcode == 0x67) {
+                    // JALR: target = (rs1 + imm) & ~1, read before rd is linked.
+                    e.loadGuest(EAX, op.rs1);
+                    e.addEaxImm(op.imm);
+                    e.byte(0x25);
+                    e.imm32(~1u);                 // and eax, ~1
+                    if (writesRd) {
+                        e.movImm(ECX, next);
+                        e.storeGuest(op.rd, ECX);
+                    }
+                    exited = true;
+                } else if (op.memRead) {
+                    if (!writesRd)
+                        break;                    // A load into x0 has no effect.
+                    e.loadGuest(EAX, op.rs1);
+                    e.addEaxImm(op.imm);
+                    e.callMemoryHelper(reinterpret_cast<const void *>(&loadHelper), op.funct3);
+                    e.storeGuest(op.rd, EAX);
+                } else {
+                    if (!writesRd)
+                        break;
+                    e.loadGuest(EAX, op.rs1);
+                    e.movImm(ECX, op.imm);
+                    e.alu(op.aluOp);
+                    e.storeGuest(op.rd, EAX);
+                }
+                break;
+            case InstType::S_TYPE:
+                e.loadGuest(ECX, op.rs2);         // value (fourth argument)
+                e.loadGuest(EAX, op.rs1);
+                e.addEaxImm(op.imm);
+                e.callMemoryHelper(reinterpret_cast<const void *>(&storeHelper), op.funct3);
+                break;
+            case InstType::B_TYPE:
+                e.loadGuest(EAX, op.rs1);
+                e.loadGuest(ECX, op.rs2);
+                e.branch(op.funct3, pc + op.imm, next);
+                exited = true;
+                break;
+            case InstType::U_TYPE:
+                if (writesRd) {
+                    // The pipeline computes aluOp(PC, imm); that is a constant here.
+                    e.movImm(EAX, ALU::execute(op.aluOp, pc, op.imm));
+                    e.storeGuest(op.rd, EAX);
+                }
+                break;
+            case InstType::J_TYPE:
+                if (writesRd) {
+                    e.movImm(EAX, next);
+                    e.storeGuest(op.rd, EAX);
+                }
+                e.movImm(EAX, pc + op.imm);
+                exited = true;
+                break;
+            case InstType::NOP:
+            case InstType::UNKNOWN:
+                break;                            // No architectural effect.
+            default:
+                return nullptr;
+        }
+        if (exited && i + 1 != count)
+            return nullptr;                       // Control transfers only end blocks.
+        pc = next;
+    }
+    if (!exited)
+        e.movImm(EAX, pc);     // The instruction after the block.
+    e.epilogue();
+
+    if (!buffer) {
+        void *mapped = mmap(nullptr, bufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED)
+            return nullptr;
+        buffer = static_cast<uint8_t *>(mapped);
+        capacity = bufferSize;
+    }
+    if (used + e.code.size() > capacity)
+        return nullptr;
+    // The region is writable only while a block is being copied in.
+    if (used > 0 && mprotect(buffer, capacity, PROT_READ | PROT_WRITE) != 0)
+        return nullptr;
+    uint8_t *entry = buffer + used;
+    std::memcpy(entry, e.code.data(), e.code.size());
+    used += e.code.size();
+    if (mprotect(buffer, capacity, PROT_READ | PROT_EXEC) != 0)
+        return nullptr;
+    return reinterpret_cast<NativeBlock>(entry);
+}
+
+#else
+
+bool JitCompiler::available() {
+    return false;
+}
+
+JitCompiler::JitCompiler() : buffer(nullptr), capacity(0), used(0) {}
+
+JitCompiler::~JitCompiler() {}
+
+JitCompiler::NativeBlock JitCompiler::compile(const MicroOp *, size_t, uint32_t) {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef JIT_HPP
+#define JIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MicroOp.hpp"
+
+class FunctionalCore;
+
+// Translates hot basic blocks of the functional core into native x86-64 code.
+//
+// A compiled block is a function taking the guest register file (the core's
+// 32 registers, x0 included) and the core itself, and returning the next
+// guest PC. Every guest register lives in that array; each instruction loads
+// its sources from it, computes in host registers and stores its result back,
+// so blocks can be entered and left at any block boundary. Loads and stores
+// call back into the core's DataMemory. Branches and jumps end a block and
+// produce the next PC with a conditional move.
+//
+// On hosts other than x86-64 nothing is compiled and the core keeps using its
+// threaded interpreter.
+class JitCompiler {
+public:
+    typedef uint32_t (*NativeBlock)(int32_t *regs, FunctionalCore *core);
+
+    // True if this build can generate code for the host.
+    static bool available();
+
+    JitCompiler();
+    ~JitCompiler();
+    JitCompiler(const JitCompiler &) = delete;
+    JitCompiler &operator=(const JitCompiler &) = delete;
+
+    // Compiles count micro-ops laid out back to back (MicroOp::size bytes each)
+    // from guest address pc. Returns nullptr if an instruction cannot be
+    // translated or the code buffer is full.
+    NativeBlock compile(const MicroOp *ops, size_t count, uint32_t pc);
+
+    size_t codeBytes() const { return used; }
+
+private:
+    uint8_t *buffer;     // Executable region (mapped on first use).
+    size_t capacity;
+    size_t used;
+};
+
+#endif // JIT_HPP
@@ -0,0 +1,77 @@
+#include "MicroOp.hpp"
+#include "Compressed.hpp"
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<MicroOp>::value,
+              "MicroOp is copied through the pipeline latches every cycle");
+
+MicroOp MicroOp::nop() {
+    MicroOp op = {InstType::NOP, 0, 0, 0, 0, 0, ALUOp::NONE,
+                  false, false, false, false, 4, 0, -1};
+    return op;
+}
+
+MicroOp MicroOp::fromInstruction(const Instruction &inst, int id) {
+    MicroOp op = nop();
+    op.type   = inst.type;
+    op.opcode = inst.opcode;
+    op.id     = id;
+
+    switch (inst.type) {
+        case InstType::R_TYPE:
+            op.rd     = inst.info.r.rd;
+            op.rs1    = inst.info.r.rs1;
+            op.rs2    = inst.info.r.rs2;
+            op.funct3 = inst.info.r.funct3;
+            break;
+        case InstType::I_TYPE:
+            op.rd     = inst.info.i.rd;
+            op.rs1    = inst.info.i.rs1;
+            op.funct3 = inst.info.i.funct3;
+            op.imm    = inst.info.i.imm;
+            break;
+        case InstType::S_TYPE:
+            op.rs1    = inst.info.s.rs1;
+            op.rs2    = inst.info.s.rs2;
+            op.funct3 = inst.info.s.funct3;
+            op.imm    = inst.info.s.imm;
+            break;
+        case InstType::B_TYPE:
+            op.rs1    = inst.info.b.rs1;
+            op.rs2    = inst.info.b.rs2;
+            op.funct3 = inst.info.b.funct3;
+            op.imm    = inst.info.b.imm;
+            break;
+        case InstType::A_TYPE:
+            op.rd     = inst.info.r.rd;
+            op.rs1    = inst.info.r.rs1;
+            op.rs2    = inst.info.r.rs2;
+            op.funct3 = inst.info.r.funct3;
+            break;
+        case InstType::U_TYPE:
+            op.rd  = inst.info.u.rd;
+            op.imm = inst.info.u.imm;
+            break;
+        case InstType::J_TYPE:
+            op.rd  = inst.info.j.rd;
+            op.imm = inst.info.j.imm;
+            break;
+        default:
+            // NOP / UNKNOWN: nothing to read or write.
+            break;
+    }
+
+    ControlSignals signals = ControlUnit::decode(inst);
+    op.regWrite = signals.regWrite;
+    op.memRead  = signals.memRead;
+    op.memWrite = signals.memWrite;
+    op.branch   = signals.branch;
+    op.aluOp    = signals.aluOp;
+    return op;
+}
+
+MicroOp MicroOp::fromCompressed(uint16_t half, int id) {
+    MicroOp op = fromInstruction(Instruction(Compressed::expand(half)), id);
+    op.size = 2;
+    return op;
+}
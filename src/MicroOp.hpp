@@ -0,0 +1,37 @@
+#ifndef MICROOP_HPP
+#define MICROOP_HPP
+
+#include <cstdint>
+#include "Instruction.hpp"
+#include "ControlUnit.hpp"
+
+// Pre-decoded form of an instruction. The whole program is decoded into
+// MicroOps once at load time, so the pipeline latches only ever copy this
+// small POD around and never touch the hex text or re-run the decoder.
+// Register fields that the instruction does not use are left as 0 (x0).
+struct MicroOp {
+    InstType type;        // Instruction class (R/I/S/B/U/J, NOP or UNKNOWN).
+    uint8_t opcode;       // 7-bit opcode field.
+    uint8_t rd;           // Destination register (0 if none).
+    uint8_t rs1;          // First source register (0 if unused).
+    uint8_t rs2;          // Second source register (0 if unused).
+    uint8_t funct3;
+    ALUOp aluOp;          // ALU operation resolved by the ControlUnit.
+    bool regWrite;
+    bool memRead;
+    bool memWrite;
+    bool branch;
+    uint8_t size;         // Bytes in instruction memory: 4, or 2 for a compressed instruction.
+    int32_t imm;          // Sign-extended immediate.
+    int32_t id;           // Index into instruction memory (-1 for NOP).
+
+    // Builds the micro-op for an already decoded instruction.
+    static MicroOp fromInstruction(const Instruction &inst, int id);
+    // Builds the micro-op for a 16-bit RV32C instruction from its 32-bit
+    // expansion (an unsupported encoding gives an UNKNOWN micro-op).
+    static MicroOp fromCompressed(uint16_t half, int id);
+    // A bubble: no registers, no control signals, id -1.
+    static MicroOp nop();
+};
+
+#endif // MICROOP_HPP
@@ -0,0 +1,112 @@
+#include "Multicore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+    // Reusable barrier for a fixed number of threads. The last thread to
+    // arrive runs `last` before releasing the others, so it can look at every
+    // core while none of them is moving.
+    class SpinBarrier {
+    public:
+        explicit SpinBarrier(unsigned count) : count(count), arrived(0), generation(0) {}
+
+        template <class F>
+        void wait(F last) {
+            unsigned gen = generation.load(std::memory_order_acquire);
+            if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                last();
+                arrived.store(0, std::memory_order_relaxed);
+                generation.fetch_add(1, std::memory_order_release);
+                return;
+            }
+            while (generation.load(std::memory_order_acquire) == gen)
+                std::this_thread::yield();
+        }
+
+    private:
+        const unsigned count;
+        std::atomic<unsigned> arrived;
+        std::atomic<unsigned> generation;
+    };
+}
+
+Multicore::Multicore(unsigned count, const std::vector<MicroOp> &program, const std::vector<TextView> &hex,
+                     bool forwarding, int logCycles, const std::vector<TextView> &asmInstr,
+                     const CoherenceConfig &coherence)
+    : memory(count, coherence) {
+    for (unsigned i = 0; i < count; ++i) {
+        cores.emplace_back(new Processor(program, hex, forwarding, logCycles, asmInstr));
+        Processor &core = *cores.back();
+        core.shared = &memory;
+        core.hartId = i;
+        core.regs[10] = i;       // a0 = hart id
+        core.regs[11] = count;   // a1 = number of cores
+    }
+}
+
+bool Multicore::isDrained() const {
+    for (const auto &core : cores)
+        if (!core->isDrained())
+            return false;
+    return true;
+}
+
+uint64_t Multicore::cycles() const {
+    uint64_t most = 0;
+    for (const auto &core : cores)
+        most = std::max<uint64_t>(most, core->currentCycle);
+    return most;
+}
+
+bool Multicore::run(uint64_t maxCycles, unsigned threads, unsigned quantum) {
+    threads = std::max(1u, std::min<unsigned>(threads, cores.size()));
+    quantum = std::max(1u, quantum);
+
+    // Runs cycles of the given cores round-robin until they drain or `cycles` have passed.
+    auto advance = [](const std::vector<Processor *> &mine, uint64_t cycles) {
+        for (uint64_t k = 0; k < cycles; ++k) {
+            bool busy = false;
+            for (Processor *core : mine) {
+                if (!core->isDrained()) {
+                    core->runCycle();
+                    busy = true;
+                }
+            }
+            if (!busy)
+                return;
+        }
+    };
+
+    std::vector<std::vector<Processor *>> assigned(threads);
+    for (size_t i = 0; i < cores.size(); ++i)
+        assigned[i % threads].push_back(cores[i].get());
+
+    if (threads == 1) {
+        advance(assigned[0], maxCycles > 0 ? maxCycles : UINT64_MAX);
+        return isDrained();
+    }
+
+    SpinBarrier barrier(threads);
+    bool stop = false;   // Written only by the last thread at a barrier.
+    uint64_t done = 0;
+    auto worker = [&](unsigned t) {
+        while (!stop) {
+            uint64_t step = quantum;
+            if (maxCycles > 0)
+                step = std::min<uint64_t>(step, maxCycles - done);
+            advance(assigned[t], step);
+            barrier.wait([&] {
+                done += step;
+                stop = isDrained() || (maxCycles > 0 && done >= maxCycles);
+            });
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &thread : pool)
+        thread.join();
+    return isDrained();
+}
@@ -0,0 +1,42 @@
+#ifndef MULTICORE_HPP
+#define MULTICORE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Processor.hpp"
+#include "CoherentMemory.hpp"
+
+// N Processor cores running the same program against one CoherentMemory.
+// Every core starts at PC 0 with its hart id in x10 (a0) and the core count
+// in x11 (a1), so a program can split its work and synchronize with the
+// RV32A atomics.
+//
+// run() with one host thread steps the cores round-robin, one cycle each,
+// which is exact lockstep and fully deterministic. With more threads the
+// cores are split across them and every thread runs its cores `quantum`
+// cycles ahead before a barrier, so no two cores are ever more than quantum
+// cycles apart (quantum = 1 is lockstep). Memory stays sequentially
+// consistent, but which core reaches a contended line first then depends on
+// host scheduling.
+class Multicore {
+public:
+    std::vector<std::unique_ptr<Processor>> cores;
+    CoherentMemory memory;
+
+    // logCycles is each core's pipeline-table length (0 = no table). The
+    // cores view the text without copying it, so it must outlive them.
+    Multicore(unsigned count, const std::vector<MicroOp> &program, const std::vector<TextView> &hex,
+              bool forwarding, int logCycles, const std::vector<TextView> &asmInstr,
+              const CoherenceConfig &coherence = CoherenceConfig());
+
+    bool isDrained() const;
+    // Runs until every core has drained or maxCycles have passed (0 = no cap).
+    // Returns true if every core drained.
+    bool run(uint64_t maxCycles, unsigned threads = 1, unsigned quantum = 1000);
+    // Cycles run so far (the slowest core's cycle count).
+    uint64_t cycles() const;
+};
+
+#endif // MULTICORE_HPP
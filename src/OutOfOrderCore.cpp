@@ -0,0 +1,460 @@
+#include "OutOfOrderCore.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "ALU.hpp"
+
+namespace {
+    bool parseCount(const std::string &text, uint32_t &value) {
+        if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        value = static_cast<uint32_t>(std::stoul(text));
+        return true;
+    }
+
+    // Bytes accessed by a load or store funct3 (0 for unsupported widths).
+    uint32_t accessBytes(uint8_t funct3) {
+        switch (funct3) {
+            case 0: case 4: return 1;
+            case 1: case 5: return 2;
+            case 2: case 6: return 4;
+            default: return 0;
+        }
+    }
+
+    bool isJalr(const MicroOp &op) {
+        return op.type == InstType::I_TYPE && op.opcode == 0x67;
+    }
+
+    bool isControl(const MicroOp &op) {
+        return op.type == InstType::B_TYPE || op.type == InstType::J_TYPE || isJalr(op);
+    }
+}
+
+OutOfOrderCore::OutOfOrderCore(const std::vector<MicroOp> &program, const OooConfig &config)
+    : regs(32, 0), currentCycle(0), instructionsRetired(0), program(program), code(program), cfg(config), pc(0),
+      fetchStall(0), fetchWaiting(false), rob(config.robSize), robHead(0), robCount(0), lsq(config.lsqSize),
+      lsqHead(0), lsqCount(0) {
+    std::fill(rat, rat + 32, -1);
+    freeAt[ALU_UNIT].assign(config.aluUnits, 0);
+    freeAt[MULDIV_UNIT].assign(config.mulDivUnits, 0);
+    freeAt[MEM_UNIT].assign(config.memUnits, 0);
+}
+
+bool OutOfOrderCore::parseConfig(const std::string &spec, OooConfig &config) {
+    OooConfig parsed = config;
+    std::stringstream fields(spec);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+        if (field.empty() || field == "default")
+            continue;
+        size_t eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+        uint32_t *target = nullptr;
+        if (key == "rob")
+            target = &parsed.robSize;
+        else if (key == "width")
+            target = &parsed.width;
+        else if (key == "rs")
+            target = &parsed.rsSize;
+        else if (key == "lsq")
+            target = &parsed.lsqSize;
+        else if (key == "alu")
+            target = &parsed.aluUnits;
+        else if (key == "muldiv")
+            target = &parsed.mulDivUnits;
+        else if (key == "mem")
+            target = &parsed.memUnits;
+        else {
+            std::cerr << "Unknown out-of-order parameter: " << key << std::endl;
+            return false;
+        }
+        if (!parseCount(value, *target) || *target == 0) {
+            std::cerr << "Invalid value for out-of-order parameter " << key << ": " << value << std::endl;
+            return false;
+        }
+    }
+    if (parsed.robSize > 4096 || parsed.rsSize > 4096 || parsed.lsqSize > 4096 || parsed.width > 16) {
+        std::cerr << "Out-of-order ROB, station and LSQ sizes must be at most 4096 and width at most 16"
+                  << std::endl;
+        return false;
+    }
+    config = parsed;
+    return true;
+}
+
+std::string OutOfOrderCore::configString(const OooConfig &config) {
+    std::ostringstream out;
+    out << "rob=" << config.robSize << ",width=" << config.width << ",rs=" << config.rsSize
+        << ",lsq=" << config.lsqSize << ",alu=" << config.aluUnits << ",muldiv=" << config.mulDivUnits
+        << ",mem=" << config.memUnits;
+    return out.str();
+}
+
+bool OutOfOrderCore::isDrained() const {
+    return robCount == 0 && fetchQueue.empty() && code.indexAt(pc) < 0;
+}
+
+bool OutOfOrderCore::runUntilDrained(uint64_t maxCycles) {
+    while (!isDrained()) {
+        if (maxCycles > 0 && currentCycle >= maxCycles)
+            return false;
+        runCycle();
+    }
+    return true;
+}
+
+void OutOfOrderCore::runCycle() {
+    // Oldest work first, so every step sees the state the previous cycle left
+    // behind plus what the older steps freed up this cycle.
+    complete();
+    commit();
+    issue();
+    dispatch();
+    fetch();
+    currentCycle++;
+}
+
+void OutOfOrderCore::complete() {
+    // Oldest first: a mispredicted branch squashes younger results due this cycle.
+    while (true) {
+        size_t oldest = inFlight.size();
+        for (size_t i = 0; i < inFlight.size(); ++i) {
+            if (inFlight[i].cycle <= currentCycle &&
+                (oldest == inFlight.size() || age(inFlight[i].rob) < age(inFlight[oldest].rob)))
+                oldest = i;
+        }
+        if (oldest == inFlight.size())
+            return;
+        uint32_t entry = inFlight[oldest].rob;
+        inFlight.erase(inFlight.begin() + oldest);
+
+        RobEntry &e = rob[entry];
+        e.done = true;
+        for (auto &station : stations) {
+            for (auto &src : station.src) {
+                if (!src.ready && src.tag == entry) {
+                    src.ready = true;
+                    src.value = e.value;
+                }
+            }
+        }
+        if (e.op.type == InstType::B_TYPE || isJalr(e.op))
+            resolveControl(entry);
+    }
+}
+
+void OutOfOrderCore::commit() {
+    for (uint32_t n = 0; n < cfg.width && robCount > 0; ++n) {
+        RobEntry &e = rob[robHead];
+        if (!e.done)
+            return;
+        const MicroOp &op = e.op;
+        if (e.lsq >= 0) {
+            const MemEntry &m = lsq[lsqHead];
+            if (op.type == InstType::S_TYPE) {
+                // Stores write memory only now; the D-cache sees them for its counters.
+                stack_memory.store(m.funct3, m.addr, m.data);
+                if (dcache.enabled())
+                    dcache.access(m.addr, true);
+                counters.stores++;
+            } else if (op.type == InstType::I_TYPE) {
+                counters.loads++;
+            }
+            lsqHead = (lsqHead + 1) % cfg.lsqSize;
+            lsqCount--;
+        }
+        if (op.regWrite && op.rd != 0) {
+            regs[op.rd] = e.value;
+            if (rat[op.rd] == static_cast<int>(robHead))
+                rat[op.rd] = -1;
+        }
+        if (isControl(op))
+            predictor.resolve(e.pc, op, e.taken, e.nextPC, e.predictedPC);
+        robHead = (robHead + 1) % cfg.robSize;
+        robCount--;
+        if (op.type != InstType::NOP)
+            instructionsRetired++;
+    }
+}
+
+int OutOfOrderCore::freeUnit(Unit unit) const {
+    for (size_t k = 0; k < freeAt[unit].size(); ++k)
+        if (freeAt[unit][k] <= currentCycle)
+            return static_cast<int>(k);
+    return -1;
+}
+
+void OutOfOrderCore::issue() {
+    uint32_t total = 0;
+    for (size_t i = 0; i < stations.size() && total < cfg.width;) {
+        const Station &s = stations[i];
+        uint32_t latency = 1;
+        int unit = s.src[0].ready && s.src[1].ready ? freeUnit(s.unit) : -1;
+        if (unit < 0 || !execute(s, latency)) {
+            ++i;
+            continue;
+        }
+        // Timed operations keep their unit for their interval; everything else for a cycle.
+        const MicroOp &op = rob[s.rob].op;
+        uint32_t interval = 1;
+        if (FunctionalUnits::usesUnit(op) && static_cast<int>(op.aluOp) < UnitConfig::ops) {
+            latency = unitTiming.timing[static_cast<int>(op.aluOp)].latency;
+            interval = unitTiming.timing[static_cast<int>(op.aluOp)].interval;
+        }
+        freeAt[s.unit][unit] = currentCycle + interval;
+        total++;
+        counters.issued++;
+        Completion done = {s.rob, currentCycle + latency};
+        inFlight.push_back(done);
+        stations.erase(stations.begin() + i);
+    }
+}
+
+bool OutOfOrderCore::execute(const Station &station, uint32_t &latency) {
+    RobEntry &e = rob[station.rob];
+    const MicroOp &op = e.op;
+    uint32_t a = station.src[0].value;
+    uint32_t b = station.src[1].value;
+
+    switch (op.type) {
+        case InstType::R_TYPE:
+            e.value = ALU::execute(op.aluOp, a, b);
+            break;
+        case InstType::I_TYPE:
+            if (isJalr(op)) {
+                e.value = e.pc + op.size;
+                e.nextPC = (a + op.imm) & ~1u;
+                e.taken = true;
+            } else if (op.memRead) {
+                return executeLoad(e, a + op.imm, latency);
+            } else {
+                e.value = ALU::execute(op.aluOp, a, op.imm);
+            }
+            break;
+        case InstType::S_TYPE: {
+            MemEntry &m = lsq[e.lsq];
+            m.addr = a + op.imm;
+            m.data = b;
+            m.addressKnown = true;
+            break;
+        }
+        case InstType::B_TYPE:
+            e.taken = ALU::branchTaken(op.funct3, a, b);
+            e.nextPC = e.taken ? e.pc + op.imm : e.pc + op.size;
+            break;
+        case InstType::U_TYPE:
+            // The PC is the first operand for U-type, as in the pipeline.
+            e.value = ALU::execute(op.aluOp, e.pc, op.imm);
+            break;
+        case InstType::A_TYPE:
+            // Only at the head: every older access has committed and nothing younger has touched memory.
+            if (station.rob != robHead)
+                return false;
+            e.value = 0;
+            if (op.memRead) {
+                bool wrote;
+                e.value = Atomics::execute(stack_memory, op.aluOp, a, b, reservation, wrote);
+                latency = dcache.enabled() ? dcache.access(a, true) : 1;
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+bool OutOfOrderCore::executeLoad(RobEntry &entry, uint32_t addr, uint32_t &latency) {
+    const uint8_t funct3 = entry.op.funct3;
+    const uint64_t bytes = accessBytes(funct3);
+
+    // Youngest older store first; any older store with an unknown address blocks the load.
+    uint32_t position = (entry.lsq + cfg.lsqSize - lsqHead) % cfg.lsqSize;
+    const MemEntry *source = nullptr;
+    for (uint32_t k = position; k-- > 0;) {
+        const MemEntry &m = lsq[(lsqHead + k) % cfg.lsqSize];
+        if (!m.store)
+            continue;
+        if (!m.addressKnown) {
+            counters.loadWaits++;
+            return false;
+        }
+        uint64_t storeBytes = accessBytes(m.funct3);
+        if (source || bytes == 0 || storeBytes == 0)
+            continue;
+        uint64_t begin = addr, storeBegin = m.addr;
+        if (storeBegin < begin + bytes && begin < storeBegin + storeBytes) {
+            if (begin < storeBegin || begin + bytes > storeBegin + storeBytes) {
+                // Partial overlap: wait until the store has reached memory.
+                counters.loadWaits++;
+                return false;
+            }
+            source = &m;
+        }
+    }
+
+    if (source) {
+        uint32_t raw = source->data >> (8 * (addr - source->addr));
+        switch (funct3) {
+            case 0: entry.value = static_cast<int8_t>(raw); break;
+            case 1: entry.value = static_cast<int16_t>(raw); break;
+            case 4: entry.value = raw & 0xff; break;
+            case 5: entry.value = raw & 0xffff; break;
+            default: entry.value = raw; break;
+        }
+        counters.storeForwards++;
+        latency = 2;
+    } else {
+        entry.value = stack_memory.load(funct3, addr);
+        latency = 1 + (dcache.enabled() ? dcache.access(addr, false) : 1);
+    }
+    return true;
+}
+
+OutOfOrderCore::Operand OutOfOrderCore::rename(uint8_t reg) const {
+    Operand operand = {true, regs[reg], 0};
+    int writer = rat[reg];
+    if (writer >= 0) {
+        if (rob[writer].done) {
+            operand.value = rob[writer].value;
+        } else {
+            operand.ready = false;
+            operand.tag = writer;
+        }
+    }
+    return operand;
+}
+
+void OutOfOrderCore::dispatch() {
+    for (uint32_t n = 0; n < cfg.width && !fetchQueue.empty(); ++n) {
+        const Fetched f = fetchQueue.front();
+        if (f.ready > currentCycle)
+            return;
+        const MicroOp &op = program[code.indexAt(f.pc)];
+        bool memory = op.memRead || op.memWrite || op.type == InstType::A_TYPE;
+        bool station = !(op.type == InstType::J_TYPE || op.type == InstType::NOP || op.type == InstType::UNKNOWN);
+        if (robCount == cfg.robSize) {
+            counters.robFullCycles++;
+            return;
+        }
+        if (station && stations.size() == cfg.rsSize) {
+            counters.rsFullCycles++;
+            return;
+        }
+        if (memory && lsqCount == cfg.lsqSize) {
+            counters.lsqFullCycles++;
+            return;
+        }
+        fetchQueue.pop_front();
+
+        uint32_t entry = (robHead + robCount) % cfg.robSize;
+        robCount++;
+        RobEntry &e = rob[entry];
+        e.op = op;
+        e.pc = f.pc;
+        e.predictedPC = f.predictedPC;
+        e.nextPC = f.pc + op.size;
+        e.value = 0;
+        e.done = !station;
+        e.taken = false;
+        e.lsq = -1;
+        if (memory) {
+            e.lsq = (lsqHead + lsqCount) % cfg.lsqSize;
+            lsqCount++;
+            MemEntry m = {entry, op.memWrite || op.type == InstType::A_TYPE, false, op.funct3, 0, 0};
+            lsq[e.lsq] = m;
+        }
+        if (station) {
+            Station s;
+            s.rob = entry;
+            s.unit = memory ? MEM_UNIT
+                   : (op.type == InstType::R_TYPE && (op.aluOp == ALUOp::MUL || op.aluOp == ALUOp::DIV))
+                       ? MULDIV_UNIT : ALU_UNIT;
+            s.src[0] = rename(op.rs1);
+            s.src[1] = rename(op.rs2);
+            stations.push_back(s);
+        }
+        if (op.regWrite && op.rd != 0)
+            rat[op.rd] = entry;
+
+        if (op.type == InstType::J_TYPE) {
+            // The target is in the instruction, so JAL resolves here.
+            e.value = f.pc + op.size;
+            e.nextPC = f.pc + op.imm;
+            e.taken = true;
+            resolveControl(entry);
+        }
+    }
+}
+
+void OutOfOrderCore::resolveControl(uint32_t entry) {
+    const RobEntry &e = rob[entry];
+    if (!predictor.enabled()) {
+        // Fetch stopped behind it, so there is nothing to squash.
+        pc = e.nextPC;
+        fetchWaiting = false;
+    } else if (e.nextPC != e.predictedPC) {
+        counters.mispredictions++;
+        squashAfter(entry, e.nextPC);
+    }
+}
+
+void OutOfOrderCore::squashAfter(uint32_t entry, uint32_t target) {
+    const uint32_t keep = age(entry) + 1;
+    while (robCount > keep) {
+        const RobEntry &youngest = rob[(robHead + robCount - 1) % cfg.robSize];
+        if (youngest.lsq >= 0)
+            lsqCount--;
+        robCount--;
+        counters.squashed++;
+    }
+    stations.erase(std::remove_if(stations.begin(), stations.end(),
+                                  [&](const Station &s) { return age(s.rob) >= keep; }),
+                   stations.end());
+    inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(),
+                                  [&](const Completion &c) { return age(c.rob) >= keep; }),
+                   inFlight.end());
+    counters.squashed += fetchQueue.size();
+    fetchQueue.clear();
+
+    // Rebuild the alias table from the surviving entries.
+    std::fill(rat, rat + 32, -1);
+    for (uint32_t k = 0; k < robCount; ++k) {
+        uint32_t index = (robHead + k) % cfg.robSize;
+        const MicroOp &op = rob[index].op;
+        if (op.regWrite && op.rd != 0)
+            rat[op.rd] = index;
+    }
+    pc = target;
+    fetchStall = 0;
+}
+
+void OutOfOrderCore::fetch() {
+    if (fetchWaiting)
+        return;
+    if (fetchStall > 0) {
+        fetchStall--;
+        return;
+    }
+    const size_t capacity = 2 * cfg.width;
+    if (code.indexAt(pc) < 0 || fetchQueue.size() >= capacity)
+        return;
+
+    // One I-cache lookup per fetch group; a miss holds the group and fetch for its extra cycles.
+    uint32_t latency = icache.enabled() ? icache.access(pc, false) : 1;
+    int32_t index;
+    for (uint32_t n = 0; n < cfg.width && fetchQueue.size() < capacity && (index = code.indexAt(pc)) >= 0; ++n) {
+        const MicroOp &op = program[index];
+        Fetched f = {pc, predictor.predict(pc, op.size), currentCycle + latency};
+        fetchQueue.push_back(f);
+        if (!predictor.enabled() && isControl(op)) {
+            fetchWaiting = true;
+            break;
+        }
+        pc = f.predictedPC;
+        if (pc != f.pc + op.size)
+            break;
+    }
+    fetchStall = latency - 1;
+}
@@ -0,0 +1,176 @@
+#ifndef OUTOFORDERCORE_HPP
+#define OUTOFORDERCORE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "MicroOp.hpp"
+#include "DataMemory.hpp"
+#include "Cache.hpp"
+#include "BranchPredictor.hpp"
+#include "Atomics.hpp"
+#include "FunctionalUnits.hpp"
+#include "CodeMap.hpp"
+
+struct OooConfig {
+    uint32_t robSize = 32;       // Reorder buffer entries (instructions in flight).
+    uint32_t width = 2;          // Instructions fetched, dispatched, issued and committed per cycle.
+    uint32_t rsSize = 16;        // Reservation-station entries, shared by all units.
+    uint32_t lsqSize = 16;       // Load/store queue entries.
+    uint32_t aluUnits = 2;       // Integer ALUs (also resolve branches and JALR).
+    uint32_t mulDivUnits = 1;    // Multiply/divide units.
+    uint32_t memUnits = 1;       // Address units: loads, stores and atomics issued per cycle.
+};
+
+// Events of an OutOfOrderCore run.
+struct OooCounters {
+    uint64_t robFullCycles = 0;     // Dispatch stopped: no ROB entry free.
+    uint64_t rsFullCycles = 0;      // Dispatch stopped: no reservation station free.
+    uint64_t lsqFullCycles = 0;     // Dispatch stopped: no load/store queue entry free.
+    uint64_t issued = 0;            // Instructions sent to a functional unit.
+    uint64_t mispredictions = 0;    // Branches and jumps whose predicted path was wrong.
+    uint64_t squashed = 0;          // Wrong-path instructions discarded from the ROB and fetch queue.
+    uint64_t storeForwards = 0;     // Loads served by an older store still in the LSQ.
+    uint64_t loadWaits = 0;         // Cycles a ready load was held back by an older store.
+    uint64_t loads = 0;             // Retired loads.
+    uint64_t stores = 0;            // Retired stores.
+};
+
+// Out-of-order alternative to the 5-stage Processor, for measuring how much
+// of its hazard and branch stall time dynamic scheduling recovers on the same
+// program. It runs the pre-decoded MicroOps with the same ALU, memory,
+// atomics, caches and predictor, and ends with the same architectural state.
+//
+// Each cycle, oldest work first:
+//   complete  results whose latency has elapsed are written to their ROB entry
+//             and broadcast to the reservation stations; a branch or JALR that
+//             went the wrong way squashes everything younger and restarts fetch;
+//   commit    up to `width` finished instructions leave the ROB head in order,
+//             writing regs and (stores) memory and training the predictor;
+//   issue     up to `width` ready stations, oldest first, start on a free unit
+//             (ALU and mul/div operations take their UnitConfig latency and keep
+//             their unit for its interval, loads 1 cycle + D-cache, the rest 1 cycle);
+//   dispatch  up to `width` fetched instructions are renamed (the register
+//             alias table maps each register to the ROB entry of its youngest
+//             in-flight writer) and take a ROB, station and LSQ entry;
+//   fetch     up to `width` instructions along the predicted path, ending at a
+//             predicted-taken branch. Without a predictor fetch waits at every
+//             branch and jump until it resolves. JAL resolves at dispatch.
+//
+// Loads issue once every older store's address is known. A load covered by
+// the youngest older store to its bytes takes the value from the LSQ, one
+// that only partly overlaps it waits for the store to commit, and the rest
+// read memory (which only committed stores have written). Atomics execute at
+// the ROB head, so they never run speculatively or pass another access.
+class OutOfOrderCore {
+public:
+    std::vector<int> regs;          // Committed registers, x0 stays 0.
+    DataMemory stack_memory;        // Committed memory, same address space as the Processor's.
+    Reservation reservation;        // LR.W reservation.
+    Cache icache;                   // Timing only, as in the Processor (disabled unless configured).
+    Cache dcache;
+    BranchPredictor predictor;      // Predicts at fetch, trains at commit.
+    uint64_t currentCycle;
+    uint64_t instructionsRetired;
+    OooCounters counters;
+
+    // The program is not copied; it must outlive the core.
+    explicit OutOfOrderCore(const std::vector<MicroOp> &program, const OooConfig &config = OooConfig());
+
+    // Parses "rob=64,width=4,rs=32,lsq=16,alu=3,muldiv=1,mem=2" on top of
+    // config (every key is optional; "default" keeps config as is). Returns
+    // false and reports on std::cerr if the spec is invalid.
+    static bool parseConfig(const std::string &spec, OooConfig &config);
+    // The configuration in parseConfig's syntax, every key spelled out.
+    static std::string configString(const OooConfig &config);
+    const OooConfig &config() const { return cfg; }
+    // Latencies and intervals of the ALU and mul/div operations (single-cycle by default).
+    void setUnitTiming(const UnitConfig &config) { unitTiming = config; }
+
+    void runCycle();
+    // True once fetch is past the end of the program and the ROB is empty.
+    bool isDrained() const;
+    // Runs cycles until the core drains or maxCycles have run (0 = no cap).
+    // Returns true if it drained.
+    bool runUntilDrained(uint64_t maxCycles);
+
+private:
+    enum Unit : uint8_t { ALU_UNIT, MULDIV_UNIT, MEM_UNIT, UNIT_KINDS };
+
+    struct Operand {
+        bool ready;
+        int32_t value;
+        uint32_t tag;       // ROB entry producing the value, while not ready.
+    };
+    struct RobEntry {
+        MicroOp op;
+        uint32_t pc;
+        uint32_t predictedPC;   // Where fetch went after it.
+        uint32_t nextPC;        // Where it actually goes (known once done).
+        int32_t value;          // Result for rd.
+        bool done;
+        bool taken;
+        int lsq;                // Its LSQ entry, or -1.
+    };
+    struct Station {
+        uint32_t rob;
+        Unit unit;
+        Operand src[2];         // rs1, rs2 (x0 when unused).
+    };
+    struct MemEntry {
+        uint32_t rob;
+        bool store;             // Stores and atomics; loads must not pass them blindly.
+        bool addressKnown;      // Stores: address and data computed. Atomics never (until they commit).
+        uint8_t funct3;
+        uint32_t addr;
+        uint32_t data;
+    };
+    struct Completion {
+        uint32_t rob;
+        uint64_t cycle;         // First cycle its result can be used.
+    };
+    struct Fetched {
+        uint32_t pc;
+        uint32_t predictedPC;
+        uint64_t ready;         // First cycle it can be dispatched.
+    };
+
+    const std::vector<MicroOp> &program;
+    CodeMap code;
+    OooConfig cfg;
+    UnitConfig unitTiming;
+    std::vector<uint64_t> freeAt[UNIT_KINDS];   // Per unit: first cycle it accepts an operation.
+    uint32_t pc;                // Next fetch address.
+    uint32_t fetchStall;        // Cycles fetch still waits on the I-cache.
+    bool fetchWaiting;          // No predictor: fetch stopped at an unresolved branch or jump.
+    std::deque<Fetched> fetchQueue;
+    std::vector<RobEntry> rob;  // Circular, program order from robHead.
+    uint32_t robHead, robCount;
+    std::vector<MemEntry> lsq;  // Circular, program order from lsqHead.
+    uint32_t lsqHead, lsqCount;
+    std::vector<Station> stations;      // Dispatch (= age) order.
+    std::vector<Completion> inFlight;
+    int rat[32];                // ROB entry of each register's youngest in-flight writer, or -1.
+
+    void complete();
+    void commit();
+    void issue();
+    void dispatch();
+    void fetch();
+
+    // Position of a ROB entry counted from the head (0 = oldest).
+    uint32_t age(uint32_t entry) const { return (entry + cfg.robSize - robHead) % cfg.robSize; }
+    Operand rename(uint8_t reg) const;
+    // Computes the station's result into its ROB entry; false if it cannot start this cycle.
+    bool execute(const Station &station, uint32_t &latency);
+    // A unit of the station's kind that is free this cycle, or -1.
+    int freeUnit(Unit unit) const;
+    bool executeLoad(RobEntry &entry, uint32_t addr, uint32_t &latency);
+    // Fetch resumes at target: after a misprediction (dropping everything
+    // younger than entry) or once a branch resolves with fetch waiting on it.
+    void resolveControl(uint32_t entry);
+    void squashAfter(uint32_t entry, uint32_t target);
+};
+
+#endif // OUTOFORDERCORE_HPP
@@ -0,0 +1,106 @@
+#include "PerfCounters.hpp"
+#include "Processor.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace {
+    void writeCache(std::ostream &out, const char *name, const Cache &cache) {
+        out << "    \"" << name << "\": {\"accesses\": " << cache.accesses() << ", \"hits\": " << cache.hitCount()
+            << ", \"misses\": " << cache.missCount() << ", \"evictions\": " << cache.evictionCount()
+            << ", \"writebacks\": " << cache.writebackCount() << "}";
+    }
+}
+
+namespace PerfReport {
+    void writeJson(const Processor &cpu, std::ostream &out) {
+        const PerfCounters &c = cpu.counters;
+        uint64_t cycles = cpu.currentCycle;
+        uint64_t retired = cpu.instructionsRetired;
+
+        out << "{\n";
+        out << "  \"forwarding\": " << (cpu.forwardingEnabled ? "true" : "false") << ",\n";
+        out << "  \"cycles\": " << cycles << ",\n";
+        out << "  \"instructions_retired\": " << retired << ",\n";
+        // Ratios are null rather than infinite when nothing has run yet.
+        if (retired > 0)
+            out << "  \"cpi\": " << static_cast<double>(cycles) / retired << ",\n";
+        else
+            out << "  \"cpi\": null,\n";
+        if (cycles > 0)
+            out << "  \"ipc\": " << static_cast<double>(retired) / cycles << ",\n";
+        else
+            out << "  \"ipc\": null,\n";
+        out << "  \"stall_cycles\": {\n";
+        out << "    \"total\": " << cpu.stallCycles + cpu.cacheStallCycles + cpu.unitStallCycles << ",\n";
+        out << "    \"load_use\": " << c.loadUseStalls << ",\n";
+        out << "    \"branch_operand\": " << c.branchStalls << ",\n";
+        out << "    \"jalr_operand\": " << c.jalrStalls << ",\n";
+        out << "    \"raw_no_forwarding\": " << c.rawStalls << ",\n";
+        out << "    \"unit_latency\": " << c.unitLatencyStalls << ",\n";
+        out << "    \"cache\": " << cpu.cacheStallCycles << ",\n";
+        out << "    \"functional_units\": " << cpu.unitStallCycles << "\n";
+        out << "  },\n";
+        out << "  \"flushed_fetches\": " << cpu.flushedFetches << ",\n";
+        out << "  \"loads\": " << c.loads << ",\n";
+        out << "  \"stores\": " << c.stores << ",\n";
+        out << "  \"branches\": {\"taken\": " << c.branchesTaken << ", \"not_taken\": " << c.branchesNotTaken << "},\n";
+        out << "  \"jumps\": " << c.jumps;
+        if (cpu.issueWidth > 1) {
+            uint64_t slots = cycles * cpu.issueWidth;
+            out << ",\n  \"issue\": {\"width\": " << cpu.issueWidth << ", \"issued\": " << c.issued
+                << ", \"slot_utilization\": " << (slots > 0 ? static_cast<double>(c.issued) / slots : 0.0)
+                << ", \"pairs\": " << c.pairsIssued << ", \"second_slot_lost\": {\"dependency\": "
+                << c.pairDependency << ", \"memory_port\": " << c.pairMemoryPort << ", \"mul_div\": "
+                << c.pairMulDiv << ", \"control\": " << c.pairControl << ", \"hazard\": " << c.pairHazard
+                << ", \"empty\": " << c.pairEmpty << "}}";
+        }
+        if (!cpu.code.fixedWidth() || cpu.fetchBlock) {
+            out << ",\n  \"code\": {\"instructions\": " << cpu.code.instructions() << ", \"bytes\": "
+                << cpu.code.bytes() << ", \"compressed\": " << cpu.code.compressedCount() << "}";
+            out << ",\n  \"fetch\": {\"block\": " << cpu.fetchBlock << ", \"bytes\": " << c.fetchedBytes
+                << ", \"blocks\": " << c.fetchBlocks << ", \"split_bubbles\": " << c.fetchSplits
+                << ", \"block_ends\": " << c.fetchBlockEnds << "}";
+        }
+        if (cpu.units.enabled()) {
+            out << ",\n  \"units\": {";
+            for (int u = 0; u < FunctionalUnits::UNIT_KINDS; ++u) {
+                FunctionalUnits::Unit unit = static_cast<FunctionalUnits::Unit>(u);
+                const UnitCounters &k = cpu.units.counters(unit);
+                out << (u ? ", " : "") << "\"" << FunctionalUnits::unitName(unit) << "\": {\"operations\": "
+                    << k.operations << ", \"busy_cycles\": " << k.busyCycles << ", \"issue_stalls\": "
+                    << k.issueStalls << ", \"result_stalls\": " << k.resultStalls << "}";
+            }
+            out << "}";
+        }
+        if (cpu.predictor.enabled()) {
+            out << ",\n  \"predictor\": {\"kind\": \"" << BranchPredictor::kindName(cpu.predictor.config().kind)
+                << "\", \"resolved\": " << cpu.predictor.branches()
+                << ", \"mispredicted\": " << cpu.predictor.mispredictions() << "}";
+        }
+        if (cpu.icache.enabled() || cpu.dcache.enabled()) {
+            out << ",\n  \"caches\": {\n";
+            if (cpu.icache.enabled())
+                writeCache(out, "icache", cpu.icache);
+            if (cpu.icache.enabled() && cpu.dcache.enabled())
+                out << ",\n";
+            if (cpu.dcache.enabled())
+                writeCache(out, "dcache", cpu.dcache);
+            out << "\n  }";
+        }
+        out << "\n}" << std::endl;
+    }
+
+    bool writeJson(const Processor &cpu, const std::string &filename) {
+        if (filename == "-") {
+            writeJson(cpu, std::cout);
+            return true;
+        }
+        std::ofstream out(filename);
+        if (!out) {
+            std::cerr << "Error opening " << filename << " for writing" << std::endl;
+            return false;
+        }
+        writeJson(cpu, out);
+        return static_cast<bool>(out);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+class Processor;
+
+// Pipeline event counts beyond the Processor's cycle, retire and stall
+// totals. Each one is a plain increment at the point where the event
+// happens (decode for stalls and branch outcomes, write-back for retired
+// memory operations), so collection can stay on in every run.
+struct PerfCounters {
+    // Cycles ID inserted a bubble, by cause. Together they add up to Processor::stallCycles.
+    uint64_t loadUseStalls = 0;     // Forwarding: an operand comes from a load still in EX.
+    uint64_t branchStalls = 0;      // A branch waits in ID for its operands.
+    uint64_t jalrStalls = 0;        // A JALR waits in ID for its base register.
+    uint64_t rawStalls = 0;         // No forwarding: any other operand not yet written back.
+    uint64_t unitLatencyStalls = 0; // Forwarding: an operand comes from a multi-cycle operation still running.
+
+    uint64_t loads = 0;             // Retired loads.
+    uint64_t stores = 0;            // Retired stores.
+    uint64_t branchesTaken = 0;     // Conditional branches resolved in ID, by outcome.
+    uint64_t branchesNotTaken = 0;
+    uint64_t jumps = 0;             // JAL and JALR resolved in ID.
+
+    // Dual issue only: instructions sent from ID to EX, cycles that sent a
+    // pair, and why the second slot of a cycle whose first slot issued stayed empty.
+    uint64_t issued = 0;
+    uint64_t pairsIssued = 0;
+    uint64_t pairDependency = 0;    // The younger reads the older one's result.
+    uint64_t pairMemoryPort = 0;    // Both access memory (one port).
+    uint64_t pairMulDiv = 0;        // Both need the multiply/divide unit.
+    uint64_t pairControl = 0;       // The older is a branch or jump.
+    uint64_t pairHazard = 0;        // The younger waits on an instruction already in flight.
+    uint64_t pairEmpty = 0;         // Fetch supplied no second instruction.
+
+    // Fetch bandwidth. Bytes of instructions fetched (wrong-path fetches
+    // included); with a fetch block (Processor::setFetchBlock), the blocks
+    // read, bubbles for instructions split across two blocks, and dual-issue
+    // fetches cut to one instruction because the second left the block.
+    uint64_t fetchedBytes = 0;
+    uint64_t fetchBlocks = 0;
+    uint64_t fetchSplits = 0;
+    uint64_t fetchBlockEnds = 0;
+};
+
+// End-of-run report of a Processor's counters as one JSON object: cycles,
+// retired instructions, CPI/IPC, stall cycles by cause, flushed fetches,
+// loads/stores, branch outcomes, and the cache, predictor and functional-unit
+// counters when those are enabled (code size and fetch bandwidth for a
+// compressed program or a fetch block).
+namespace PerfReport {
+    void writeJson(const Processor &cpu, std::ostream &out);
+    // Writes to filename, or to std::cout for "-". Returns false (and reports
+    // on std::cerr) if the file cannot be written.
+    bool writeJson(const Processor &cpu, const std::string &filename);
+}
+
+#endif // PERFCOUNTERS_HPP
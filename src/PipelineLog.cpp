@@ -0,0 +1,61 @@
+#include "PipelineLog.hpp"
+
+void PipelineLog::record(int instrId, Stage stage) {
+    for (auto &cell : window) {
+        if (cell.instrId == instrId) {
+            cell.stages |= stage;
+            return;
+        }
+    }
+    Event cell = {0, instrId, static_cast<uint8_t>(stage)};
+    window.push_back(cell);
+}
+
+void PipelineLog::endCycle(uint32_t cycle) {
+    for (auto &cell : window) {
+        cell.cycle = cycle;
+        log.push_back(cell);
+    }
+    window.clear();
+}
+
+void PipelineLog::clear() {
+    window.clear();
+    log.clear();
+}
+
+void PipelineLog::groupByInstruction(size_t rows, std::vector<size_t> &offsets, std::vector<Cell> &cells) const {
+    // Counting sort by instruction id; the log is already in cycle order,
+    // so each bucket comes out in cycle order as well.
+    offsets.assign(rows + 1, 0);
+    for (const auto &e : log) {
+        if (e.instrId >= 0 && static_cast<size_t>(e.instrId) < rows)
+            offsets[e.instrId + 1]++;
+    }
+    for (size_t i = 0; i < rows; ++i)
+        offsets[i + 1] += offsets[i];
+
+    cells.resize(offsets[rows]);
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (const auto &e : log) {
+        if (e.instrId >= 0 && static_cast<size_t>(e.instrId) < rows) {
+            Cell c = {e.cycle, e.stages};
+            cells[next[e.instrId]++] = c;
+        }
+    }
+}
+
+std::string PipelineLog::cellText(uint8_t stages) {
+    static const char *names[] = {"IF", "EX", "MEM", "WB", "ID"};
+    std::string text;
+    for (int bit = 0; bit < 5; ++bit) {
+        if (stages & (1 << bit)) {
+            if (!text.empty())
+                text += "/";
+            text += names[bit];
+        }
+    }
+    if (text.empty() && (stages & STALL))
+        text = "-";
+    return text;
+}
@@ -0,0 +1,61 @@
+#ifndef PIPELINELOG_HPP
+#define PIPELINELOG_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sparse record of which pipeline stage every instruction occupied in every
+// cycle. Instead of an instructions x cycles matrix of strings, the log keeps
+// one small (cycle, instruction id, stage bits) record per occupied cell.
+// Stages logged during the current cycle are merged in a window that is at
+// most as large as the pipeline is deep and committed by endCycle().
+// Committed cells grow with the cycles logged, so the Processor only logs
+// its first logCycleCount cycles (the table columns).
+class PipelineLog {
+public:
+    // Stage codes. Bits are ordered the way the stages log within a cycle
+    // (IF, then EX/MEM/WB in the first half, then ID in the second half) so a
+    // cell with several stages renders the same way the string log did.
+    enum Stage : uint8_t {
+        IF    = 1 << 0,
+        EX    = 1 << 1,
+        MEM   = 1 << 2,
+        WB    = 1 << 3,
+        ID    = 1 << 4,
+        STALL = 1 << 5   // "-": only shown if nothing else was logged.
+    };
+
+    struct Event {
+        uint32_t cycle;
+        int32_t instrId;
+        uint8_t stages;   // OR of Stage bits.
+    };
+
+    // One cell of a row, as returned by groupByInstruction().
+    struct Cell {
+        uint32_t cycle;
+        uint8_t stages;
+    };
+
+    // Adds a stage to the instruction's cell in the current cycle.
+    void record(int instrId, Stage stage);
+    // Commits the current cycle's cells to the log.
+    void endCycle(uint32_t cycle);
+    void clear();
+
+    const std::vector<Event> &events() const { return log; }
+
+    // Buckets the log by instruction id: the cells of row i are
+    // cells[offsets[i] .. offsets[i + 1]), in cycle order.
+    void groupByInstruction(size_t rows, std::vector<size_t> &offsets, std::vector<Cell> &cells) const;
+
+    // Text for a cell: "IF", "WB/ID", "-", or "" if empty.
+    static std::string cellText(uint8_t stages);
+
+private:
+    std::vector<Event> window;   // Cells of the cycle in progress.
+    std::vector<Event> log;      // Committed cells, in cycle order.
+};
+
+#endif // PIPELINELOG_HPP
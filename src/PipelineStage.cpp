@@ -1,2 +1,2 @@
-#include "PipelineStage.hpp"
-// Currently, no additional functions are implemented here.
+#include "PipelineStage.hpp"
+// Currently, no additional functions are implemented here.
@@ -1,17 +1,17 @@
 #ifndef PIPELINESTAGE_HPP
 #define PIPELINESTAGE_HPP
 
-#include "Instruction.hpp"
-#include "ControlUnit.hpp" // This now includes the definition for ALUOp
+#include "MicroOp.hpp" // Pre-decoded instruction carried by every latch (includes ALUOp)
 
 struct IF_ID_Latch {
-    Instruction instruction;
+    MicroOp instruction;
     uint32_t pc;
+    uint32_t predictedPC;   // Where fetch went next (pc + 4 without a branch predictor).
 };
 
 struct ID_EX_Latch {
     uint32_t pc;
-    Instruction instruction;
+    MicroOp instruction;
     bool regWrite;
     bool memRead;
     bool memWrite;
@@ -30,13 +30,15 @@ struct EX_MEM_Latch {
     bool memWrite;
     bool branch;
     uint32_t branchTarget;
-    Instruction instruction;
+    MicroOp instruction;
+    int readyCycle = 0;   // Multi-cycle operations: first cycle the result can be used (see FunctionalUnits).
 };
 
 struct MEM_WB_Latch {
     int writeData = 0;
     bool regWrite;
-    Instruction instruction;
+    MicroOp instruction;
+    int readyCycle = 0;   // Write-back waits until this cycle.
 };
 
 #endif // PIPELINESTAGE_HPP
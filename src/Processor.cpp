@@ -1,1092 +1,1282 @@
-// Processor.cpp
-#include "Processor.hpp"
-#include "ControlUnit.hpp"
-#include "ALU.hpp"
-#include <iostream>
-#include <iomanip>
-#include <string>
-
-// Constructor: initialize registers, PC, pipeline latches, and the stack memory.
-Processor::Processor(const std::vector<std::string>& instructionsHex, bool forwarding, int totalCycleCount,const std::vector<std::string>& asmInstr)
-    : PC(0), forwardingEnabled(forwarding),stallIF(false),stallNeeded(false), totalCycleCount(totalCycleCount),
-    currentCycle(0), headerPrinted(false),asmInstructions(asmInstr)  // Initialize our new vector  
-{
-
-
-    // Load instructions from hex strings.
-    for (const auto &hex : instructionsHex) {
-        Instruction inst(hex);
-        instructionMemory.push_back(inst);
-    }
-
-    // Assign a unique id to each instruction.
-    for (size_t i = 0; i < instructionMemory.size(); ++i) {
-        instructionMemory[i].id = i;
-    }
-
-    regs.resize(32, 0);  // Initialize 32 registers to 0.
-
-    // Initialize pipeline registers to NOP.
-    Instruction nop;
-    nop.type = InstType::NOP;
-    if_id.instruction = nop;
-    id_ex.instruction = nop;
-    ex_mem.instruction = nop;
-    mem_wb.instruction = nop;
-    
-    next_if_id = if_id;
-    next_id_ex = id_ex;
-    next_ex_mem = ex_mem;
-    next_mem_wb = mem_wb;
-    
-    // NEW: Initialize stack memory to 1024 bytes (all zeros)
-    stack_memory.resize(1024, 0);
-
-     // Initialize the pipeline log: one row per instruction, with one cell per cycle.
-     pipelineLog.resize(instructionMemory.size(), std::vector<std::string>(totalCycleCount, ""));
-}
-
-// Logging helper: record the given stage name for the instruction at the current cycle.
-void Processor::logInstructionStage(const Instruction &instr, const std::string &stage) {
-    if (instr.type == InstType::NOP || instr.id < 0 || currentCycle >= totalCycleCount)
-        return;
-    std::string &entry = pipelineLog[instr.id][currentCycle];
-
-    // If the incoming stage is "-", only update if nothing meaningful is logged.
-    if (stage == "-") {
-        if (!entry.empty() && entry != "-") {
-            // A valid stage (e.g., "ID") is already logged; ignore the dash.
-            return;
-        } else {
-            // If nothing or only a dash is present, set it as dash.
-            entry = "-";
-            return;
-        }
-    }
-
-    // For non-dash stages, if the current entry is empty or just a dash, replace it.
-    if (entry.empty() || entry == "-") {
-        entry = stage;
-    } else {
-        // Otherwise, if this stage isn't already recorded in the entry, append it.
-        if (entry.find(stage) == std::string::npos) {
-            entry += "/" + stage;
-        }
-    }
-}
-
-
-
-// Print the header row with cycle numbers.
-void Processor::printPipelineLogHeader() const {
-    std::cout << std::setw(6) << " " << ":";
-    for (int i = 0; i < totalCycleCount; ++i) {
-        std::cout << std::setw(10) << ("C" + std::to_string(i+1));
-    }
-    std::cout << std::endl;
-}
-
-// Print one instruction’s log row (e.g., "I1 :  IF   ID   EX   MEM   WB ...")
-void Processor::printInstructionLog(int instrId) const {
-    if (instrId < 0 || instrId >= static_cast<int>(pipelineLog.size()))
-        return;
-    
-    // Use the assembly statement if available, otherwise default to "I<number>"
-    std::string label;
-    if (instrId < static_cast<int>(asmInstructions.size()) && !asmInstructions[instrId].empty()) {
-        label = asmInstructions[instrId];
-    } else {
-        label = "I" + std::to_string(instrId + 1);
-    }
-    
-    std::cout << std::setw(20) << label << " :";
-    for (const auto &cell : pipelineLog[instrId]) {
-        std::cout << std::setw(10) << cell;
-    }
-    std::cout << std::endl;
-}
-
-
-
-
-// Helper to get the destination register for any instruction type.
-// Returns 0 if the instruction does not have a destination register.
-uint8_t Processor::getRD(const Instruction &inst) {
-    switch (inst.type) {
-        case InstType::R_TYPE:
-            return inst.info.r.rd;
-        case InstType::I_TYPE:
-            return inst.info.i.rd;
-        case InstType::U_TYPE:
-            return inst.info.u.rd;
-        case InstType::J_TYPE:
-            return inst.info.j.rd;
-        default:
-            // S_TYPE, B_TYPE, NOP, UNKNOWN have no rd
-            return 0;
-    }
-}
-
-
-
-
-
-// -------------------------
-// Fetch Stage (with cycle parameter)
-// -------------------------
-void Processor::fetch(int cycle) {
-    if (cycle == 0) {
-        if (PC / 4 < instructionMemory.size()) {
-            // Normal fetch
-            next_if_id.instruction = instructionMemory[PC / 4];
-            next_if_id.pc = PC;
-            // std::cout << "Fetching instruction: " << PC / 4 << std::endl;
-            logInstructionStage(next_if_id.instruction, "IF");
-        }
-        else {
-            // Past the end of instructions => keep fetching NOP
-            Instruction nop;
-            nop.type = InstType::NOP;
-            next_if_id.instruction = nop;
-            next_if_id.pc = PC;
-        }
-    }
-}
-
-void Processor::decode(int cycle) {
-    // Decode logic runs in the second half of the pipeline cycle
-    if (cycle == 1) {
-        
-        // if_id.instruction.printc_instruction();
-        // std::cout << std::endl;
-
-        // 1) Decode raw fields if not NOP
-        if (if_id.instruction.type != InstType::NOP) {
-            if_id.instruction.decode();
-            // if(if_id.instruction.type == InstType::R_TYPE)
-            // {
-            //     std::cout << "Decoded the R-type instruction: ";
-            //     if_id.instruction.print_inst_members();
-            // }
-        }
-        
-        // std::cout << "Decoding instruction: ";
-        // if_id.instruction.print_inst_members();
-        // std::cout << std::endl;
-
-        // If not a NOP and no stall, log "ID".
-        if (if_id.instruction.type != InstType::NOP && !stallNeeded) {
-            logInstructionStage(if_id.instruction, "ID");
-        }
-
-
-        // Identify which registers the current IF/ID instruction needs
-        bool usesRS1 = false, usesRS2 = false;
-        uint8_t neededRS1 = 0, neededRS2 = 0;
-
-        switch (if_id.instruction.type) {
-            case InstType::R_TYPE:
-                neededRS1 = if_id.instruction.info.r.rs1;
-                neededRS2 = if_id.instruction.info.r.rs2;
-                usesRS1 = true;
-                usesRS2 = true;
-                break;
-            case InstType::I_TYPE:
-                neededRS1 = if_id.instruction.info.i.rs1;
-                usesRS1 = true;
-                break;
-            case InstType::S_TYPE:
-                neededRS1 = if_id.instruction.info.s.rs1;
-                neededRS2 = if_id.instruction.info.s.rs2;
-                usesRS1 = true;
-                usesRS2 = true;
-                break;
-            case InstType::B_TYPE:
-                neededRS1 = if_id.instruction.info.b.rs1;
-                neededRS2 = if_id.instruction.info.b.rs2;
-                usesRS1 = true;
-                usesRS2 = true;
-                break;
-            default:
-                // U_TYPE, J_TYPE, NOP, UNKNOWN => no registers to read
-                break;
-        }
-
-        if (!forwardingEnabled) {
-            // Hazard detection when forwarding is disabled.
-            stallNeeded = false;
-        
-            // (a) Check ID/EX stage for potential hazards.
-            if (id_ex.regWrite) {
-                uint8_t rd_idex = getRD(id_ex.instruction);
-                if (rd_idex != 0) {
-                    if ((usesRS1 && rd_idex == neededRS1) ||
-                        (usesRS2 && rd_idex == neededRS2)) {
-                        stallNeeded = true;
-                    }
-                }
-            }
-        
-            // (b) Check EX/MEM stage for potential hazards.
-            if (ex_mem.regWrite) {
-                uint8_t rd_exmem = getRD(ex_mem.instruction);
-                if (rd_exmem != 0) {
-                    if ((usesRS1 && rd_exmem == neededRS1) ||
-                        (usesRS2 && rd_exmem == neededRS2)) {
-                        stallNeeded = true;
-                    }
-                }
-            }
-        
-            // If a hazard is detected, insert a NOP in the ID/EX latch and stall IF.
-            if (stallNeeded) {
-                logInstructionStage(if_id.instruction, "-");
-                Instruction nop;
-                nop.type = InstType::NOP;
-                next_id_ex.instruction = nop;
-                next_id_ex.regWrite    = false;
-                next_id_ex.memRead     = false;
-                next_id_ex.memWrite    = false;
-                next_id_ex.branch      = false;
-                next_id_ex.aluOp       = ALUOp::NONE;
-                next_id_ex.rs1Val      = 0;
-                next_id_ex.rs2Val      = 0;
-                next_id_ex.imm         = 0;
-        
-                stallIF = true;
-                return;
-            } else {
-                // No hazard: simply log a "-" (or you could log "ID" if preferred).
-                logInstructionStage(if_id.instruction, "-");
-            }
-        } else {
-            // Forwarding is enabled.
-            stallNeeded = false;
-            // For branch instructions, stall if there is ANY dependency with the previous instruction,
-            // because branch resolution happens in decode using register file values.
-            if (if_id.instruction.type == InstType::B_TYPE || if_id.instruction.opcode == 0x67) {
-                if (id_ex.regWrite) {
-                    uint8_t rd_idex = getRD(id_ex.instruction);
-                    if (rd_idex != 0) {
-                        if ((usesRS1 && rd_idex == neededRS1) ||
-                            (usesRS2 && rd_idex == neededRS2)) {
-                            stallNeeded = true;
-                        }
-                    }
-                    
-                }
-                if(ex_mem.memRead)
-                {
-                    uint8_t rd_idex = getRD(ex_mem.instruction);
-                    if (rd_idex != 0) {
-                        if ((usesRS1 && rd_idex == neededRS1) ||
-                            (usesRS2 && rd_idex == neededRS2)) {
-                            stallNeeded = true;
-                        }
-                    }
-                }
-                if(id_ex.memRead) {
-                    uint8_t rd_idex = getRD(id_ex.instruction);  // <-- Corrected
-                    if (rd_idex != 0) {
-                        if ((usesRS1 && rd_idex == neededRS1) ||
-                            (usesRS2 && rd_idex == neededRS2)) {
-                            stallNeeded = true;
-                        }
-                    }
-                }
-                
-            }
-            // For non-branch instructions, only stall on a load–use hazard.
-            else if (id_ex.memRead) {
-                uint8_t rd_idex = getRD(id_ex.instruction);
-                if (rd_idex != 0) {
-                    if ((usesRS1 && rd_idex == neededRS1) ||
-                        (usesRS2 && rd_idex == neededRS2)) {
-                        stallNeeded = true;
-                    }
-                }
-            }
-            if (stallNeeded) {
-                logInstructionStage(if_id.instruction, "-");
-                Instruction nop;
-                nop.type = InstType::NOP;
-                next_id_ex.instruction = nop;
-                next_id_ex.regWrite    = false;
-                next_id_ex.memRead     = false;
-                next_id_ex.memWrite    = false;
-                next_id_ex.branch      = false;
-                next_id_ex.aluOp       = ALUOp::NONE;
-                next_id_ex.rs1Val      = 0;
-                next_id_ex.rs2Val      = 0;
-                next_id_ex.imm         = 0;
-                stallIF = true;
-                return;
-            } else {
-                logInstructionStage(if_id.instruction, "-");
-            }
-        }
-        
-        
-        // 4) No stall => normal decode logic from the ControlUnit
-        ControlSignals signals = ControlUnit::decode(if_id.instruction);
-
-        // Copy instruction + PC into ID/EX
-        next_id_ex.pc          = if_id.pc;
-        next_id_ex.instruction = if_id.instruction;
-        next_id_ex.regWrite    = signals.regWrite;
-        next_id_ex.memRead     = signals.memRead;
-        next_id_ex.memWrite    = signals.memWrite;
-        next_id_ex.branch      = signals.branch;
-        next_id_ex.aluOp       = signals.aluOp;
-
-        // -------------------------------------------------------
-        // Register read logic + special handling for branch/jump
-        // -------------------------------------------------------
-        switch (if_id.instruction.type) {
-            // -----------------
-            // R-TYPE
-            // -----------------
-            case InstType::R_TYPE:
-                next_id_ex.rs1Val = regs[if_id.instruction.info.r.rs1];
-                next_id_ex.rs2Val = regs[if_id.instruction.info.r.rs2];
-                next_id_ex.imm    = 0;
-                break;
-
-            // -----------------
-            // I-TYPE
-            // -----------------
-            // I-Type
-                    // -----------------
-        // I-TYPE
-        // -----------------
-        // I-Type
-        case InstType::I_TYPE:
-        // For most I-type instructions:
-        next_id_ex.rs1Val = regs[if_id.instruction.info.i.rs1];
-        next_id_ex.rs2Val = 0;
-        next_id_ex.imm = if_id.instruction.info.i.imm;
-        // Special handling for JALR (opcode 0x67)
-        if (if_id.instruction.opcode == 0x67) {
-            // Set up the latch to defer the link address write.
-            next_id_ex.pc = if_id.pc;
-            next_id_ex.instruction = if_id.instruction;
-            next_id_ex.regWrite = true; // JALR writes to rd.
-            // Instead of updating the register immediately, store the link address.
-            next_id_ex.imm = if_id.pc + 4;
-            
-            // Use the register file value for rs1, but if forwarding is enabled, check for forwarded values.
-            uint32_t rs1Val = regs[if_id.instruction.info.i.rs1];
-            if (forwardingEnabled) {
-                uint8_t src1 = if_id.instruction.info.i.rs1;
-                if (ex_mem.regWrite && (getRD(ex_mem.instruction) == src1) && src1 != 0)
-                    rs1Val = ex_mem.aluResult;
-                else if (mem_wb.regWrite && (getRD(mem_wb.instruction) == src1) && src1 != 0)
-                    rs1Val = mem_wb.writeData;
-            }
-            next_id_ex.rs1Val = rs1Val;
-            next_id_ex.rs2Val = 0;
-            
-            // Compute jump target using the (possibly forwarded) rs1 value and the immediate from the instruction.
-            int jumpTarget = rs1Val + if_id.instruction.info.i.imm;
-            jumpTarget &= ~1; // Ensure proper alignment.
-            PC = jumpTarget - 4;  // Adjust PC (the updateLatches later adds 4).
-            
-            // Flush IF/ID to avoid re-decoding.
-            Instruction nop;
-            nop.type = InstType::NOP;
-            next_if_id.instruction = nop;
-            next_if_id.pc = PC;
-            
-            stallIF = false;
-            return;
-        }
-        break;
-
-
-
-            // -----------------
-            // S-TYPE
-            // -----------------
-            case InstType::S_TYPE:
-                next_id_ex.rs1Val = regs[if_id.instruction.info.s.rs1];
-                next_id_ex.rs2Val = regs[if_id.instruction.info.s.rs2];
-                next_id_ex.imm    = if_id.instruction.info.s.imm;
-                break;
-
-            // -----------------
-            // B-TYPE (Branches)
-            // -----------------
-            case InstType::B_TYPE: {
-                // Read the register file values initially.
-                uint32_t rs1Val = regs[if_id.instruction.info.b.rs1];
-                uint32_t rs2Val = regs[if_id.instruction.info.b.rs2];
-                
-                // If forwarding is enabled, override with forwarded values.
-                if (forwardingEnabled) {
-                    uint8_t src1 = if_id.instruction.info.b.rs1;
-                    uint8_t src2 = if_id.instruction.info.b.rs2;
-                    // Check the EX/MEM latch first.
-                    if (ex_mem.regWrite && (getRD(ex_mem.instruction) == src1) && src1 != 0)
-                        rs1Val = ex_mem.aluResult;
-                    else if (mem_wb.regWrite && (getRD(mem_wb.instruction) == src1) && src1 != 0)
-                        rs1Val = mem_wb.writeData;
-                    
-                    if (ex_mem.regWrite && (getRD(ex_mem.instruction) == src2) && src2 != 0)
-                        rs2Val = ex_mem.aluResult;
-                    else if (mem_wb.regWrite && (getRD(mem_wb.instruction) == src2) && src2 != 0)
-                        rs2Val = mem_wb.writeData;
-                }
-                
-                // Save these values for use in later stages if needed.
-                next_id_ex.rs1Val = rs1Val;
-                next_id_ex.rs2Val = rs2Val;
-                next_id_ex.imm    = if_id.instruction.info.b.imm;
-                
-                // Evaluate the branch condition using the (possibly forwarded) values.
-                uint8_t f3 = if_id.instruction.info.b.funct3;
-                // std:: cout << "Evaluating BRANCH with rs1 = " << rs1Val << ", rs2 = " << rs2Val << std::endl;
-                bool branchTaken = false;
-                switch (f3) {
-                    case 0: // BEQ
-                        branchTaken = (rs1Val == rs2Val);
-                        break;
-                    case 1: // BNE
-                        branchTaken = (rs1Val != rs2Val);
-                        break;
-                    case 4: // BLT
-                        branchTaken = ((int32_t)rs1Val < (int32_t)rs2Val);
-                        break;
-                    case 5: // BGE
-                        branchTaken = ((int32_t)rs1Val >= (int32_t)rs2Val);
-                        break;
-                    case 6: // BLTU
-                        branchTaken = (rs1Val < rs2Val);
-                        break;
-                    case 7: // BGEU
-                        branchTaken = (rs1Val >= rs2Val);
-                        break;
-                    default:
-                        break;
-                }
-                
-                // Update PC based on the branch decision.
-                if (branchTaken) {
-                    PC = if_id.pc + if_id.instruction.info.b.imm;
-                } else {
-                    PC = if_id.pc + 4;
-                }
-
-                // Flush the pipeline: send NOP to ID/EX
-                Instruction nop;
-                // nop.type = InstType::NOP;
-                // next_id_ex.instruction = nop;
-                // next_id_ex.regWrite    = false;
-                // next_id_ex.memRead     = false;
-                // next_id_ex.memWrite    = false;
-                // next_id_ex.branch      = false;
-                // next_id_ex.aluOp       = ALUOp::NONE;
-                // next_id_ex.rs1Val      = 0;
-                // next_id_ex.rs2Val      = 0;
-                // next_id_ex.imm         = 0;
-                next_id_ex.instruction = if_id.instruction;
-                next_id_ex.regWrite    = false;
-                next_id_ex.memRead     = false;
-                next_id_ex.memWrite    = false;
-                next_id_ex.branch      = false;
-                next_id_ex.aluOp       = ALUOp::NONE;
-                next_id_ex.rs1Val      = 0;
-                next_id_ex.rs2Val      = 0;
-                next_id_ex.imm         = 0;
-
-
-                // ALSO flush IF/ID so we won't re-decode the same branch
-                next_if_id.instruction = nop;
-                // next_if_id.instruction = if_id.instruction;
-                next_if_id.pc          = PC;
-
-                // DO NOT stall next cycle — we want to fetch the new instruction
-                stallIF = false;
-
-                return; // Done handling the branch
-            }
-
-            // -----------------
-            // U-TYPE
-            // -----------------
-            case InstType::U_TYPE:
-                next_id_ex.rs1Val = 0;
-                next_id_ex.rs2Val = 0;
-                next_id_ex.imm    = if_id.instruction.info.u.imm;
-                break;
-
-            // -----------------
-            // J-TYPE (e.g. JAL)
-            // -----------------
-            case InstType::J_TYPE: {
-                int32_t offset = if_id.instruction.info.j.imm;
-                // uint8_t rd = if_id.instruction.info.j.rd;
-                
-                // Set up the ID/EX latch:
-                next_id_ex.pc = if_id.pc;
-                next_id_ex.instruction = if_id.instruction;
-                next_id_ex.regWrite = true;  // JAL writes to rd.
-                // Store the link address (PC + 4) in the imm field.
-                next_id_ex.imm = if_id.pc + 4;
-                // You can clear rs1Val/rs2Val as they're unused.
-                next_id_ex.rs1Val = 0;
-                next_id_ex.rs2Val = 0;
-                
-                // Update PC for the jump. The -4 is needed because the updateLatches stage will add 4.
-                PC = if_id.pc + offset - 4;
-                
-                // Flush the IF/ID latch.
-                Instruction nop;
-                nop.type = InstType::NOP;
-                next_if_id.instruction = nop;
-                next_if_id.pc = PC;
-                
-                stallIF = false;
-                return;
-            }
-            
-
-            // -----------------
-            // NOP / UNKNOWN
-            // -----------------
-            default:
-                next_id_ex.rs1Val = 0;
-                next_id_ex.rs2Val = 0;
-                next_id_ex.imm    = 0;
-                break;
-        }
-    }
-}
-
-
-
-// -------------------------
-// Execute Stage (with cycle parameter)
-// -------------------------
-void Processor::execute(int cycle) {
-    if (cycle == 0) {
-        // std::cout << "[DEBUG] EX stage: Instruction = ";
-        // id_ex.instruction.printc_instruction();
-        // std::cout << "\n  ALUOp = " << (int)id_ex.aluOp
-        //           << ", rs1Val = " << id_ex.rs1Val
-        //           << ", rs2Val = " << id_ex.rs2Val
-        //           << ", imm = " << id_ex.imm << std::endl;
-        uint32_t operand1 = id_ex.rs1Val;
-        if(id_ex.instruction.type == InstType::U_TYPE)
-        {
-            operand1 = id_ex.pc;
-        }
-        uint32_t operand2 = 0;
-
-        // Set operand2 based on instruction type.
-        switch (id_ex.instruction.type) {
-            case InstType::R_TYPE:
-                operand2 = id_ex.rs2Val;
-                break;
-            case InstType::I_TYPE:
-                operand2 = id_ex.imm;
-                break;
-            case InstType::S_TYPE:
-                operand2 = id_ex.imm;
-                break;
-            case InstType::B_TYPE:
-                operand2 = id_ex.rs2Val;
-                break;
-            case InstType::U_TYPE:
-                // For U-type, operand2 may not be used by the ALU.
-                operand2 = id_ex.imm;
-                break;
-            case InstType::J_TYPE: // ye PC update mei krna h
-                // For J-type (e.g., JAL), we compute the jump target.
-                // The jump target is computed as current PC + immediate.
-                // Although we set operand2 here, the main purpose is to compute branchTarget.
-                operand2 = id_ex.imm;
-                break;
-            default:
-                operand2 = id_ex.imm;
-                break;
-        }
-
-         // If forwarding is enabled, override operands if a later stage holds the updated value.
-        if (forwardingEnabled) {
-            uint8_t rs1 = 0, rs2 = 0;
-            bool useRS2 = false;
-            switch (id_ex.instruction.type) {
-                case InstType::R_TYPE:
-                    rs1 = id_ex.instruction.info.r.rs1;
-                    rs2 = id_ex.instruction.info.r.rs2;
-                    useRS2 = true;
-                    break;
-                case InstType::I_TYPE:
-                    rs1 = id_ex.instruction.info.i.rs1;
-                    break;
-                case InstType::S_TYPE:
-                    rs1 = id_ex.instruction.info.s.rs1;
-                    rs2 = id_ex.instruction.info.s.rs2;
-                    useRS2 = true;
-                    break;
-                case InstType::B_TYPE:
-                    rs1 = id_ex.instruction.info.b.rs1;
-                    rs2 = id_ex.instruction.info.b.rs2;
-                    useRS2 = true;
-                    break;
-                default:
-                    break;
-            }
-
-            // Forward for operand1 (rs1)
-            if (rs1 != 0) {
-                if (ex_mem.regWrite && (getRD(ex_mem.instruction) == rs1)) {
-                    // std::cout << "Forwarded rs1 in EX stage" << std::endl;
-                    operand1 = ex_mem.aluResult;
-                } else if (mem_wb.regWrite && (getRD(mem_wb.instruction) == rs1)) {
-                    // std::cout << "Forwarded rs1 in EX stage" << std::endl;
-                    operand1 = mem_wb.writeData;
-                }
-            }
-
-            // Forward for operand2 (rs2), if applicable.
-            if (useRS2 && rs2 != 0 && id_ex.instruction.type != InstType::S_TYPE) {
-                if (ex_mem.regWrite && (getRD(ex_mem.instruction) == rs2)) {
-                    // std::cout << "Forwarded rs2 in EX stage" << std::endl;
-                    operand2 = ex_mem.aluResult;
-                } else if (mem_wb.regWrite && (getRD(mem_wb.instruction) == rs2)) {
-                    // std::cout << "Forwarded rs2 in EX stage" << std::endl;
-                    operand2 = mem_wb.writeData;
-                }
-            }
-            // std :: cout << "Operand1: " << operand1 << " Operand2: " << operand2 << std::endl;
-        }
-
-
-
-
-
-        int aluResult = 0;
-        // Perform the ALU operation as needed.
-        // Special case: For JAL, simply pass along the link address (PC+4) stored in id_ex.imm.
-        // Special case: For JALR (opcode 0x67), forward the link address (PC+4) stored in id_ex.imm.
-        if (id_ex.instruction.opcode == 0x67) {
-            aluResult = id_ex.imm;
-        } else if (id_ex.instruction.type == InstType::J_TYPE) {
-            aluResult = id_ex.imm;
-        }   
-        else
-        {
-            switch (id_ex.aluOp) {
-            case ALUOp::ADD:
-                aluResult = ALU::add(operand1, operand2);
-                break;
-            case ALUOp::SUB:
-                aluResult = ALU::sub(operand1, operand2);
-                break;
-            case ALUOp::MUL:
-                aluResult = ALU::mul(operand1, operand2);
-                break;
-            case ALUOp::DIV:
-                aluResult = ALU::div(operand1, operand2);
-                break;
-            case ALUOp::SLL:
-            case ALUOp::SLLI:
-                aluResult = ALU::sll(operand1, operand2);
-                break;
-            case ALUOp::SRL:
-            case ALUOp::SRLI:
-                aluResult = ALU::srl(operand1, operand2);
-                break;
-            case ALUOp::SRA:
-            case ALUOp::SRAI:
-                aluResult = ALU::sra(operand1, operand2);
-                break;
-            default:
-                aluResult = 0;
-                break;
-        }
-        }
-        // For branch or jump instructions (B-type and J-type),
-        // compute the branch/jump target address.
-        next_ex_mem.branchTarget = id_ex.pc + id_ex.imm;
-        
-        // Prepare next EX/MEM latch.
-        next_ex_mem.aluResult = aluResult;
-        next_ex_mem.rs2Val = id_ex.rs2Val;
-        next_ex_mem.regWrite = id_ex.regWrite;
-        next_ex_mem.memRead = id_ex.memRead;
-        next_ex_mem.memWrite = id_ex.memWrite;
-        next_ex_mem.branch = id_ex.branch;
-        next_ex_mem.instruction = id_ex.instruction;
-        logInstructionStage(id_ex.instruction, "EX");
-
-    }
-    // Second half: no additional work in execute stage.
-}
-
-
-
-// -------------------------
-// Memory Access Stage (with cycle parameter)
-// -------------------------
-void Processor::memAccess(int cycle) {
-    // Perform the memory operation in the whole cycle.
-    uint32_t addr = ex_mem.aluResult;
-
-    // If this is a store operation:
-    if (ex_mem.memWrite) {
-        uint32_t value = ex_mem.rs2Val;
-        // When forwarding is enabled, forward the value from MEM/WB if available.
-        if (forwardingEnabled) {
-            uint8_t store_rs2 = ex_mem.instruction.info.s.rs2;
-            if (store_rs2 != 0 && mem_wb.regWrite && (getRD(mem_wb.instruction) == store_rs2)) {
-                value = mem_wb.writeData;
-            }
-        }
-        // std::cout << "Storing value " << value << " to address " << addr << std::endl;
-        uint8_t funct3 = ex_mem.instruction.info.s.funct3;
-        switch (funct3) {
-            case 0: // SB: Store Byte
-                if (addr < stack_memory.size())
-                    stack_memory[addr] = value & 0xFF;
-                break;
-            case 1: // SH: Store Halfword
-                if (addr + 1 < stack_memory.size()) {
-                    stack_memory[addr] = value & 0xFF;
-                    stack_memory[addr + 1] = (value >> 8) & 0xFF;
-                }
-                break;
-            case 2: // SW: Store Word
-                if (addr + 3 < stack_memory.size()) {
-                    stack_memory[addr]     = value & 0xFF;
-                    stack_memory[addr + 1] = (value >> 8) & 0xFF;
-                    stack_memory[addr + 2] = (value >> 16) & 0xFF;
-                    stack_memory[addr + 3] = (value >> 24) & 0xFF;
-                }
-                break;
-            case 3: // SD: Store Doubleword
-                if (addr + 7 < stack_memory.size()) {
-                    for (int i = 0; i < 8; i++) {
-                        stack_memory[addr + i] = (value >> (8 * i)) & 0xFF;
-                    }
-                }
-                break;
-            default:
-                // Unsupported store type.
-                break;
-        }
-        next_mem_wb.writeData   = 0;
-        next_mem_wb.regWrite    = false;
-        next_mem_wb.instruction = ex_mem.instruction;
-    }
-    // Else if this is a load operation:
-    else if (ex_mem.memRead) {
-        uint32_t data = 0;
-        uint8_t funct3 = ex_mem.instruction.info.i.funct3;
-        switch (funct3) {
-            case 0: { // LB: Load Byte (sign-extended)
-                // std::cout << "Loading Byte from : " << addr << std::endl ;
-                if (addr < stack_memory.size()) {
-                    int8_t byte = static_cast<int8_t>(stack_memory[addr]);
-                    data = static_cast<int32_t>(byte);
-                }
-                break;
-            }
-            case 4: { // LBU: Load Byte Unsigned
-                // std::cout << "Loading Byte Unsigned from : " << addr << std::endl ;
-                if (addr < stack_memory.size()) {
-                    data = stack_memory[addr];
-                }
-                break;
-            }
-            case 1: { // LH: Load Halfword (sign-extended)
-                // std::cout << "Loading HW from : " << addr << std::endl ;
-                if (addr + 1 < stack_memory.size()) {
-                    int16_t half = static_cast<int16_t>(
-                        stack_memory[addr] | (stack_memory[addr + 1] << 8)
-                    );
-                    data = static_cast<int32_t>(half);
-                }
-                break;
-            }
-            case 5: { // LHU: Load Halfword Unsigned
-                // std::cout << "Loading HWU from : " << addr << std::endl ;
-                if (addr + 1 < stack_memory.size()) {
-                    data = stack_memory[addr] | (stack_memory[addr + 1] << 8);
-                }
-                break;
-            }
-            case 2: { // LW: Load Word
-                // std::cout << "Loading Word from : " << addr << std::endl ;
-                if (addr + 3 < stack_memory.size()) {
-                    data = stack_memory[addr] |
-                           (stack_memory[addr + 1] << 8) |
-                           (stack_memory[addr + 2] << 16) |
-                           (stack_memory[addr + 3] << 24);
-                }
-                break;
-            }
-            case 6: { // LWU: Load Word Unsigned
-                // std::cout << "Loading Word Unsigned from : " << addr << std::endl ;
-                if (addr + 3 < stack_memory.size()) {
-                    data = stack_memory[addr] |
-                           (stack_memory[addr + 1] << 8) |
-                           (stack_memory[addr + 2] << 16) |
-                           (stack_memory[addr + 3] << 24);
-                }
-                break;
-            }
-            default:
-                // Unsupported load type.
-                break;
-        }
-        // Put the load result in MEM/WB
-        next_mem_wb.writeData   = data;
-        next_mem_wb.regWrite    = ex_mem.regWrite;
-        next_mem_wb.instruction = ex_mem.instruction;
-    }
-    // If no memory operation is required (e.g. simple ALU):
-    else {
-        next_mem_wb.writeData   = ex_mem.aluResult;
-        next_mem_wb.regWrite    = ex_mem.regWrite;
-        next_mem_wb.instruction = ex_mem.instruction;
-    }
-    logInstructionStage(ex_mem.instruction, "MEM");
-
-    // >>> Approach A: Flush EX/MEM afterwards for ALU or load/store instructions.
-    // That way, the instruction won't stay in EX/MEM indefinitely.
-    // Instruction flushNOP;
-    // flushNOP.type = InstType::NOP;
-    // next_ex_mem.instruction = flushNOP;
-    // next_ex_mem.regWrite    = false;
-    // next_ex_mem.memRead     = false;
-    // next_ex_mem.memWrite    = false;
-    // next_ex_mem.branch      = false;
-    // next_ex_mem.aluResult   = 0;
-    // next_ex_mem.rs2Val      = 0;
-    // next_ex_mem.branchTarget= 0;
-}
-
-
-
-
-// -------------------------
-// Write-Back Stage (with cycle parameter)
-// -------------------------
-void Processor::writeBack(int cycle) {
-    if (cycle == 0) {  // First half: perform write-back.
-        if (mem_wb.regWrite) {
-            uint8_t rd = 0;
-            switch (mem_wb.instruction.type) {
-                case InstType::I_TYPE:
-                    rd = mem_wb.instruction.info.i.rd;
-                    break;
-                case InstType::R_TYPE:
-                    rd = mem_wb.instruction.info.r.rd;
-                    break;
-                case InstType::U_TYPE:
-                    rd = mem_wb.instruction.info.u.rd;
-                    break;
-                case InstType::J_TYPE:
-                    rd = mem_wb.instruction.info.j.rd;
-                    break;
-                default:
-                    break;
-            }
-             // Only write back if the destination register is not x0.
-            if (rd != 0) {
-                regs[rd] = mem_wb.writeData;
-            }
-            // std::cout << "WriteBack: Register x" << unsigned(rd)
-            //           << " updated to " << regs[rd] << std::endl;
-        }
-        logInstructionStage(mem_wb.instruction, "WB");
-    } 
-
-    
-    // Second half: no write operations.
-
-    // >>> Approach A: flush out MEM/WB afterwards
-    // so the same instruction won't remain in MEM/WB multiple cycles.
-    // Instruction nop;
-    // nop.type = InstType::NOP;
-    // next_mem_wb.instruction = nop;
-    // next_mem_wb.regWrite    = false;
-    // next_mem_wb.writeData   = 0;
-}
-
-
-// -------------------------
-// Update Pipeline Latches and PC
-// -------------------------
-void Processor::updateLatches() {
-    // The older pipeline latches update unconditionally:
-    id_ex = next_id_ex;
-    ex_mem = next_ex_mem;
-    mem_wb = next_mem_wb;
-
-    // Now handle the front end:
-    if (!stallIF) {
-        // Normal fetch => move next_if_id into if_id, increment PC if not branch
-        if_id = next_if_id;
-        if (id_ex.instruction.type != InstType::B_TYPE) {
-            PC += 4; 
-        }
-    }
-     else {
-        // Freeze: do NOT update if_id or PC
-        stallIF = false; // Clear for next cycle unless decode sets it again
-        // std::cout << "Stalling front end, reusing same IF/ID instruction.\n";
-    }
-}
-
-
-// -------------------------
-// Run One Full Cycle
-// -------------------------
-void Processor::runCycle() {
-    // First half (cycle = 0) for all stages.
-    fetch(0);
-    decode(0);
-    execute(0);
-    memAccess(0);
-    writeBack(0); // Write-back is done in the first half.
-
-    // Second half (cycle = 1) for all stages.
-    fetch(1);
-    decode(1);
-    execute(1);
-    // memAccess(1); // Memory access is processed through the whole cycle.
-    // writeBack(1); // Write-back is done in the first half.
-    
-    // Commit the computed next state and update the PC.
-    updateLatches();
-    
-    // Print the concise pipeline state.
-    // printPipelineState();
-    currentCycle++;
-    
-    // Also print detailed pipeline debug info.
-    // debug_print();
-}
-
-void Processor::debug_print() {
-    std::cout << "----- Debug Print: Pipeline Latches -----" << std::endl;
-    
-    std::cout << "IF/ID Stage: Instruction: ";
-    if_id.instruction.printc_instruction();
-    std::cout << std::endl << ", PC: " << if_id.pc << std::endl;
-    
-    
-    std::cout << "ID/EX Stage: Instruction: ";
-    id_ex.instruction.printc_instruction();
-    std::cout << ", PC: " << id_ex.pc;
-    std::cout << ", rs1Val: " << id_ex.rs1Val 
-              << ", rs2Val: " << id_ex.rs2Val 
-              << ", Imm: " << id_ex.imm << std::endl;
-    
-    std::cout << "EX/MEM Stage: Instruction: ";
-    ex_mem.instruction.printc_instruction();
-    std::cout << ", ALU Result: " << ex_mem.aluResult
-              << ", rs2Val: " << ex_mem.rs2Val << std::endl;
-    
-    std::cout << "MEM/WB Stage: Instruction: ";
-    mem_wb.instruction.printc_instruction();
-    std::cout << ", Write Data: " << mem_wb.writeData << std::endl;
-    
-    std::cout << "-------------------------------------------" << std::endl;
-}
-
-
-// -------------------------
-// Debug: Print Pipeline State
-// -------------------------
-void Processor::printPipelineState() {
-    std::cout << "----- Pipeline State -----" << std::endl;
-    std::cout << "IF/ID: "<< std::endl;
-    if_id.instruction.printc_instruction();
-    std::cout << std::endl;
-    
-    std::cout << "ID/EX: "<< std::endl;
-    id_ex.instruction.printc_instruction();
-    std::cout << std::endl;
-    
-    std::cout << "EX/MEM: "<< std::endl;
-    ex_mem.instruction.printc_instruction();
-    std::cout << std::endl;
-    std::cout << " | ALU Result: " << ex_mem.aluResult << std::endl;
-    
-    std::cout << "MEM/WB: "<< std::endl;
-    mem_wb.instruction.printc_instruction();
-    std::cout << std::endl;
-    std::cout << " | Write Data: " << mem_wb.writeData << std::endl;
-}
-
-void Processor::print_registers()
-{
-    std::cout << "Registers: " << std::endl;
-    for (int i = 0; i < 32; i++)
-    {
-        std::cout << "x" << i << ": " << regs[i] << std::endl;
-    }
-
-}
-void Processor::printFullPipelineLog() const {
-    const int labelWidth = 20; // Adjust this width as needed for your assembly statements.
-    const int cellWidth = 10;  // Fixed width for each cycle cell.
-    
-    // Print header row with cycle numbers.
-    std::cout << std::setw(labelWidth) << std::left << " " << " :";
-    for (int i = 0; i < totalCycleCount; ++i) {
-        std::cout << std::setw(cellWidth) << std::right << ("C" + std::to_string(i + 1));
-    }
-    std::cout << std::endl;
-    
-    // Loop through the entire pipeline log and print each instruction's log row.
-    for (size_t i = 0; i < pipelineLog.size(); ++i) {
-        // Use the assembly statement if available; otherwise, default to "I<number>".
-        std::string label;
-        if (i < asmInstructions.size() && !asmInstructions[i].empty())
-            label = asmInstructions[i];
-        else
-            label = "I" + std::to_string(i + 1);
-        
-        // Print the label left-aligned within the fixed width.
-        std::cout << std::setw(labelWidth) << std::left << label << " :";
-        // Print each cell right-aligned.
-        for (const auto &cell : pipelineLog[i]) {
-            std::cout << std::setw(cellWidth) << std::right << cell;
-        }
-        std::cout << std::endl;
-    }
-}
-
-void Processor::printFullPipelineLogSimple() const {
-    for (size_t i = 0; i < pipelineLog.size(); ++i) {
-        // Use the assembly instruction if available; if not, use a single space.
-        std::string label;
-        if (i < asmInstructions.size() && !asmInstructions[i].empty())
-            label = asmInstructions[i];
-        else
-            label = " ";
-        
-        // Print the label and a colon.
-        std::cout << label << ":";
-        
-        // Print each stage from the pipeline log separated by semicolons.
-        for (size_t j = 0; j < pipelineLog[i].size(); ++j) {
-            if (j > 0)
-                std::cout << ";";
-            // Print the stage; if the cell is empty, print a single space.
-            if (pipelineLog[i][j].empty())
-                std::cout << " ";
-            else
-                std::cout << pipelineLog[i][j];
-        }
-        std::cout << std::endl;
-    }
-}
-
-
-
+// Processor.cpp
+#include "Processor.hpp"
+#include "ControlUnit.hpp"
+#include "ALU.hpp"
+#include "DataMemory.hpp"
+#include "HazardPolicy.hpp"
+#include "CoherentMemory.hpp"
+#include "Compressed.hpp"
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+// Constructor: decodes the program, then delegates to the pre-decoded constructor.
+Processor::Processor(const std::vector<std::string>& instructionsHex, bool forwarding, int totalCycleCount,const std::vector<std::string>& asmInstr)
+    : Processor(decodeProgram(instructionsHex), instructionsHex, forwarding, totalCycleCount, asmInstr) {}
+
+// Decode every instruction exactly once; the pipeline only sees MicroOps.
+std::vector<MicroOp> Processor::decodeProgram(const std::vector<std::string>& instructionsHex) {
+    std::vector<MicroOp> program;
+    program.reserve(instructionsHex.size());
+    for (size_t i = 0; i < instructionsHex.size(); ++i) {
+        const std::string &hex = instructionsHex[i];
+        if (Compressed::isHalfwordToken(hex.data(), hex.data() + hex.size())) {
+            program.push_back(MicroOp::fromCompressed(std::stoul(hex, nullptr, 16), i));
+            continue;
+        }
+        Instruction inst(hex);
+        program.push_back(MicroOp::fromInstruction(inst, i));
+    }
+    return program;
+}
+
+// Constructor: keeps one copy of the text, shared by copies of this Processor, and views it.
+Processor::Processor(const std::vector<MicroOp>& program, const std::vector<std::string>& instructionsHex, bool forwarding, int totalCycleCount,const std::vector<std::string>& asmInstr)
+    : Processor(program, std::vector<TextView>(), forwarding, totalCycleCount, std::vector<TextView>()) {
+    std::shared_ptr<std::vector<std::string>> text = std::make_shared<std::vector<std::string>>(instructionsHex);
+    text->insert(text->end(), asmInstr.begin(), asmInstr.end());
+    std::vector<TextView> views = TextView::of(*text);
+    instructionHex.assign(views.begin(), views.begin() + instructionsHex.size());
+    asmInstructions.assign(views.begin() + instructionsHex.size(), views.end());
+    ownedText = text;
+}
+
+// Constructor: initialize registers, PC, pipeline latches, and the stack memory.
+Processor::Processor(const std::vector<MicroOp>& program, const std::vector<TextView>& instructionsHex, bool forwarding, int totalCycleCount, const std::vector<TextView>& asmInstr)
+    : PC(0), forwardingEnabled(forwarding), issueWidth(1), stallIF(false),stallNeeded(false), totalCycleCount(totalCycleCount),
+    logCycleCount(totalCycleCount), currentCycle(0), logStartCycle(0), instructionsRetired(0), stallCycles(0), flushedFetches(0), cacheStallCycles(0), unitStallCycles(0), headerPrinted(false), asmInstructions(asmInstr),
+    instructionMemory(program), instructionHex(instructionsHex), code(instructionMemory), fetchBlock(0), shared(nullptr), hartId(0), trace(nullptr), secondHeld(false)  // Hex text is kept for the debug printers.
+{
+
+    regs.resize(32, 0);  // Initialize 32 registers to 0.
+
+    // The mode is fixed for the lifetime of the processor; pick the specialized pipeline once.
+    if (forwardingEnabled)
+        cycleImpl = &Processor::runCycleWith<ForwardingPolicy>;
+    else
+        cycleImpl = &Processor::runCycleWith<NoForwardingPolicy>;
+
+    // Initialize pipeline registers to NOP.
+    flushPipeline();
+
+    // Data memory starts empty; pages are allocated as they are first written.
+}
+
+bool Processor::setIssueWidth(unsigned width) {
+    if (width < 1 || width > maxIssueWidth) {
+        std::cerr << "Issue width must be 1 or " << maxIssueWidth << std::endl;
+        return false;
+    }
+    issueWidth = width;
+    if (width == 1)
+        cycleImpl = forwardingEnabled ? &Processor::runCycleWith<ForwardingPolicy>
+                                      : &Processor::runCycleWith<NoForwardingPolicy>;
+    else
+        cycleImpl = forwardingEnabled ? &Processor::runCycleDual<ForwardingPolicy>
+                                      : &Processor::runCycleDual<NoForwardingPolicy>;
+    flushPipeline();
+    return true;
+}
+
+void Processor::setUnitTiming(const UnitConfig &config) {
+    units = FunctionalUnits(config);
+    scoreboard.opLatency = units.enabled() ? units.latencies() : nullptr;
+    flushPipeline();
+}
+
+bool Processor::setFetchBlock(uint32_t bytes) {
+    if (bytes != 0 && (bytes < 4 || bytes > 64 || (bytes & (bytes - 1)) != 0)) {
+        std::cerr << "Fetch block must be 0 or a power of two from 4 to 64 bytes" << std::endl;
+        return false;
+    }
+    fetchBlock = bytes;
+    flushPipeline();
+    return true;
+}
+
+// Empties all pipeline latches (current and next) and clears any pending stall.
+void Processor::flushPipeline() {
+    MicroOp nop = MicroOp::nop();
+    if_id = IF_ID_Latch();
+    id_ex = ID_EX_Latch();
+    ex_mem = EX_MEM_Latch();
+    mem_wb = MEM_WB_Latch();
+    if_id.instruction = nop;
+    id_ex.instruction = nop;
+    ex_mem.instruction = nop;
+    mem_wb.instruction = nop;
+
+    next_if_id = if_id;
+    next_id_ex = id_ex;
+    next_ex_mem = ex_mem;
+    next_mem_wb = mem_wb;
+    if_id2 = next_if_id2 = if_id;
+    id_ex2 = next_id_ex2 = id_ex;
+    ex_mem2 = next_ex_mem2 = ex_mem;
+    mem_wb2 = next_mem_wb2 = mem_wb;
+
+    stallIF = false;
+    stallNeeded = false;
+    memoryStall = 0;
+    fetchTimed = false;
+    dataTimed = false;
+    sharedValue = 0;
+    nextFetchPC = PC;
+    redirected = false;
+    secondHeld = false;
+    fetchSplit = false;
+    splitBubble = false;
+    lastBlock = UINT32_MAX;
+    units.reset();
+    scoreboard.update(id_ex, ex_mem, mem_wb);
+}
+
+// Loads architectural state (e.g. from the functional core) into an empty pipeline.
+void Processor::restoreArchState(uint32_t pc, const std::vector<int> &registers, const DataMemory &memory) {
+    PC = pc;
+    regs = registers;
+    regs[0] = 0;
+    stack_memory = memory;
+    reservation = Reservation();
+    flushPipeline();
+}
+
+// Logging helper: record the given stage for the instruction at the current cycle.
+// A stall marker (STALL, printed as "-") only shows if no real stage lands in the same cell.
+// The trace (if any) is not bounded by the table's cycle count.
+void Processor::logInstructionStage(const MicroOp &instr, PipelineLog::Stage stage) {
+    if (instr.type == InstType::NOP || instr.id < 0)
+        return;
+    if (trace)
+        trace->occupy(stage, instr.id, currentCycle);
+    if (currentCycle - logStartCycle >= logCycleCount)
+        return;
+    pipelineLog.record(instr.id, stage);
+}
+
+void Processor::traceStage(const MicroOp &instr, PipelineLog::Stage stage) {
+    if (trace && instr.type != InstType::NOP && instr.id >= 0)
+        trace->occupy(stage, instr.id, currentCycle);
+}
+
+
+
+// Print the header row with cycle numbers.
+void Processor::printPipelineLogHeader() const {
+    std::cout << std::setw(6) << " " << ":";
+    for (int i = 0; i < loggedCycles(); ++i) {
+        std::cout << std::setw(10) << ("C" + std::to_string(i+1));
+    }
+    std::cout << std::endl;
+}
+
+// Print one instruction’s log row (e.g., "I1 :  IF   ID   EX   MEM   WB ...")
+void Processor::printInstructionLog(int instrId) const {
+    if (instrId < 0 || instrId >= static_cast<int>(instructionMemory.size()))
+        return;
+    
+    // Use the assembly statement if available, otherwise default to "I<number>"
+    std::string label;
+    if (instrId < static_cast<int>(asmInstructions.size()) && !asmInstructions[instrId].empty()) {
+        label = asmInstructions[instrId].str();
+    } else {
+        label = "I" + std::to_string(instrId + 1);
+    }
+    
+    std::cout << std::setw(20) << label << " :";
+    const int columns = loggedCycles();
+    int cycle = 0;
+    for (const auto &e : pipelineLog.events()) {
+        if (e.instrId != instrId || static_cast<int>(e.cycle) >= columns)
+            continue;
+        for (; cycle < static_cast<int>(e.cycle); ++cycle)
+            std::cout << std::setw(10) << "";
+        std::cout << std::setw(10) << PipelineLog::cellText(e.stages);
+        ++cycle;
+    }
+    for (; cycle < columns; ++cycle)
+        std::cout << std::setw(10) << "";
+    std::cout << std::endl;
+}
+
+
+
+
+
+// Print the raw hex of an instruction from the side table, or "NOP" for a bubble.
+void Processor::printInstructionHex(const MicroOp &inst) const {
+    if (inst.id < 0 || inst.id >= static_cast<int>(instructionHex.size()) ||
+        instructionHex[inst.id].str() == "00000000" || instructionHex[inst.id].empty())
+        std::cout << "NOP";
+    else
+        std::cout << instructionHex[inst.id].str();
+}
+
+
+
+
+
+// -------------------------
+// Fetch Stage (with cycle parameter)
+// -------------------------
+void Processor::fetch(int cycle) {
+    if (cycle == 0) {
+        int32_t index = code.indexAt(PC);
+        splitBubble = false;
+        if (index >= 0 && fetchBlock && splitFetch(PC, instructionMemory[index].size)) {
+            // Only the first block of the instruction arrived; it is fetched again next cycle.
+            next_if_id.instruction = MicroOp::nop();
+            next_if_id.pc = PC;
+            nextFetchPC = PC;
+        }
+        else if (index >= 0) {
+            // Normal fetch
+            next_if_id.instruction = instructionMemory[index];
+            next_if_id.pc = PC;
+            nextFetchPC = predictor.predict(PC, next_if_id.instruction.size);
+            counters.fetchedBytes += next_if_id.instruction.size;
+            // std::cout << "Fetching instruction: " << index << std::endl;
+            logInstructionStage(next_if_id.instruction, PipelineLog::IF);
+        }
+        else {
+            // Past the end of instructions => keep fetching NOP
+            MicroOp nop = MicroOp::nop();
+            next_if_id.instruction = nop;
+            next_if_id.pc = PC;
+            nextFetchPC = PC + 4;
+        }
+        next_if_id.predictedPC = nextFetchPC;
+    }
+}
+
+bool Processor::splitFetch(uint32_t pc, uint32_t size) {
+    uint32_t first = pc & ~(fetchBlock - 1);
+    uint32_t last = (pc + size - 1) & ~(fetchBlock - 1);
+    // In straight-line code the first block is still there from the previous instruction.
+    if (first != last && first != lastBlock && !fetchSplit) {
+        readBlock(first);
+        splitBubble = true;
+        counters.fetchSplits++;
+        return true;
+    }
+    readBlock(last);
+    return false;
+}
+
+void Processor::readBlock(uint32_t block) {
+    if (block != lastBlock) {
+        lastBlock = block;
+        counters.fetchBlocks++;
+    }
+}
+
+template <class Policy>
+void Processor::decode(int cycle) {
+    // Decode logic runs in the second half of the pipeline cycle
+    if (cycle == 1) {
+        
+        // printInstructionHex(if_id.instruction);
+        // std::cout << std::endl;
+
+        // 1) Fields were pre-decoded at load time (see MicroOp), nothing to do here.
+
+        // std::cout << "Decoding instruction: ";
+        // if_id.instruction.print_inst_members();
+        // std::cout << std::endl;
+
+        // If not a NOP and no stall, log "ID".
+        if (if_id.instruction.type != InstType::NOP && !stallNeeded) {
+            logInstructionStage(if_id.instruction, PipelineLog::ID);
+        }
+
+
+        // Hazard detection is up to the policy (see HazardPolicy.hpp).
+        stallNeeded = Policy::mustStall(if_id.instruction, scoreboard);
+
+        // If a hazard is detected, insert a NOP in the ID/EX latch and stall IF.
+        if (stallNeeded) {
+            logInstructionStage(if_id.instruction, PipelineLog::STALL);
+            traceStage(if_id.instruction, PipelineLog::ID);
+            MicroOp nop = MicroOp::nop();
+            next_id_ex.instruction = nop;
+            next_id_ex.regWrite    = false;
+            next_id_ex.memRead     = false;
+            next_id_ex.memWrite    = false;
+            next_id_ex.branch      = false;
+            next_id_ex.aluOp       = ALUOp::NONE;
+            next_id_ex.rs1Val      = 0;
+            next_id_ex.rs2Val      = 0;
+            next_id_ex.imm         = 0;
+
+            stallIF = true;
+            stallCycles++;
+            if (if_id.instruction.type == InstType::B_TYPE)
+                counters.branchStalls++;
+            else if (if_id.instruction.opcode == 0x67)
+                counters.jalrStalls++;
+            else if (Policy::forwarding && !(Scoreboard::sources(if_id.instruction) & scoreboard.exLoads))
+                counters.unitLatencyStalls++;
+            else if (Policy::forwarding)
+                counters.loadUseStalls++;
+            else
+                counters.rawStalls++;
+            if (trace)
+                trace->instant(PipelineLog::ID, "stall", currentCycle);
+            return;
+        } else {
+            // No hazard: simply log a "-" (or you could log "ID" if preferred).
+            logInstructionStage(if_id.instruction, PipelineLog::STALL);
+            traceStage(if_id.instruction, PipelineLog::ID);
+        }
+        
+        
+        issue<Policy>(if_id, next_id_ex);
+    }
+}
+
+// The instruction in if_id leaves ID: copy its control signals into
+// next_id_ex, read its registers, and resolve branches and jumps.
+template <class Policy>
+void Processor::issue(const IF_ID_Latch &if_id, ID_EX_Latch &next_id_ex) {
+    // 4) No stall => control signals were resolved by the ControlUnit at load time
+    const MicroOp &signals = if_id.instruction;
+
+    // Copy instruction + PC into ID/EX
+    next_id_ex.pc          = if_id.pc;
+    next_id_ex.instruction = if_id.instruction;
+    next_id_ex.regWrite    = signals.regWrite;
+    next_id_ex.memRead     = signals.memRead;
+    next_id_ex.memWrite    = signals.memWrite;
+    next_id_ex.branch      = signals.branch;
+    next_id_ex.aluOp       = signals.aluOp;
+
+    // -------------------------------------------------------
+    // Register read logic + special handling for branch/jump
+    // -------------------------------------------------------
+    switch (if_id.instruction.type) {
+        // -----------------
+        // R-TYPE
+        // -----------------
+        case InstType::R_TYPE:
+            next_id_ex.rs1Val = regs[if_id.instruction.rs1];
+            next_id_ex.rs2Val = regs[if_id.instruction.rs2];
+            next_id_ex.imm    = 0;
+            break;
+
+        // -----------------
+        // I-TYPE
+        // -----------------
+        // I-Type
+                // -----------------
+    // I-TYPE
+    // -----------------
+    // I-Type
+    case InstType::I_TYPE:
+    // For most I-type instructions:
+    next_id_ex.rs1Val = regs[if_id.instruction.rs1];
+    next_id_ex.rs2Val = 0;
+    next_id_ex.imm = if_id.instruction.imm;
+    // Special handling for JALR (opcode 0x67)
+    if (if_id.instruction.opcode == 0x67) {
+        // Set up the latch to defer the link address write.
+        next_id_ex.pc = if_id.pc;
+        next_id_ex.instruction = if_id.instruction;
+        next_id_ex.regWrite = true; // JALR writes to rd.
+        // Instead of updating the register immediately, store the link address.
+        next_id_ex.imm = if_id.pc + if_id.instruction.size;
+        
+        // Use the register file value for rs1, or a forwarded value if the policy has bypass paths.
+        uint32_t rs1Val = Policy::bypass(if_id.instruction.rs1, regs[if_id.instruction.rs1], ex_mem, mem_wb,
+                                         ex_mem2, mem_wb2, scoreboard);
+        next_id_ex.rs1Val = rs1Val;
+        next_id_ex.rs2Val = 0;
+        
+        // Compute jump target using the (possibly forwarded) rs1 value and the immediate from the instruction.
+        int jumpTarget = rs1Val + if_id.instruction.imm;
+        jumpTarget &= ~1; // Ensure proper alignment.
+        counters.jumps++;
+
+        // Flush IF/ID unless fetch already followed the jump.
+        if (!predictor.resolve(if_id.pc, if_id.instruction, true, jumpTarget, if_id.predictedPC))
+            redirectFetch(jumpTarget);
+        return;
+    }
+    break;
+
+
+
+        // -----------------
+        // S-TYPE
+        // -----------------
+        case InstType::S_TYPE:
+            next_id_ex.rs1Val = regs[if_id.instruction.rs1];
+            next_id_ex.rs2Val = regs[if_id.instruction.rs2];
+            next_id_ex.imm    = if_id.instruction.imm;
+            break;
+
+        // -----------------
+        // B-TYPE (Branches)
+        // -----------------
+        case InstType::B_TYPE: {
+            // Read the register file values, overridden by forwarded values if the policy has bypass paths.
+            uint32_t rs1Val = Policy::bypass(if_id.instruction.rs1, regs[if_id.instruction.rs1], ex_mem, mem_wb,
+                                             ex_mem2, mem_wb2, scoreboard);
+            uint32_t rs2Val = Policy::bypass(if_id.instruction.rs2, regs[if_id.instruction.rs2], ex_mem, mem_wb,
+                                             ex_mem2, mem_wb2, scoreboard);
+            
+            // Save these values for use in later stages if needed.
+            next_id_ex.rs1Val = rs1Val;
+            next_id_ex.rs2Val = rs2Val;
+            next_id_ex.imm    = if_id.instruction.imm;
+            
+            // Evaluate the branch condition using the (possibly forwarded) values.
+            uint8_t f3 = if_id.instruction.funct3;
+            // std:: cout << "Evaluating BRANCH with rs1 = " << rs1Val << ", rs2 = " << rs2Val << std::endl;
+            bool branchTaken = ALU::branchTaken(f3, rs1Val, rs2Val);
+            if (branchTaken)
+                counters.branchesTaken++;
+            else
+                counters.branchesNotTaken++;
+            
+            // Next PC based on the branch decision.
+            uint32_t nextPC = branchTaken ? if_id.pc + if_id.instruction.imm : if_id.pc + if_id.instruction.size;
+
+            // Flush the pipeline: send NOP to ID/EX
+            // nop.type = InstType::NOP;
+            // next_id_ex.instruction = nop;
+            // next_id_ex.regWrite    = false;
+            // next_id_ex.memRead     = false;
+            // next_id_ex.memWrite    = false;
+            // next_id_ex.branch      = false;
+            // next_id_ex.aluOp       = ALUOp::NONE;
+            // next_id_ex.rs1Val      = 0;
+            // next_id_ex.rs2Val      = 0;
+            // next_id_ex.imm         = 0;
+            next_id_ex.instruction = if_id.instruction;
+            next_id_ex.regWrite    = false;
+            next_id_ex.memRead     = false;
+            next_id_ex.memWrite    = false;
+            next_id_ex.branch      = false;
+            next_id_ex.aluOp       = ALUOp::NONE;
+            next_id_ex.rs1Val      = 0;
+            next_id_ex.rs2Val      = 0;
+            next_id_ex.imm         = 0;
+
+
+            // ALSO flush IF/ID so we won't re-decode the same branch,
+            // unless the predictor already sent fetch down the right path.
+            if (!predictor.resolve(if_id.pc, if_id.instruction, branchTaken, nextPC, if_id.predictedPC))
+                redirectFetch(nextPC);
+
+            return; // Done handling the branch
+        }
+
+        // -----------------
+        // A-TYPE (atomics): address in rs1, operand in rs2
+        // -----------------
+        case InstType::A_TYPE:
+            next_id_ex.rs1Val = regs[if_id.instruction.rs1];
+            next_id_ex.rs2Val = regs[if_id.instruction.rs2];
+            next_id_ex.imm    = 0;
+            break;
+
+        // -----------------
+        // U-TYPE
+        // -----------------
+        case InstType::U_TYPE:
+            next_id_ex.rs1Val = 0;
+            next_id_ex.rs2Val = 0;
+            next_id_ex.imm    = if_id.instruction.imm;
+            break;
+
+        // -----------------
+        // J-TYPE (e.g. JAL)
+        // -----------------
+        case InstType::J_TYPE: {
+            int32_t offset = if_id.instruction.imm;
+            // uint8_t rd = if_id.instruction.rd;
+            
+            // Set up the ID/EX latch:
+            next_id_ex.pc = if_id.pc;
+            next_id_ex.instruction = if_id.instruction;
+            next_id_ex.regWrite = true;  // JAL writes to rd.
+            // Store the link address (the next instruction's PC) in the imm field.
+            next_id_ex.imm = if_id.pc + if_id.instruction.size;
+            // You can clear rs1Val/rs2Val as they're unused.
+            next_id_ex.rs1Val = 0;
+            next_id_ex.rs2Val = 0;
+            
+            // Flush the IF/ID latch and fetch from the jump target, unless fetch is already there.
+            uint32_t target = if_id.pc + offset;
+            counters.jumps++;
+            if (!predictor.resolve(if_id.pc, if_id.instruction, true, target, if_id.predictedPC))
+                redirectFetch(target);
+            return;
+        }
+        
+
+        // -----------------
+        // NOP / UNKNOWN
+        // -----------------
+        default:
+            next_id_ex.rs1Val = 0;
+            next_id_ex.rs2Val = 0;
+            next_id_ex.imm    = 0;
+            break;
+    }
+}
+
+
+
+// -------------------------
+// Execute Stage (with cycle parameter)
+// -------------------------
+template <class Policy>
+void Processor::execute(int cycle, unsigned slot) {
+    // The stage works on its slot's latches under the usual names.
+    const ID_EX_Latch &id_ex = slot ? id_ex2 : this->id_ex;
+    EX_MEM_Latch &next_ex_mem = slot ? next_ex_mem2 : this->next_ex_mem;
+    if (cycle == 0) {
+        // std::cout << "[DEBUG] EX stage: Instruction = ";
+        // printInstructionHex(id_ex.instruction);
+        // std::cout << "\n  ALUOp = " << (int)id_ex.aluOp
+        //           << ", rs1Val = " << id_ex.rs1Val
+        //           << ", rs2Val = " << id_ex.rs2Val
+        //           << ", imm = " << id_ex.imm << std::endl;
+        uint32_t operand1 = id_ex.rs1Val;
+        if(id_ex.instruction.type == InstType::U_TYPE)
+        {
+            operand1 = id_ex.pc;
+        }
+        uint32_t operand2 = 0;
+
+        // Set operand2 based on instruction type.
+        switch (id_ex.instruction.type) {
+            case InstType::R_TYPE:
+                operand2 = id_ex.rs2Val;
+                break;
+            case InstType::I_TYPE:
+                operand2 = id_ex.imm;
+                break;
+            case InstType::S_TYPE:
+                operand2 = id_ex.imm;
+                break;
+            case InstType::B_TYPE:
+            case InstType::A_TYPE:
+                operand2 = id_ex.rs2Val;
+                break;
+            case InstType::U_TYPE:
+                // For U-type, operand2 may not be used by the ALU.
+                operand2 = id_ex.imm;
+                break;
+            case InstType::J_TYPE: // ye PC update mei krna h
+                // For J-type (e.g., JAL), we compute the jump target.
+                // The jump target is computed as current PC + immediate.
+                // Although we set operand2 here, the main purpose is to compute branchTarget.
+                operand2 = id_ex.imm;
+                break;
+            default:
+                operand2 = id_ex.imm;
+                break;
+        }
+
+        // Override operands if a later stage holds the updated value (forwarding policies only).
+        // Unused source fields are x0 and are never forwarded; a store's rs2 is forwarded in MEM.
+        operand1 = Policy::bypass(id_ex.instruction.rs1, operand1, ex_mem, mem_wb, ex_mem2, mem_wb2, scoreboard);
+        if (id_ex.instruction.type != InstType::S_TYPE)
+            operand2 = Policy::bypass(id_ex.instruction.rs2, operand2, ex_mem, mem_wb, ex_mem2, mem_wb2, scoreboard);
+
+        int aluResult = 0;
+        // Perform the ALU operation as needed.
+        // Special case: For JAL, simply pass along the link address (PC + size) stored in id_ex.imm.
+        // Special case: For JALR (opcode 0x67), forward the link address (PC + size) stored in id_ex.imm.
+        if (id_ex.instruction.opcode == 0x67) {
+            aluResult = id_ex.imm;
+        } else if (id_ex.instruction.type == InstType::J_TYPE) {
+            aluResult = id_ex.imm;
+        } else if (id_ex.instruction.type == InstType::A_TYPE) {
+            aluResult = operand1;   // The address; the operation itself happens in MEM.
+        }
+        else
+        {
+            aluResult = ALU::execute(id_ex.aluOp, operand1, operand2);
+        }
+        // For branch or jump instructions (B-type and J-type),
+        // compute the branch/jump target address.
+        next_ex_mem.branchTarget = id_ex.pc + id_ex.imm;
+        
+        // Prepare next EX/MEM latch.
+        next_ex_mem.aluResult = aluResult;
+        // An atomic's rs2 operand was forwarded above. A store's data is
+        // forwarded here from a producer two ahead (gone by MEM) and again in
+        // MEM from one just ahead.
+        if (id_ex.instruction.type == InstType::A_TYPE)
+            next_ex_mem.rs2Val = operand2;
+        else if (id_ex.instruction.type == InstType::S_TYPE)
+            next_ex_mem.rs2Val = Policy::bypass(id_ex.instruction.rs2, id_ex.rs2Val, ex_mem, mem_wb,
+                                                ex_mem2, mem_wb2, scoreboard);
+        else
+            next_ex_mem.rs2Val = id_ex.rs2Val;
+        next_ex_mem.regWrite = id_ex.regWrite;
+        next_ex_mem.memRead = id_ex.memRead;
+        next_ex_mem.memWrite = id_ex.memWrite;
+        next_ex_mem.branch = id_ex.branch;
+        next_ex_mem.instruction = id_ex.instruction;
+        next_ex_mem.readyCycle = 0;
+        if (units.enabled() && FunctionalUnits::usesUnit(id_ex.instruction))
+            next_ex_mem.readyCycle = units.start(id_ex.aluOp, slot, currentCycle);
+        logInstructionStage(id_ex.instruction, PipelineLog::EX);
+
+    }
+    // Second half: no additional work in execute stage.
+}
+
+
+
+// -------------------------
+// Memory Access Stage (with cycle parameter)
+// -------------------------
+template <class Policy>
+void Processor::memAccess(int cycle, unsigned slot) {
+    const EX_MEM_Latch &ex_mem = slot ? ex_mem2 : this->ex_mem;
+    MEM_WB_Latch &next_mem_wb = slot ? next_mem_wb2 : this->next_mem_wb;
+    // Perform the memory operation in the whole cycle.
+    uint32_t addr = ex_mem.aluResult;
+    next_mem_wb.readyCycle = ex_mem.readyCycle;
+
+    // Atomics read, modify and write in this one stage.
+    if (ex_mem.instruction.type == InstType::A_TYPE && ex_mem.memRead) {
+        uint32_t value = Policy::storeData(ex_mem.instruction.rs2, ex_mem.rs2Val, mem_wb, mem_wb2, scoreboard);
+        ALUOp op = ex_mem.instruction.aluOp;
+        bool wrote = false;
+        next_mem_wb.writeData   = shared ? sharedValue
+                                         : Atomics::execute(stack_memory, op, addr, value, reservation, wrote);
+        next_mem_wb.regWrite    = ex_mem.regWrite;
+        next_mem_wb.instruction = ex_mem.instruction;
+    }
+    // If this is a store operation:
+    else if (ex_mem.memWrite) {
+        uint32_t value = ex_mem.rs2Val;
+        // When forwarding, take the value from MEM/WB if available.
+        value = Policy::storeData(ex_mem.instruction.rs2, value, mem_wb, mem_wb2, scoreboard);
+        // std::cout << "Storing value " << value << " to address " << addr << std::endl;
+        if (!shared)   // Already stored when it was timed.
+            stack_memory.store(ex_mem.instruction.funct3, addr, value);
+        next_mem_wb.writeData   = 0;
+        next_mem_wb.regWrite    = false;
+        next_mem_wb.instruction = ex_mem.instruction;
+    }
+    // Else if this is a load operation:
+    else if (ex_mem.memRead) {
+        uint32_t data = shared ? sharedValue : stack_memory.load(ex_mem.instruction.funct3, addr);
+        // Put the load result in MEM/WB
+        next_mem_wb.writeData   = data;
+        next_mem_wb.regWrite    = ex_mem.regWrite;
+        next_mem_wb.instruction = ex_mem.instruction;
+    }
+    // If no memory operation is required (e.g. simple ALU):
+    else {
+        next_mem_wb.writeData   = ex_mem.aluResult;
+        next_mem_wb.regWrite    = ex_mem.regWrite;
+        next_mem_wb.instruction = ex_mem.instruction;
+    }
+    logInstructionStage(ex_mem.instruction, PipelineLog::MEM);
+
+    // >>> Approach A: Flush EX/MEM afterwards for ALU or load/store instructions.
+    // That way, the instruction won't stay in EX/MEM indefinitely.
+    // Instruction flushNOP;
+    // flushNOP.type = InstType::NOP;
+    // next_ex_mem.instruction = flushNOP;
+    // next_ex_mem.regWrite    = false;
+    // next_ex_mem.memRead     = false;
+    // next_ex_mem.memWrite    = false;
+    // next_ex_mem.branch      = false;
+    // next_ex_mem.aluResult   = 0;
+    // next_ex_mem.rs2Val      = 0;
+    // next_ex_mem.branchTarget= 0;
+}
+
+
+
+
+// -------------------------
+// Write-Back Stage (with cycle parameter)
+// -------------------------
+void Processor::writeBack(int cycle, unsigned slot) {
+    const MEM_WB_Latch &mem_wb = slot ? mem_wb2 : this->mem_wb;
+    if (cycle == 0) {  // First half: perform write-back.
+        if (mem_wb.regWrite) {
+            uint8_t rd = mem_wb.instruction.rd;
+             // Only write back if the destination register is not x0.
+            if (rd != 0) {
+                regs[rd] = mem_wb.writeData;
+            }
+            // std::cout << "WriteBack: Register x" << unsigned(rd)
+            //           << " updated to " << regs[rd] << std::endl;
+        }
+        logInstructionStage(mem_wb.instruction, PipelineLog::WB);
+        if (mem_wb.instruction.type != InstType::NOP)
+            instructionsRetired++;
+        if (mem_wb.instruction.memRead)
+            counters.loads++;
+        else if (mem_wb.instruction.memWrite)
+            counters.stores++;
+    } 
+
+    
+    // Second half: no write operations.
+
+    // >>> Approach A: flush out MEM/WB afterwards
+    // so the same instruction won't remain in MEM/WB multiple cycles.
+    // Instruction nop;
+    // nop.type = InstType::NOP;
+    // next_mem_wb.instruction = nop;
+    // next_mem_wb.regWrite    = false;
+    // next_mem_wb.writeData   = 0;
+}
+
+
+// -------------------------
+// Update Pipeline Latches and PC
+// -------------------------
+void Processor::updateLatches() {
+    // The older pipeline latches update unconditionally:
+    id_ex = next_id_ex;
+    ex_mem = next_ex_mem;
+    mem_wb = next_mem_wb;
+    dataTimed = false;
+
+    // Now handle the front end:
+    if (!stallIF) {
+        // Normal fetch => move next_if_id into if_id and advance PC
+        if_id = next_if_id;
+        fetchTimed = false;
+        // A redirect in ID already set PC; otherwise follow fetch (the next instruction or the predicted target).
+        if (!redirected) {
+            PC = nextFetchPC;
+        }
+        fetchSplit = splitBubble && !redirected;
+    }
+     else {
+        // Freeze: do NOT update if_id or PC
+        stallIF = false; // Clear for next cycle unless decode sets it again
+        fetchSplit = fetchSplit || splitBubble;
+        // std::cout << "Stalling front end, reusing same IF/ID instruction.\n";
+    }
+    redirected = false;
+    scoreboard.update(id_ex, ex_mem, mem_wb);
+}
+
+void Processor::redirectFetch(uint32_t target) {
+    PC = target;
+    next_if_id.instruction = MicroOp::nop();
+    next_if_id.pc = PC;
+    stallIF = false;   // DO NOT stall next cycle — we want to fetch the new instruction.
+    redirected = true;
+    flushedFetches++;
+    if (trace)
+        trace->instant(PipelineLog::IF, "flush", currentCycle);
+}
+
+
+// -------------------------
+// Run One Full Cycle
+// -------------------------
+void Processor::runCycle() {
+    (this->*cycleImpl)();
+}
+
+// One cycle with every stage specialized for the hazard policy.
+template <class Policy>
+void Processor::runCycleWith() {
+    if (memoryStall == 0 && (icache.enabled() || dcache.enabled() || shared))
+        memoryStall = timeMemoryAccesses<Policy>();
+    if (memoryStall > 0) {
+        memoryStall--;
+        cacheStallCycles++;
+        freezeCycle();
+        return;
+    }
+    if (units.enabled() && unitStall()) {
+        freezeCycle();
+        return;
+    }
+
+    // First half (cycle = 0) for all stages.
+    fetch(0);
+    decode<Policy>(0);
+    execute<Policy>(0);
+    memAccess<Policy>(0);
+    writeBack(0); // Write-back is done in the first half.
+
+    // Second half (cycle = 1) for all stages.
+    fetch(1);
+    decode<Policy>(1);
+    execute<Policy>(1);
+    // memAccess(1); // Memory access is processed through the whole cycle.
+    // writeBack(1); // Write-back is done in the first half.
+    
+    // Commit the computed next state and update the PC.
+    updateLatches();
+    pipelineLog.endCycle(currentCycle - logStartCycle);
+    
+    // Print the concise pipeline state.
+    // printPipelineState();
+    currentCycle++;
+    
+    // Also print detailed pipeline debug info.
+    // debug_print();
+}
+
+// -------------------------
+// Dual Issue
+// -------------------------
+namespace {
+    bool usesMulDiv(const MicroOp &op) {
+        return op.aluOp == ALUOp::MUL || op.aluOp == ALUOp::DIV;
+    }
+}
+
+// The two slots move through EX, MEM and WB side by side, the older
+// instruction of each pair in the first slot. ID issues none, the older, or
+// both of the instructions in IF/ID; fetch then refills IF/ID behind the ones
+// still waiting, so ID always sees the two oldest unissued instructions.
+template <class Policy>
+void Processor::runCycleDual() {
+    if (memoryStall == 0 && (icache.enabled() || dcache.enabled() || shared))
+        memoryStall = timeMemoryAccesses<Policy>();
+    if (memoryStall > 0) {
+        memoryStall--;
+        cacheStallCycles++;
+        freezeCycle();
+        return;
+    }
+    if (units.enabled() && unitStall()) {
+        freezeCycle();
+        return;
+    }
+
+    execute<Policy>(0);
+    execute<Policy>(0, 1);
+    memAccess<Policy>(0);
+    memAccess<Policy>(0, 1);
+    writeBack(0);
+    writeBack(0, 1);   // The younger of a pair writes last.
+
+    decodeDual<Policy>();
+    updateLatchesDual();
+    pipelineLog.endCycle(currentCycle - logStartCycle);
+    currentCycle++;
+}
+
+template <class Policy>
+void Processor::decodeDual() {
+    const MicroOp &older = if_id.instruction;
+    const MicroOp &younger = if_id2.instruction;
+    bool youngerNew = !stallNeeded;   // After a stall both slots were already in ID.
+    if (secondHeld)
+        stallNeeded = true;           // decode() logs ID only for instructions new to ID.
+
+    // The first slot decodes, stalls and resolves branches as with single issue.
+    decode<Policy>(1);
+    bool firstIssued = !stallNeeded && older.type != InstType::NOP;
+
+    bool secondIssued = false;
+    if (younger.type != InstType::NOP) {
+        if (youngerNew)
+            logInstructionStage(younger, PipelineLog::ID);
+        logInstructionStage(younger, PipelineLog::STALL);
+        if (firstIssued) {
+            uint64_t *conflict = pairConflict<Policy>(older, younger);
+            if (conflict)
+                (*conflict)++;
+            else
+                secondIssued = true;
+        }
+    } else if (firstIssued) {
+        counters.pairEmpty++;
+    }
+
+    if (secondIssued) {
+        issue<Policy>(if_id2, next_id_ex2);
+    } else {
+        next_id_ex2 = ID_EX_Latch();
+        next_id_ex2.instruction = MicroOp::nop();
+    }
+    unsigned issued = (firstIssued ? 1 : 0) + (secondIssued ? 1 : 0);
+    counters.issued += issued;
+    if (issued == 2)
+        counters.pairsIssued++;
+    recordIssued(issued);
+    fetchDual(firstIssued, secondIssued);
+}
+
+template <class Policy>
+uint64_t *Processor::pairConflict(const MicroOp &older, const MicroOp &younger) {
+    if (older.type == InstType::B_TYPE || older.type == InstType::J_TYPE || older.opcode == 0x67)
+        return &counters.pairControl;
+    if (older.regWrite && (Scoreboard::sources(younger) & Scoreboard::bit(older.rd)))
+        return &counters.pairDependency;
+    if ((older.memRead || older.memWrite) && (younger.memRead || younger.memWrite))
+        return &counters.pairMemoryPort;
+    if (usesMulDiv(older) && usesMulDiv(younger))
+        return &counters.pairMulDiv;
+    if (Policy::mustStall(younger, scoreboard))
+        return &counters.pairHazard;
+    return nullptr;
+}
+
+// Refills IF/ID: instructions that did not issue move to the front, then
+// fetch continues at PC. A fetch group ends after a predicted-taken branch
+// or jump, since fetch follows one target per cycle. A redirect from ID
+// squashes both slots instead.
+void Processor::fetchDual(bool firstIssued, bool secondIssued) {
+    IF_ID_Latch group[2];
+    unsigned count = 0;
+    secondHeld = false;
+    if (!redirected) {
+        if (!firstIssued && if_id.instruction.type != InstType::NOP)
+            group[count++] = if_id;
+        if (!secondIssued && if_id2.instruction.type != InstType::NOP) {
+            secondHeld = firstIssued;
+            group[count++] = if_id2;
+        }
+        uint32_t pc = PC;
+        if (count < 2)
+            fetchTimed = false;
+        splitBubble = false;
+        uint32_t block = 0;     // With a fetch block: the block the first new instruction ends in.
+        for (bool first = true; count < 2; first = false) {
+            int32_t index = code.indexAt(pc);
+            if (index < 0)
+                break;
+            const MicroOp &inst = instructionMemory[index];
+            if (fetchBlock) {
+                if (first) {
+                    if (splitFetch(pc, inst.size))
+                        break;
+                    block = (pc + inst.size - 1) & ~(fetchBlock - 1);
+                } else if ((pc & ~(fetchBlock - 1)) != block || ((pc + inst.size - 1) & ~(fetchBlock - 1)) != block) {
+                    counters.fetchBlockEnds++;
+                    break;
+                }
+            }
+            IF_ID_Latch &fetched = group[count++];
+            fetched.instruction = inst;
+            fetched.pc = pc;
+            fetched.predictedPC = predictor.predict(pc, inst.size);
+            counters.fetchedBytes += inst.size;
+            logInstructionStage(fetched.instruction, PipelineLog::IF);
+            pc = fetched.predictedPC;
+            if (pc != fetched.pc + inst.size)
+                break;
+        }
+        nextFetchPC = pc;
+    } else {
+        fetchTimed = false;
+    }
+    for (; count < 2; ++count) {
+        group[count] = IF_ID_Latch();
+        group[count].instruction = MicroOp::nop();
+        group[count].pc = group[count].predictedPC = PC;
+    }
+    next_if_id = group[0];
+    next_if_id2 = group[1];
+}
+
+void Processor::updateLatchesDual() {
+    if_id = next_if_id;
+    id_ex = next_id_ex;
+    ex_mem = next_ex_mem;
+    mem_wb = next_mem_wb;
+    if_id2 = next_if_id2;
+    id_ex2 = next_id_ex2;
+    ex_mem2 = next_ex_mem2;
+    mem_wb2 = next_mem_wb2;
+    dataTimed = false;
+    // A redirect in ID already set PC.
+    if (!redirected)
+        PC = nextFetchPC;
+    fetchSplit = splitBubble && !redirected;
+    stallIF = false;
+    redirected = false;
+    scoreboard.update(id_ex, ex_mem, mem_wb, id_ex2, ex_mem2, mem_wb2);
+}
+
+void Processor::recordIssued(unsigned count) {
+    if (currentCycle - logStartCycle < logCycleCount)
+        issuedPerCycle.push_back(count);
+}
+
+// Looks up this cycle's fetch and data access (each only once, however long
+// it is held) and returns the number of extra cycles the slower one needs.
+// The I- and D-side refills are serviced in parallel, and so are a D-cache
+// refill and the coherence request for the same access.
+template <class Policy>
+uint32_t Processor::timeMemoryAccesses() {
+    uint32_t fetchLatency = 1, dataLatency = 1;
+    if (!fetchTimed && code.indexAt(PC) >= 0) {
+        // The second half of an instruction split across fetch blocks is in the next block.
+        fetchLatency = icache.access(fetchSplit ? PC + 2 : PC, false);
+        fetchTimed = true;
+        if (trace && fetchLatency > 1)
+            trace->instant(PipelineLog::IF, "I-cache stall", currentCycle);
+    }
+    // A pair has at most one memory access, in either slot.
+    const EX_MEM_Latch &data = (ex_mem2.memRead || ex_mem2.memWrite) ? ex_mem2 : ex_mem;
+    if (!dataTimed && (data.memRead || data.memWrite)) {
+        dataLatency = dcache.access(data.aluResult, data.memWrite);
+        if (shared) {
+            // The coherence transition and the data access happen together,
+            // here; the latches hold until MEM, so the store data is final.
+            uint32_t latency;
+            const MicroOp &inst = data.instruction;
+            if (inst.type == InstType::A_TYPE && data.memRead) {
+                uint32_t value = Policy::storeData(inst.rs2, data.rs2Val, mem_wb, mem_wb2, scoreboard);
+                sharedValue = shared->atomic(hartId, inst.aluOp, data.aluResult, value, latency);
+            } else if (data.memWrite) {
+                uint32_t value = Policy::storeData(inst.rs2, data.rs2Val, mem_wb, mem_wb2, scoreboard);
+                shared->store(hartId, inst.funct3, data.aluResult, value, latency);
+            } else {
+                sharedValue = shared->load(hartId, inst.funct3, data.aluResult, latency);
+            }
+            dataLatency = std::max(dataLatency, latency);
+        }
+        dataTimed = true;
+        if (trace && dataLatency > 1)
+            trace->instant(PipelineLog::MEM, "D-cache stall", currentCycle);
+    }
+    return std::max(fetchLatency, dataLatency) - 1;
+}
+
+// A cycle spent waiting on a cache: nothing moves and the instructions in
+// flight log a stall.
+void Processor::freezeCycle() {
+    logInstructionStage(if_id.instruction, PipelineLog::STALL);
+    logInstructionStage(id_ex.instruction, PipelineLog::STALL);
+    logInstructionStage(ex_mem.instruction, PipelineLog::STALL);
+    logInstructionStage(mem_wb.instruction, PipelineLog::STALL);
+    traceStage(if_id.instruction, PipelineLog::ID);
+    traceStage(id_ex.instruction, PipelineLog::EX);
+    traceStage(ex_mem.instruction, PipelineLog::MEM);
+    traceStage(mem_wb.instruction, PipelineLog::WB);
+    if (issueWidth > 1) {
+        logInstructionStage(if_id2.instruction, PipelineLog::STALL);
+        logInstructionStage(id_ex2.instruction, PipelineLog::STALL);
+        logInstructionStage(ex_mem2.instruction, PipelineLog::STALL);
+        logInstructionStage(mem_wb2.instruction, PipelineLog::STALL);
+        recordIssued(0);
+    }
+    pipelineLog.endCycle(currentCycle - logStartCycle);
+    currentCycle++;
+}
+
+bool Processor::unitStall() {
+    const MEM_WB_Latch *writeBacks[] = {&mem_wb, &mem_wb2};
+    const ID_EX_Latch *entering[] = {&id_ex, &id_ex2};
+    for (unsigned slot = 0; slot < issueWidth; ++slot) {
+        const MicroOp &inst = writeBacks[slot]->instruction;
+        if (writeBacks[slot]->readyCycle > currentCycle) {
+            units.counters(FunctionalUnits::unitFor(inst.aluOp)).resultStalls++;
+            if (trace)
+                trace->instant(PipelineLog::WB, "result stall", currentCycle);
+            unitStallCycles++;
+            return true;
+        }
+    }
+    for (unsigned slot = 0; slot < issueWidth; ++slot) {
+        const MicroOp &inst = entering[slot]->instruction;
+        if (FunctionalUnits::usesUnit(inst) && units.busy(inst.aluOp, slot, currentCycle)) {
+            units.counters(FunctionalUnits::unitFor(inst.aluOp)).issueStalls++;
+            if (trace)
+                trace->instant(PipelineLog::EX, "unit busy", currentCycle);
+            unitStallCycles++;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Processor::isDrained() const {
+    return code.indexAt(PC) < 0 &&
+           if_id.instruction.type == InstType::NOP &&
+           id_ex.instruction.type == InstType::NOP &&
+           ex_mem.instruction.type == InstType::NOP &&
+           mem_wb.instruction.type == InstType::NOP &&
+           if_id2.instruction.type == InstType::NOP &&
+           id_ex2.instruction.type == InstType::NOP &&
+           ex_mem2.instruction.type == InstType::NOP &&
+           mem_wb2.instruction.type == InstType::NOP;
+}
+
+// -------------------------
+// Run Until the Pipeline Drains (or a cap is reached)
+// -------------------------
+StopReason Processor::runUntilDrained(int maxCycles, uint64_t maxRetired) {
+    int cycleCap = totalCycleCount;
+    if (maxCycles > 0 && maxCycles < cycleCap)
+        cycleCap = maxCycles;
+
+    while (!isDrained()) {
+        if (currentCycle - logStartCycle >= cycleCap)
+            return StopReason::CYCLE_CAP;
+        if (maxRetired > 0 && instructionsRetired >= maxRetired)
+            return StopReason::RETIRE_CAP;
+        runCycle();
+    }
+    return StopReason::DRAINED;
+}
+
+int Processor::loggedCycles() const {
+    int cyclesRun = currentCycle - logStartCycle;
+    return cyclesRun < logCycleCount ? cyclesRun : logCycleCount;
+}
+
+void Processor::debug_print() {
+    std::cout << "----- Debug Print: Pipeline Latches -----" << std::endl;
+    
+    std::cout << "IF/ID Stage: Instruction: ";
+    printInstructionHex(if_id.instruction);
+    std::cout << std::endl << ", PC: " << if_id.pc << std::endl;
+    
+    
+    std::cout << "ID/EX Stage: Instruction: ";
+    printInstructionHex(id_ex.instruction);
+    std::cout << ", PC: " << id_ex.pc;
+    std::cout << ", rs1Val: " << id_ex.rs1Val 
+              << ", rs2Val: " << id_ex.rs2Val 
+              << ", Imm: " << id_ex.imm << std::endl;
+    
+    std::cout << "EX/MEM Stage: Instruction: ";
+    printInstructionHex(ex_mem.instruction);
+    std::cout << ", ALU Result: " << ex_mem.aluResult
+              << ", rs2Val: " << ex_mem.rs2Val << std::endl;
+    
+    std::cout << "MEM/WB Stage: Instruction: ";
+    printInstructionHex(mem_wb.instruction);
+    std::cout << ", Write Data: " << mem_wb.writeData << std::endl;
+    
+    std::cout << "-------------------------------------------" << std::endl;
+}
+
+
+// -------------------------
+// Debug: Print Pipeline State
+// -------------------------
+void Processor::printPipelineState() {
+    std::cout << "----- Pipeline State -----" << std::endl;
+    std::cout << "IF/ID: "<< std::endl;
+    printInstructionHex(if_id.instruction);
+    std::cout << std::endl;
+    
+    std::cout << "ID/EX: "<< std::endl;
+    printInstructionHex(id_ex.instruction);
+    std::cout << std::endl;
+    
+    std::cout << "EX/MEM: "<< std::endl;
+    printInstructionHex(ex_mem.instruction);
+    std::cout << std::endl;
+    std::cout << " | ALU Result: " << ex_mem.aluResult << std::endl;
+    
+    std::cout << "MEM/WB: "<< std::endl;
+    printInstructionHex(mem_wb.instruction);
+    std::cout << std::endl;
+    std::cout << " | Write Data: " << mem_wb.writeData << std::endl;
+}
+
+void Processor::print_registers(std::ostream &out)
+{
+    out << "Registers: " << std::endl;
+    for (int i = 0; i < 32; i++)
+    {
+        out << "x" << i << ": " << regs[i] << std::endl;
+    }
+
+}
+void Processor::printFullPipelineLog(std::ostream &out) const {
+    const int labelWidth = 20; // Adjust this width as needed for your assembly statements.
+    const int cellWidth = 10;  // Fixed width for each cycle cell.
+    
+    // Print header row with cycle numbers.
+    const int columns = loggedCycles();
+    out << std::setw(labelWidth) << std::left << " " << " :";
+    for (int i = 0; i < columns; ++i) {
+        out << std::setw(cellWidth) << std::right << ("C" + std::to_string(i + 1));
+    }
+    out << std::endl;
+
+    std::vector<size_t> offsets;
+    std::vector<PipelineLog::Cell> cells;
+    pipelineLog.groupByInstruction(instructionMemory.size(), offsets, cells);
+
+    // Render each instruction's row straight from its cells; cycles without a cell are blank.
+    for (size_t i = 0; i < instructionMemory.size(); ++i) {
+        // Use the assembly statement if available; otherwise, default to "I<number>".
+        std::string label;
+        if (i < asmInstructions.size() && !asmInstructions[i].empty())
+            label = asmInstructions[i].str();
+        else
+            label = "I" + std::to_string(i + 1);
+        
+        // Print the label left-aligned within the fixed width.
+        out << std::setw(labelWidth) << std::left << label << " :";
+        // Print each cell right-aligned.
+        size_t next = offsets[i];
+        for (int j = 0; j < columns; ++j) {
+            std::string cell;
+            if (next < offsets[i + 1] && static_cast<int>(cells[next].cycle) == j)
+                cell = PipelineLog::cellText(cells[next++].stages);
+            out << std::setw(cellWidth) << std::right << cell;
+        }
+        out << std::endl;
+    }
+    // Dual issue: how many instructions left ID in each cycle.
+    if (issueWidth > 1) {
+        out << std::setw(labelWidth) << std::left << "issued" << " :";
+        for (int j = 0; j < columns && j < static_cast<int>(issuedPerCycle.size()); ++j)
+            out << std::setw(cellWidth) << std::right << static_cast<int>(issuedPerCycle[j]);
+        out << std::endl;
+    }
+}
+
+void Processor::printFullPipelineLogSimple(std::ostream &out) const {
+    const int columns = loggedCycles();
+    std::vector<size_t> offsets;
+    std::vector<PipelineLog::Cell> cells;
+    pipelineLog.groupByInstruction(instructionMemory.size(), offsets, cells);
+
+    for (size_t i = 0; i < instructionMemory.size(); ++i) {
+        // Use the assembly instruction if available; if not, use a single space.
+        std::string label;
+        if (i < asmInstructions.size() && !asmInstructions[i].empty())
+            label = asmInstructions[i].str();
+        else
+            label = " ";
+        
+        // Print the label and a colon.
+        out << label << ":";
+        
+        // Print each stage from the pipeline log separated by semicolons.
+        size_t next = offsets[i];
+        for (int j = 0; j < columns; ++j) {
+            if (j > 0)
+                out << ";";
+            // Print the stage; if the cell is empty, print a single space.
+            if (next < offsets[i + 1] && static_cast<int>(cells[next].cycle) == j)
+                out << PipelineLog::cellText(cells[next++].stages);
+            else
+                out << " ";
+        }
+        out << std::endl;
+    }
+    if (issueWidth > 1) {
+        out << "issued:";
+        for (int j = 0; j < columns && j < static_cast<int>(issuedPerCycle.size()); ++j)
+            out << (j > 0 ? ";" : "") << static_cast<int>(issuedPerCycle[j]);
+        out << std::endl;
+    }
+}
+
+
+
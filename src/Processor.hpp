@@ -3,23 +3,66 @@
 
 #include <vector>
 #include <string>
+#include <iostream>
+#include <memory>
 #include "Instruction.hpp"
 #include "PipelineStage.hpp"
+#include "PipelineLog.hpp"
+#include "DataMemory.hpp"
+#include "Cache.hpp"
+#include "BranchPredictor.hpp"
+#include "Scoreboard.hpp"
+#include "PerfCounters.hpp"
+#include "TraceWriter.hpp"
+#include "Atomics.hpp"
+#include "FunctionalUnits.hpp"
+#include "CodeMap.hpp"
+#include "TextView.hpp"
+
+class CoherentMemory;
+
+// Why runUntilDrained() stopped.
+enum class StopReason { DRAINED, CYCLE_CAP, RETIRE_CAP };
 
 class Processor {
 public:
     uint32_t PC;
-    bool forwardingEnabled;
+    bool forwardingEnabled;   // Fixed at construction (selects the hazard policy).
+    unsigned issueWidth;      // Instructions fetched, decoded and issued per cycle (see setIssueWidth).
     bool stallIF = false;
     bool stallNeeded = false;
     int totalCycleCount;      // Total number of cycles (from input)
+    int logCycleCount;        // Cycles that get pipeline-table columns (defaults to totalCycleCount; 0 = no table)
     int currentCycle;         // Simulation cycle counter (full cycles)
+    int logStartCycle;        // Cycle of log column C1 (non-zero after a checkpoint restore)
+    uint64_t instructionsRetired; // Non-NOP instructions that reached write-back
+    uint64_t stallCycles;     // Cycles in which ID inserted a bubble for a data hazard
+    uint64_t flushedFetches;  // Fetches squashed by a branch, JAL or JALR resolved in ID
+    uint64_t cacheStallCycles; // Cycles the pipeline was frozen waiting on the I- or D-cache
+    uint64_t unitStallCycles;  // Cycles the pipeline was frozen waiting on a functional unit
+    PerfCounters counters;    // Stall causes, branch outcomes, retired loads/stores (see PerfCounters.hpp)
     bool headerPrinted;       // To print header only once
-    std::vector<std::string> asmInstructions;  // New vector for assembly statements
+    std::vector<TextView> asmInstructions;     // Assembly text per instruction (may be empty).
     std::vector<int> regs;  // 32 general-purpose registers.
-    std::vector<Instruction> instructionMemory;
+    std::vector<MicroOp> instructionMemory;     // Program, decoded once at load.
+    std::vector<TextView> instructionHex;      // Raw hex per instruction (printers and checkpoints only).
+    CodeMap code;             // Address of each instruction (16-bit compressed ones take 2 bytes).
+    uint32_t fetchBlock;      // Fetch-block width in bytes, 0 = unlimited (see setFetchBlock).
 
-    std::vector<uint8_t> stack_memory;
+    DataMemory stack_memory;  // Sparse paged data memory (full 32-bit address space).
+    Reservation reservation;  // LR.W reservation (see Atomics.hpp), unless memory is shared.
+    // Multicore: loads, stores and atomics go to this shared memory instead of
+    // stack_memory, and its coherence latency joins the D-side timing (not owned;
+    // nullptr = single core). hartId is this core's index in it.
+    CoherentMemory *shared;
+    unsigned hartId;
+    // L1 timing models for IF and MEM; both are disabled (single-cycle) unless configured.
+    Cache icache;
+    Cache dcache;
+    // Next-PC prediction in IF; disabled (every branch and jump flushes) unless configured.
+    BranchPredictor predictor;
+    // EX operation latencies and unit occupancy; single-cycle unless set with setUnitTiming.
+    FunctionalUnits units;
     
     // Pipeline latches.
     IF_ID_Latch if_id;
@@ -30,41 +73,147 @@ public:
     ID_EX_Latch next_id_ex;
     EX_MEM_Latch next_ex_mem;
     MEM_WB_Latch next_mem_wb;
+    // Second issue slot (dual issue only): the younger instruction of each
+    // pair travels through these alongside the latches above.
+    IF_ID_Latch if_id2;
+    ID_EX_Latch id_ex2;
+    EX_MEM_Latch ex_mem2;
+    MEM_WB_Latch mem_wb2;
+    IF_ID_Latch next_if_id2;
+    ID_EX_Latch next_id_ex2;
+    EX_MEM_Latch next_ex_mem2;
+    MEM_WB_Latch next_mem_wb2;
+    // Pending register writers of the current latches, for hazard detection and forwarding.
+    // Rebuilt whenever the latches change.
+    Scoreboard scoreboard;
 
-    // Pipeline log: one row per instruction; each row is a vector of strings (one cell per cycle)
-    std::vector<std::vector<std::string>> pipelineLog;
+    // Pipeline log: sparse (cycle, instruction, stage) records, rendered into
+    // one row per instruction by the print functions.
+    PipelineLog pipelineLog;
+    // Optional streaming trace of stage occupancy (not owned; nullptr = off).
+    TraceWriter *trace;
 
     // Constructor: loads instructions from hex strings and sets forwarding mode.
     Processor(const std::vector<std::string>& instructionsHex, bool forwarding, int totalCycleCount,const std::vector<std::string>& asmInstr);
+    // Same, for a program already decoded with decodeProgram() (shared across runs of one input).
+    Processor(const std::vector<MicroOp>& program, const std::vector<std::string>& instructionsHex, bool forwarding, int totalCycleCount,const std::vector<std::string>& asmInstr);
+    // Same, without copying the text: the views (e.g. a loaded ProgramFile's) must outlive the Processor.
+    Processor(const std::vector<MicroOp>& program, const std::vector<TextView>& instructionsHex, bool forwarding, int totalCycleCount, const std::vector<TextView>& asmInstr);
+    static std::vector<MicroOp> decodeProgram(const std::vector<std::string>& instructionsHex);
+
+    static const unsigned maxIssueWidth = 2;
+    // Selects single issue (1) or in-order dual issue (2). Dual issue fetches
+    // and decodes two instructions per cycle and issues the younger alongside
+    // the older unless it reads the older one's result, both need the memory
+    // port or the multiply/divide unit, or the older is a branch or jump.
+    // Only before the first cycle; returns false (and reports on std::cerr)
+    // for other widths.
+    bool setIssueWidth(unsigned width);
+    // Multi-cycle EX operations (see FunctionalUnits). Only before the first cycle.
+    void setUnitTiming(const UnitConfig &config);
+    // Fetch reads one aligned block of `bytes` per cycle and keeps the last
+    // block it read: an instruction that straddles two blocks takes an extra
+    // cycle (a bubble) unless its first block is the one kept, as it is in
+    // straight-line code, and with dual issue the second instruction must end
+    // in the same block as the first.
+    // 0 (the default) fetches any instruction in one cycle. Only before the
+    // first cycle; returns false (and reports on std::cerr) unless bytes is 0
+    // or a power of two from 4 to 64.
+    bool setFetchBlock(uint32_t bytes);
     
     // Resets the processor state.
-    uint8_t getRD(const Instruction &inst);
+    void flushPipeline();
+    // Takes over PC, registers and memory (e.g. from a FunctionalCore) with an empty pipeline.
+    void restoreArchState(uint32_t pc, const std::vector<int> &registers, const DataMemory &memory);
     // Runs one simulation cycle (calls all pipeline stages).
     void runCycle();
+    // True once PC is past the end of the program and all latches hold NOPs.
+    bool isDrained() const;
+    // Runs cycles until the pipeline drains or a cap is hit (0 = no cap).
+    // The cycle cap counts from logStartCycle and is also bounded by totalCycleCount.
+    StopReason runUntilDrained(int maxCycles, uint64_t maxRetired);
+    // Number of cycles that have log columns (cycles run since logStartCycle, up to logCycleCount).
+    int loggedCycles() const;
 
 
     // Helper functions for logging.
-    void logInstructionStage(const Instruction &instr, const std::string &stage);
+    void logInstructionStage(const MicroOp &instr, PipelineLog::Stage stage);
+    // Trace-only record of an instruction holding a stage while the table shows a stall.
+    void traceStage(const MicroOp &instr, PipelineLog::Stage stage);
     void printPipelineLogHeader() const;
     void printInstructionLog(int instrId) const;
 
 
 
 
-    // Pipeline stage functions.
+    // Pipeline stage functions. Stages that detect hazards or forward operands
+    // are instantiated per hazard policy (see HazardPolicy.hpp).
     void fetch(int cycle);
-    void decode(int cycle);
-    void execute(int cycle);
-    void memAccess(int cycle);
-    void writeBack(int cycle);
+    // EX, MEM and WB take the issue slot whose latches they work on (1 = the second).
+    template <class Policy> void decode(int cycle);
+    template <class Policy> void execute(int cycle, unsigned slot = 0);
+    template <class Policy> void memAccess(int cycle, unsigned slot = 0);
+    void writeBack(int cycle, unsigned slot = 0);
     void updateLatches();
+    // Squashes this cycle's fetch and restarts fetching at target (a branch or jump resolved in ID).
+    void redirectFetch(uint32_t target);
 
     // Helper function: prints the current state of the pipeline.
     void printPipelineState();
+    void printInstructionHex(const MicroOp &inst) const;
     void debug_print();
-    void print_registers();
-    void printFullPipelineLog() const;
-    void printFullPipelineLogSimple() const;
+    // The printers below write to std::cout unless given another sink.
+    void print_registers(std::ostream &out = std::cout);
+    void printFullPipelineLog(std::ostream &out = std::cout) const;
+    void printFullPipelineLogSimple(std::ostream &out = std::cout) const;
+
+private:
+    // Backs the text views when the Processor was given strings (shared by copies).
+    std::shared_ptr<const std::vector<std::string>> ownedText;
+    // runCycleWith<ForwardingPolicy> or runCycleWith<NoForwardingPolicy>, chosen by the constructor.
+    void (Processor::*cycleImpl)();
+    template <class Policy> void runCycleWith();
+    // Dual issue: runCycleDual<ForwardingPolicy> or runCycleDual<NoForwardingPolicy>.
+    template <class Policy> void runCycleDual();
+    template <class Policy> void decodeDual();
+    void fetchDual(bool firstIssued, bool secondIssued);
+    void updateLatchesDual();
+    // Register read and branch/jump resolution for an instruction leaving ID.
+    template <class Policy> void issue(const IF_ID_Latch &if_id, ID_EX_Latch &next_id_ex);
+    // Why the second slot cannot issue alongside the first (nullptr if it can).
+    template <class Policy> uint64_t *pairConflict(const MicroOp &older, const MicroOp &younger);
+
+    bool secondHeld;          // The first slot holds last cycle's second, which has logged its ID cycle.
+    std::vector<uint8_t> issuedPerCycle;   // Instructions issued in each logged cycle (dual issue).
+    void recordIssued(unsigned count);
+
+    // Cache timing. At the start of a cycle the fetch and the memory access
+    // that are about to happen are looked up once each; if either takes more
+    // than a cycle, every latch and the PC hold for the extra cycles.
+    uint32_t memoryStall;     // Frozen cycles still to go.
+    bool fetchTimed;          // The fetch at PC has been looked up in the I-cache.
+    bool dataTimed;           // The access in EX/MEM has been looked up in the D-cache.
+    // Multicore: the shared memory performs an access when it is timed (see
+    // CoherentMemory); this is what its load or atomic returned, for MEM.
+    uint32_t sharedValue;
+    template <class Policy>
+    uint32_t timeMemoryAccesses();
+
+    // True (and counts the cycle) if an operation about to enter EX finds its
+    // unit busy or an instruction about to write back is still waiting for its result.
+    bool unitStall();
+
+    uint32_t nextFetchPC;     // PC after this cycle's fetch, as chosen by the predictor.
+
+    // Fetch-block model (fetchBlock > 0).
+    bool fetchSplit;          // The first half of the instruction at PC, which straddles two blocks, has been read.
+    bool splitBubble;         // This cycle's fetch read that first half and delivered a bubble.
+    uint32_t lastBlock;       // Address of the block read last (re-reading it is free).
+    // Reads the blocks of the instruction at pc; true if only its first half could be read this cycle.
+    bool splitFetch(uint32_t pc, uint32_t size);
+    void readBlock(uint32_t block);
+    bool redirected;          // Decode pointed PC at a new path this cycle.
+    void freezeCycle();
 };
 
 #endif // PROCESSOR_HPP
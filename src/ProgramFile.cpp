@@ -0,0 +1,155 @@
+#include "ProgramFile.hpp"
+#include "Compressed.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Same set as std::isspace in the "C" locale, which the stream-based reader uses.
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    inline int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Like std::stoul(token, nullptr, 16): optional 0x prefix, then hex digits
+    // up to the first non-hex character. False if there are no digits.
+    bool parseHex(const char *p, const char *end, uint32_t &word) {
+        if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && hexDigit(p[2]) >= 0)
+            p += 2;
+        word = 0;
+        const char *start = p;
+        int digit;
+        while (p < end && (digit = hexDigit(*p)) >= 0) {
+            word = (word << 4) | digit;
+            ++p;
+        }
+        return p != start;
+    }
+}
+
+ProgramFile::ProgramFile() : map(nullptr), mapSize(0), seconds(0.0) {}
+
+ProgramFile::~ProgramFile() {
+    unmap();
+}
+
+void ProgramFile::unmap() {
+    if (map)
+        munmap(map, mapSize);
+    map = nullptr;
+    mapSize = 0;
+}
+
+bool ProgramFile::load(const std::string &filename) {
+    auto start = std::chrono::steady_clock::now();
+    unmap();
+    program.clear();
+    hex.clear();
+    labels.clear();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+    if (st.st_size > 0) {
+        void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error mapping file: " << filename << std::endl;
+            close(fd);
+            return false;
+        }
+        map = mapped;
+        mapSize = st.st_size;
+        madvise(map, mapSize, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    const char *p = static_cast<const char *>(map);
+    const char *end = p + mapSize;
+    // Roughly one instruction per 20 bytes in the usual "hex  asm" layout.
+    program.reserve(mapSize / 20 + 1);
+    hex.reserve(mapSize / 20 + 1);
+    labels.reserve(mapSize / 20 + 1);
+
+    size_t lineNumber = 0;
+    while (p < end) {
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!eol)
+            eol = end;
+        ++lineNumber;
+
+        const char *tokenStart = p;
+        while (tokenStart < eol && isSpace(*tokenStart))
+            ++tokenStart;
+        if (tokenStart < eol) {
+            const char *tokenEnd = tokenStart;
+            while (tokenEnd < eol && !isSpace(*tokenEnd))
+                ++tokenEnd;
+            const char *textStart = tokenEnd;
+            while (textStart < eol && isSpace(*textStart))
+                ++textStart;
+            const char *textEnd = eol;
+            while (textEnd > textStart && isSpace(textEnd[-1]))
+                --textEnd;
+
+            uint32_t word;
+            if (!parseHex(tokenStart, tokenEnd, word)) {
+                std::cerr << filename << ":" << lineNumber << ": expected a hex instruction word" << std::endl;
+                unmap();
+                program.clear();
+                hex.clear();
+                labels.clear();
+                return false;
+            }
+            if (Compressed::isHalfwordToken(tokenStart, tokenEnd))
+                program.push_back(MicroOp::fromCompressed(word, program.size()));
+            else
+                program.push_back(MicroOp::fromInstruction(Instruction(word), program.size()));
+            TextView token = {tokenStart, static_cast<uint32_t>(tokenEnd - tokenStart)};
+            TextView text = {textStart, static_cast<uint32_t>(textEnd - textStart)};
+            hex.push_back(token);
+            labels.push_back(text);
+        }
+        p = eol + 1;
+    }
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+std::vector<std::string> ProgramFile::hexStrings() const {
+    std::vector<std::string> strings;
+    strings.reserve(hex.size());
+    for (const auto &view : hex)
+        strings.push_back(view.str());
+    return strings;
+}
+
+std::vector<std::string> ProgramFile::labelStrings() const {
+    std::vector<std::string> strings;
+    strings.reserve(labels.size());
+    for (const auto &view : labels)
+        strings.push_back(view.str());
+    return strings;
+}
+
+double ProgramFile::throughputMBps() const {
+    return seconds > 0 ? mapSize / seconds / 1e6 : 0.0;
+}
@@ -0,0 +1,52 @@
+#ifndef PROGRAMFILE_HPP
+#define PROGRAMFILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MicroOp.hpp"
+#include "TextView.hpp"
+
+// Loads an input program in a single pass over a memory-mapped file: each
+// non-blank line is "<hex word> [assembly text]". The hex words are parsed
+// and decoded straight into MicroOps, and the hex and assembly text are kept
+// as views into the mapping (no per-line strings), so the file stays mapped
+// for the lifetime of the ProgramFile. A 4-digit hex word is a 16-bit RV32C
+// instruction (see Compressed), an 8-digit one a 32-bit instruction.
+//
+// Produces the same program, hex and assembly text as
+// Utils::readInstructionsFromFile / readAssemblyStatementsFromFile.
+class ProgramFile {
+public:
+    std::vector<MicroOp> program;   // Decoded instructions, id = index.
+    std::vector<TextView> hex;      // Hex token of each instruction.
+    std::vector<TextView> labels;   // Trimmed assembly text of each instruction (may be empty).
+
+    ProgramFile();
+    ~ProgramFile();
+    ProgramFile(const ProgramFile &) = delete;
+    ProgramFile &operator=(const ProgramFile &) = delete;
+
+    // Maps and parses the file. Returns false (and reports on std::cerr) if it
+    // cannot be read or a line does not start with a hex word.
+    bool load(const std::string &filename);
+
+    // Owned copies, for callers that outlive the ProgramFile. A Processor
+    // takes the views directly.
+    std::vector<std::string> hexStrings() const;
+    std::vector<std::string> labelStrings() const;
+
+    size_t bytes() const { return mapSize; }
+    double loadSeconds() const { return seconds; }
+    // Parse-and-decode throughput of the last load, in MB/s.
+    double throughputMBps() const;
+
+private:
+    void *map;
+    size_t mapSize;
+    double seconds;
+
+    void unmap();
+};
+
+#endif // PROGRAMFILE_HPP
@@ -0,0 +1,272 @@
+#include "ProgramGenerator.hpp"
+#include "Compressed.hpp"
+#include "Encode.hpp"
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    const uint8_t dataBase = 8, window = 9, firstCounter = 18;
+    const uint32_t dataAddress = 0x10000;
+    const uint32_t windowBytes = 2048;   // Reachable from x9 with a 12-bit offset.
+
+    const uint8_t working[ProgramGenerator::workingRegisters] = {
+        5, 6, 7, 10, 11, 12, 13, 14, 15, 16, 17, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+    };
+
+    using Encode::bType;
+    using Encode::iType;
+    using Encode::jType;
+    using Encode::rType;
+    using Encode::sType;
+    using Encode::uType;
+
+    std::string x(uint8_t reg) {
+        return "x" + std::to_string(reg);
+    }
+
+    struct AluOp {
+        const char *name;
+        bool immediate;
+        uint32_t funct7, funct3;
+    };
+    const AluOp aluOps[] = {
+        {"add", false, 0x00, 0}, {"sub", false, 0x20, 0}, {"sll", false, 0x00, 1}, {"srl", false, 0x00, 5},
+        {"sra", false, 0x20, 5}, {"mul", false, 0x01, 0}, {"addi", true, 0x00, 0}, {"slli", true, 0x00, 1},
+        {"srli", true, 0x00, 5}, {"srai", true, 0x20, 5},
+    };
+    const char *branchNames[8] = {"beq", "bne", nullptr, nullptr, "blt", "bge", "bltu", "bgeu"};
+    const uint32_t branchFunct3[] = {0, 1, 4, 5, 6, 7};
+}
+
+ProgramGenerator::ProgramGenerator(const GeneratorConfig &config)
+    : cfg(config), state(0), out(nullptr), nextDestination(0) {}
+
+bool ProgramGenerator::validate(const GeneratorConfig &config) {
+    if (config.aluWeight + config.memoryWeight + config.branchWeight + config.jumpWeight == 0) {
+        std::cerr << "Instruction mix weights must not all be zero" << std::endl;
+        return false;
+    }
+    if (config.dependencyDistance < 1 || config.dependencyDistance > workingRegisters) {
+        std::cerr << "Dependency distance must be between 1 and " << workingRegisters << std::endl;
+        return false;
+    }
+    if (config.loopDepth > maxLoopDepth) {
+        std::cerr << "Loop depth is limited to " << maxLoopDepth << std::endl;
+        return false;
+    }
+    if (config.iterations < 1 || config.iterations > 2047) {
+        std::cerr << "Loop iterations must be between 1 and 2047" << std::endl;
+        return false;
+    }
+    // Back-edges are B-type branches, which reach 1024 instructions back.
+    if (config.blockSize < 8 || config.blockSize > 1000) {
+        std::cerr << "Loop nest size must be between 8 and 1000 instructions" << std::endl;
+        return false;
+    }
+    if (config.footprint < 4 || config.footprint > (1u << 28)) {
+        std::cerr << "Memory footprint must be between 4 bytes and 256M" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint32_t ProgramGenerator::random(uint32_t bound) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<uint32_t>(((state * 0x2545F4914F6CDD1Dull) >> 32) % bound);
+}
+
+void ProgramGenerator::emit(uint32_t word, const std::string &assembly) {
+    out->hex.push_back(Encode::hex(word));
+    out->assembly.push_back(assembly);
+}
+
+// Working registers are written round-robin, so a register read d writes
+// later was produced d register-writing instructions earlier.
+uint8_t ProgramGenerator::destination() {
+    uint8_t reg = working[nextDestination];
+    nextDestination = (nextDestination + 1) % workingRegisters;
+    written.push_back(reg);
+    return reg;
+}
+
+uint8_t ProgramGenerator::source() {
+    return working[random(workingRegisters)];
+}
+
+uint8_t ProgramGenerator::dependentSource() {
+    if (written.size() < cfg.dependencyDistance)
+        return source();
+    return written[written.size() - cfg.dependencyDistance];
+}
+
+GeneratedProgram ProgramGenerator::generate() {
+    GeneratedProgram program;
+    out = &program;
+    // splitmix64, so that nearby seeds give unrelated streams.
+    state = cfg.seed + 0x9E3779B97F4A7C15ull;
+    state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ull;
+    state = (state ^ (state >> 27)) * 0x94D049BB133111EBull;
+    state ^= state >> 31;
+    if (state == 0)
+        state = 1;
+    written.clear();
+    nextDestination = 0;
+    program.hex.reserve(cfg.instructions);
+    program.assembly.reserve(cfg.instructions);
+
+    // Prologue: data base, first window, and a distinct value in every working register.
+    uint32_t prologue = 2 + workingRegisters;
+    if (cfg.instructions >= prologue) {
+        emit(uType(dataAddress >> 12, dataBase), "lui " + x(dataBase) + " " + std::to_string(dataAddress >> 12));
+        emit(iType(0x13, 0, dataBase, 0, window), "addi " + x(window) + " " + x(dataBase) + " 0");
+        for (uint32_t i = 0; i < workingRegisters; ++i) {
+            int32_t value = static_cast<int32_t>(random(4096)) - 2048;
+            emit(iType(0x13, value, 0, 0, working[i]), "addi " + x(working[i]) + " x0 " + std::to_string(value));
+        }
+    }
+    while (program.hex.size() < cfg.instructions) {
+        uint32_t left = cfg.instructions - program.hex.size();
+        emitNest(0, left < cfg.blockSize ? left : cfg.blockSize);
+    }
+    out = nullptr;
+    if (cfg.compressed)
+        compress(program);
+    return program;
+}
+
+// The generator only writes PC-relative branches and jumps whose assembly
+// ends with the offset, so targets are read back from the text.
+void ProgramGenerator::compress(GeneratedProgram &program) {
+    size_t n = program.hex.size();
+    std::vector<uint32_t> words(n);
+    for (size_t i = 0; i < n; ++i)
+        words[i] = std::stoul(program.hex[i], nullptr, 16);
+    std::vector<uint8_t> sizes;
+    std::vector<uint32_t> encoded = Compressed::compressProgram(words, sizes);
+    std::vector<uint32_t> address(n + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+        address[i + 1] = address[i] + sizes[i];
+
+    for (size_t i = 0; i < n; ++i) {
+        std::string &text = program.assembly[i];
+        uint32_t opcode = words[i] & 0x7F;
+        if (opcode == 0x63 || opcode == 0x6F) {
+            size_t space = text.find_last_of(' ');
+            size_t target = i + std::stoi(text.substr(space + 1)) / 4;
+            text = text.substr(0, space + 1) +
+                   std::to_string(static_cast<int32_t>(address[target] - address[i]));
+        }
+        char hex[9];
+        snprintf(hex, sizeof(hex), sizes[i] == 2 ? "%04x" : "%08x", encoded[i]);
+        program.hex[i] = hex;
+        if (sizes[i] == 2)
+            text = "c." + text;
+    }
+}
+
+void ProgramGenerator::write(const GeneratedProgram &program, std::ostream &stream) {
+    for (size_t i = 0; i < program.hex.size(); ++i)
+        stream << program.hex[i] << "    " << program.assembly[i] << '\n';
+}
+
+// A loop nest of exactly `budget` instructions. Each level spends 3 on its
+// counter (set, decrement, back-edge) and a quarter of the rest on either
+// side of the next level.
+void ProgramGenerator::emitNest(uint32_t level, uint32_t budget) {
+    if (level == 0 && cfg.footprint > windowBytes && budget >= 3 + 8) {
+        emitWindow();
+        budget -= 3;
+    }
+    if (level == cfg.loopDepth || budget < 3 + 4) {
+        emitBody(budget);
+        return;
+    }
+    uint8_t counter = firstCounter + level;
+    uint32_t inner = budget - 3;
+    uint32_t before = inner / 4, nested = inner / 2, after = inner - before - nested;
+
+    emit(iType(0x13, cfg.iterations, 0, 0, counter),
+         "addi " + x(counter) + " x0 " + std::to_string(cfg.iterations));
+    size_t top = out->hex.size();
+    emitBody(before);
+    emitNest(level + 1, nested);
+    emitBody(after);
+    emit(iType(0x13, -1, counter, 0, counter), "addi " + x(counter) + " " + x(counter) + " -1");
+    int32_t back = -4 * static_cast<int32_t>(out->hex.size() - top);
+    emit(bType(back, 0, counter, 1), "bne " + x(counter) + " x0 " + std::to_string(back));
+}
+
+void ProgramGenerator::emitBody(uint32_t count) {
+    uint32_t total = cfg.aluWeight + cfg.memoryWeight + cfg.branchWeight + cfg.jumpWeight;
+    for (uint32_t left = count; left > 0; --left) {
+        uint32_t pick = random(total);
+        if (pick < cfg.aluWeight) {
+            emitAlu();
+            continue;
+        }
+        pick -= cfg.aluWeight;
+        if (pick < cfg.memoryWeight) {
+            emitMemory();
+            continue;
+        }
+        pick -= cfg.memoryWeight;
+        // Branches and jumps skip 1-3 instructions forward, never past the body.
+        uint32_t skip = 1 + random(3);
+        if (skip >= left) {
+            emitAlu();
+            continue;
+        }
+        int32_t offset = 4 * static_cast<int32_t>(skip + 1);
+        if (pick < cfg.branchWeight) {
+            uint32_t f3 = branchFunct3[random(6)];
+            uint8_t rs1 = dependentSource(), rs2 = source();
+            emit(bType(offset, rs2, rs1, f3),
+                 std::string(branchNames[f3]) + " " + x(rs1) + " " + x(rs2) + " " + std::to_string(offset));
+        } else {
+            emit(jType(offset, 0), "jal x0 " + std::to_string(offset));
+        }
+    }
+}
+
+void ProgramGenerator::emitAlu() {
+    const AluOp &op = aluOps[random(sizeof(aluOps) / sizeof(aluOps[0]))];
+    uint8_t rs1 = dependentSource();
+    if (op.immediate) {
+        bool shift = op.funct3 != 0;
+        int32_t imm = shift ? random(32) : static_cast<int32_t>(random(4096)) - 2048;
+        uint8_t rd = destination();
+        emit(iType(0x13, shift ? (op.funct7 << 5) | imm : imm, rs1, op.funct3, rd),
+             std::string(op.name) + " " + x(rd) + " " + x(rs1) + " " + std::to_string(imm));
+    } else {
+        uint8_t rs2 = source();
+        uint8_t rd = destination();
+        emit(rType(op.funct7, rs2, rs1, op.funct3, rd),
+             std::string(op.name) + " " + x(rd) + " " + x(rs1) + " " + x(rs2));
+    }
+}
+
+// Word loads and stores within the current window; three in five are loads.
+void ProgramGenerator::emitMemory() {
+    uint32_t span = cfg.footprint < windowBytes ? cfg.footprint : windowBytes;
+    int32_t offset = 4 * random(span / 4 > 0 ? span / 4 : 1);
+    if (random(5) < 3) {
+        uint8_t rd = destination();
+        emit(iType(0x03, offset, window, 2, rd), "lw " + x(rd) + " " + std::to_string(offset) + " " + x(window));
+    } else {
+        uint8_t rs2 = dependentSource();
+        emit(sType(offset, rs2, window, 2), "sw " + x(rs2) + " " + std::to_string(offset) + " " + x(window));
+    }
+}
+
+// Moves x9 to a random window-aligned spot of the footprint (3 instructions).
+void ProgramGenerator::emitWindow() {
+    uint32_t windows = cfg.footprint / windowBytes;
+    uint32_t start = random(windows) * windowBytes;
+    uint32_t upper = (start + 0x800) >> 12;
+    int32_t lower = static_cast<int32_t>(start << 20) >> 20;
+    emit(uType(upper, window), "lui " + x(window) + " " + std::to_string(upper));
+    emit(iType(0x13, lower, window, 0, window), "addi " + x(window) + " " + x(window) + " " + std::to_string(lower));
+    emit(rType(0, dataBase, window, 0, window), "add " + x(window) + " " + x(window) + " " + x(dataBase));
+}
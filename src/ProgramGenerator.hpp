@@ -0,0 +1,80 @@
+#ifndef PROGRAMGENERATOR_HPP
+#define PROGRAMGENERATOR_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct GeneratorConfig {
+    uint64_t seed = 1;
+    uint32_t instructions = 1000;   // Static program size.
+    // Relative weights of the instruction classes in loop bodies.
+    uint32_t aluWeight = 60, memoryWeight = 25, branchWeight = 10, jumpWeight = 5;
+    uint32_t dependencyDistance = 3;   // A result is read again this many instructions later (1 = back-to-back).
+    uint32_t loopDepth = 2;            // Nesting of each loop nest (0 = straight-line code).
+    uint32_t iterations = 4;           // Trip count of every loop.
+    uint32_t blockSize = 64;           // Static size of one loop nest.
+    uint32_t footprint = 4096;         // Bytes of data memory the loads and stores touch.
+    bool compressed = false;           // Encode every instruction that has an RV32C form in 16 bits.
+};
+
+// A generated program, one entry per instruction.
+struct GeneratedProgram {
+    std::vector<std::string> hex;
+    std::vector<std::string> assembly;
+};
+
+// Deterministic synthetic workloads: the same config and seed always give
+// the same program. The program is a sequence of loop nests of blockSize
+// instructions; loop bodies draw ALU, load/store, forward branch and forward
+// jump instructions from the configured mix. Only loop back-edges go
+// backwards and every loop counts down from `iterations`, so every program
+// terminates by falling off its end; the innermost body of each nest runs
+// iterations^loopDepth times.
+//
+// With `compressed`, the same program is re-encoded afterwards with every
+// instruction that has a 16-bit RV32C form compressed (4 hex digits, and a
+// "c." prefix on the assembly) and the branch and jump offsets moved to the
+// new layout. Note that LUI reads the PC in this simulator, so the data
+// windows of a compressed program sit at slightly different addresses.
+//
+// Register use: x8 is the data base, x9 the current data window, x18..x21
+// the loop counters, and the rest of x5..x31 are the working set. Footprints
+// over 2K move x9 to a random 2K window at the start of each nest.
+class ProgramGenerator {
+public:
+    static const uint32_t maxLoopDepth = 4;
+    static const uint32_t workingRegisters = 21;
+
+    explicit ProgramGenerator(const GeneratorConfig &config);
+
+    // Checks the config. Returns false and reports on std::cerr if it is invalid.
+    static bool validate(const GeneratorConfig &config);
+
+    GeneratedProgram generate();
+    // Writes the program in the inputfiles format ("<hex>    <assembly>" per line).
+    static void write(const GeneratedProgram &program, std::ostream &out);
+
+private:
+    GeneratorConfig cfg;
+    uint64_t state;                   // xorshift64* state.
+    GeneratedProgram *out;
+    std::vector<uint8_t> written;     // Destination of every register-writing instruction so far.
+    uint32_t nextDestination;
+
+    uint32_t random(uint32_t bound);
+    void emit(uint32_t word, const std::string &assembly);
+    uint8_t destination();
+    uint8_t source();
+    uint8_t dependentSource();
+
+    void emitNest(uint32_t level, uint32_t budget);
+    void emitBody(uint32_t count);
+    void emitAlu();
+    void emitMemory();
+    void emitWindow();
+    static void compress(GeneratedProgram &program);
+};
+
+#endif // PROGRAMGENERATOR_HPP
@@ -0,0 +1,120 @@
+#include "Sampler.hpp"
+#include "Processor.hpp"
+#include "FunctionalCore.hpp"
+#include <cmath>
+
+namespace {
+    // Two-sided 95% critical values of Student's t for 1..30 degrees of freedom.
+    const double tTable[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+
+    double criticalValue(size_t degreesOfFreedom) {
+        if (degreesOfFreedom == 0)
+            return 0.0;
+        if (degreesOfFreedom <= 30)
+            return tTable[degreesOfFreedom - 1];
+        return 1.96;
+    }
+}
+
+Sampler::Sampler(Processor &cpu, const SamplingConfig &config)
+    : cpu(cpu), config(config) {}
+
+Estimate Sampler::estimate(const std::vector<double> &values) {
+    Estimate e = {0.0, 0.0};
+    if (values.empty())
+        return e;
+    for (double v : values)
+        e.mean += v;
+    e.mean /= values.size();
+    if (values.size() < 2)
+        return e;
+    double var = 0.0;
+    for (double v : values)
+        var += (v - e.mean) * (v - e.mean);
+    var /= values.size() - 1;
+    e.halfWidth = criticalValue(values.size() - 1) * std::sqrt(var / values.size());
+    return e;
+}
+
+bool Sampler::runDetailedUntil(uint64_t count) {
+    // A window can never need more than a few cycles per instruction; the
+    // bound only protects against a pipeline that stops retiring.
+    uint64_t cycleBudget = 64 * (count + 16);
+    uint64_t cycles = 0;
+    while (cpu.instructionsRetired < count) {
+        if (cpu.isDrained() || cycles++ >= cycleBudget)
+            return false;
+        cpu.runCycle();
+    }
+    return true;
+}
+
+SamplingReport Sampler::run() {
+    SamplingReport report;
+    report.instructions = 0;
+    report.suggestedSamples = 0;
+
+    // The detailed model only measures; it never logs.
+    cpu.logCycleCount = 0;
+
+    FunctionalCore core(cpu.instructionMemory);
+    uint64_t limit = config.maxInstructions;
+    uint64_t period = config.period > config.warmup + config.measure ? config.period
+                                                                     : config.warmup + config.measure;
+
+    while (!core.finished() && (limit == 0 || core.instructionsExecuted < limit)) {
+        // Detailed window starting at the functional core's current state.
+        core.handOff(cpu);
+        cpu.instructionsRetired = 0;
+        cpu.stallCycles = 0;
+        cpu.flushedFetches = 0;
+        cpu.cacheStallCycles = 0;
+        cpu.unitStallCycles = 0;
+        cpu.counters = PerfCounters();
+        cpu.logStartCycle = cpu.currentCycle;
+
+        if (runDetailedUntil(config.warmup)) {
+            int startCycle = cpu.currentCycle;
+            uint64_t startStalls = cpu.stallCycles;
+            uint64_t startFlushes = cpu.flushedFetches;
+            if (runDetailedUntil(config.warmup + config.measure)) {
+                double cycles = cpu.currentCycle - startCycle;
+                Sample sample;
+                sample.startInstruction = core.instructionsExecuted;
+                sample.cpi = cycles / config.measure;
+                sample.stallRate = (cpu.stallCycles - startStalls) / cycles;
+                sample.flushRate = (cpu.flushedFetches - startFlushes) / cycles;
+                report.samples.push_back(sample);
+            }
+        }
+
+        // Functional execution covers the window and the gap to the next sample.
+        uint64_t step = period;
+        if (limit != 0 && limit - core.instructionsExecuted < step)
+            step = limit - core.instructionsExecuted;
+        core.run(step);
+    }
+    report.instructions = core.instructionsExecuted;
+
+    std::vector<double> cpi, stalls, flushes;
+    for (const auto &s : report.samples) {
+        cpi.push_back(s.cpi);
+        stalls.push_back(s.stallRate);
+        flushes.push_back(s.flushRate);
+    }
+    report.cpi = estimate(cpi);
+    report.stallRate = estimate(stalls);
+    report.flushRate = estimate(flushes);
+
+    // SMARTS sample-size rule: n >= (z * V / e)^2, V = coefficient of variation.
+    if (cpi.size() >= 2 && report.cpi.mean > 0 && config.targetError > 0) {
+        double sd = report.cpi.halfWidth / criticalValue(cpi.size() - 1) * std::sqrt((double)cpi.size());
+        double v = sd / report.cpi.mean;
+        report.suggestedSamples = static_cast<uint64_t>(std::ceil(std::pow(1.96 * v / config.targetError, 2)));
+    }
+    return report;
+}
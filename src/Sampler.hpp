@@ -0,0 +1,70 @@
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+#include <cstdint>
+#include <vector>
+
+class Processor;
+
+// Parameters of a SMARTS-style sampled run. Every `period` instructions the
+// functional core hands its state to the pipeline, which runs `warmup`
+// instructions in detail to fill the pipeline and then measures the next
+// `measure` instructions. Everything in between is executed functionally.
+struct SamplingConfig {
+    uint64_t period;            // Instructions from one sample start to the next.
+    uint64_t warmup;            // Detailed instructions before measuring.
+    uint64_t measure;           // Detailed instructions measured per sample.
+    uint64_t maxInstructions;   // Stop after this many instructions (0 = run to the end).
+    double targetError;         // Relative CPI error used to suggest a sample count.
+
+    SamplingConfig() : period(10000), warmup(200), measure(1000), maxInstructions(0), targetError(0.03) {}
+};
+
+// One measured window.
+struct Sample {
+    uint64_t startInstruction;  // Instruction count at which the window was handed over.
+    double cpi;
+    double stallRate;           // Hazard bubbles per measured cycle.
+    double flushRate;           // Squashed fetches per measured cycle.
+};
+
+// Mean and 95% confidence half-width of a per-sample metric.
+struct Estimate {
+    double mean;
+    double halfWidth;
+};
+
+struct SamplingReport {
+    std::vector<Sample> samples;
+    uint64_t instructions;      // Instructions executed in total.
+    Estimate cpi;
+    Estimate stallRate;
+    Estimate flushRate;
+    uint64_t suggestedSamples;  // Samples needed for +/- targetError on CPI (0 if unknown).
+
+    // Relative CPI error bound at 95% confidence.
+    double relativeError() const { return cpi.mean > 0 ? cpi.halfWidth / cpi.mean : 0.0; }
+};
+
+class Sampler {
+public:
+    // The processor provides the program and the forwarding mode; its
+    // architectural state is overwritten and its log is not used. It must be
+    // the plain pipeline: nothing warms caches or a predictor between
+    // windows, so their state would be stale (main rejects those options).
+    Sampler(Processor &cpu, const SamplingConfig &config);
+
+    SamplingReport run();
+
+    // Mean and 95% confidence half-width (Student's t) of a set of values.
+    static Estimate estimate(const std::vector<double> &values);
+
+private:
+    Processor &cpu;
+    SamplingConfig config;
+
+    // Runs the pipeline until `count` instructions have retired since the hand-over.
+    bool runDetailedUntil(uint64_t count);
+};
+
+#endif // SAMPLER_HPP
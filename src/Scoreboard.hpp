@@ -0,0 +1,103 @@
+#ifndef SCOREBOARD_HPP
+#define SCOREBOARD_HPP
+
+#include <cstdint>
+#include "PipelineStage.hpp"
+#include "FunctionalUnits.hpp"
+
+// Register scoreboard: which in-flight instructions will write which
+// registers, in which stage they are, and whether their values can be
+// forwarded or are in the register file in time (the unforwardable and
+// unwritten masks, from each writer's latency). It is rebuilt from the
+// ID/EX, EX/MEM and MEM/WB latches whenever they move, so hazard detection
+// and forwarding in the stages are single bit tests against the masks below
+// instead of comparisons against every latch.
+//
+// Everything is relative to the current cycle, so a cycle in which the
+// latches hold (a cache stall) leaves the scoreboard unchanged. Register bits
+// never include x0.
+//
+// Multi-cycle operations (see FunctionalUnits) forward after their own
+// latency, taken from opLatency. A writer that has reached WB is always
+// complete: the Processor does not let a result write back before it is ready.
+//
+// With dual issue both slots of a stage count as that stage's writers, and
+// `second` tells which of them come from the second (younger) slot, so
+// forwarding can prefer the younger value of a pair.
+class Scoreboard {
+public:
+    // Stage that holds a writer (EX = in the ID/EX latch, and so on).
+    enum Stage : uint8_t { EX, MEM, WB };
+
+    // Cycles from entering EX until the result can be forwarded.
+    static const int aluLatency = 1;
+    static const int loadLatency = 2;
+    // Latency per ALUOp of the operations FunctionalUnits times (nullptr = all aluLatency).
+    const uint32_t *opLatency;
+
+    uint32_t writers[3];         // Bit r: an instruction in that stage writes xr.
+    uint32_t exLoads;            // EX writers that are loads (their data is not ready until MEM).
+    // Registers a pending writer cannot forward within d cycles: d = 0 for
+    // operands read in ID this cycle, d = 1 for operands needed in EX next cycle.
+    uint32_t unforwardable[2];
+    uint32_t unwritten;          // Registers not in the register file by ID this cycle.
+    uint32_t second[3];          // Writers in the second issue slot, per stage (0 with single issue).
+    int latency[2][2];           // Latency of the EX and MEM writers, per slot.
+
+    Scoreboard() : opLatency(nullptr), writers(), exLoads(0), unforwardable(), unwritten(0), second(), latency() {}
+
+    static uint32_t bit(uint8_t reg) { return (1u << reg) & ~1u; }
+    static uint32_t sources(const MicroOp &inst) { return bit(inst.rs1) | bit(inst.rs2); }
+
+    void update(const ID_EX_Latch &id_ex, const EX_MEM_Latch &ex_mem, const MEM_WB_Latch &mem_wb) {
+        writers[EX] = id_ex.regWrite ? bit(id_ex.instruction.rd) : 0;
+        writers[MEM] = ex_mem.regWrite ? bit(ex_mem.instruction.rd) : 0;
+        writers[WB] = mem_wb.regWrite ? bit(mem_wb.instruction.rd) : 0;
+        exLoads = id_ex.memRead ? writers[EX] : 0;
+        second[EX] = second[MEM] = second[WB] = 0;
+        latency[EX][0] = latencyOf(id_ex);
+        latency[MEM][0] = latencyOf(ex_mem);
+        derive();
+    }
+
+    // Dual issue: the same from both slots' latches (the second ones hold the younger instructions).
+    void update(const ID_EX_Latch &id_ex, const EX_MEM_Latch &ex_mem, const MEM_WB_Latch &mem_wb,
+                const ID_EX_Latch &id_ex2, const EX_MEM_Latch &ex_mem2, const MEM_WB_Latch &mem_wb2) {
+        update(id_ex, ex_mem, mem_wb);
+        second[EX] = id_ex2.regWrite ? bit(id_ex2.instruction.rd) : 0;
+        second[MEM] = ex_mem2.regWrite ? bit(ex_mem2.instruction.rd) : 0;
+        second[WB] = mem_wb2.regWrite ? bit(mem_wb2.instruction.rd) : 0;
+        exLoads |= id_ex2.memRead ? second[EX] : 0;
+        latency[EX][1] = latencyOf(id_ex2);
+        latency[MEM][1] = latencyOf(ex_mem2);
+        for (int stage = EX; stage <= WB; ++stage)
+            writers[stage] |= second[stage];
+        derive();
+    }
+
+private:
+    void derive() {
+        for (int d = 0; d < 2; ++d)
+            unforwardable[d] = blockedFor(EX, d) | blockedFor(MEM, d);
+        unwritten = writers[EX] | writers[MEM];   // WB writes in the first half, before ID reads.
+    }
+    template <class Latch>
+    int latencyOf(const Latch &latch) const {
+        if (latch.memRead)
+            return loadLatency;
+        if (opLatency && FunctionalUnits::usesUnit(latch.instruction))
+            return opLatency[static_cast<int>(latch.instruction.aluOp)];
+        return aluLatency;
+    }
+    static int remaining(Stage stage, int latency) {
+        int left = latency - (stage - EX);
+        return left > 0 ? left : 0;
+    }
+    // A second-slot writer of a register hides the first slot's.
+    uint32_t blockedFor(Stage stage, int d) const {
+        return (remaining(stage, latency[stage][0]) > d ? writers[stage] & ~second[stage] : 0) |
+               (remaining(stage, latency[stage][1]) > d ? second[stage] : 0);
+    }
+};
+
+#endif // SCOREBOARD_HPP
@@ -0,0 +1,28 @@
+#ifndef TEXTVIEW_HPP
+#define TEXTVIEW_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A read-only slice of text owned elsewhere (e.g. the mapped input file).
+struct TextView {
+    const char *data;
+    uint32_t size;
+
+    std::string str() const { return std::string(data, size); }
+    bool empty() const { return size == 0; }
+
+    // Views of the strings, which must outlive them.
+    static std::vector<TextView> of(const std::vector<std::string> &strings) {
+        std::vector<TextView> views;
+        views.reserve(strings.size());
+        for (const std::string &s : strings) {
+            TextView view = {s.data(), static_cast<uint32_t>(s.size())};
+            views.push_back(view);
+        }
+        return views;
+    }
+};
+
+#endif // TEXTVIEW_HPP
@@ -0,0 +1,91 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned threads)
+    : queued(0), pending(0), nextQueue(0), stopping(false) {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; ++i)
+        queues.emplace_back(new Queue());
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned target;
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        ++queued;
+        ++pending;
+        target = nextQueue;
+        nextQueue = (nextQueue + 1) % queues.size();
+    }
+    {
+        std::lock_guard<std::mutex> guard(queues[target]->lock);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> guard(stateLock);
+    idle.wait(guard, [this] { return pending == 0; });
+}
+
+// Own deque from the back first, then the front of every other deque.
+bool ThreadPool::take(unsigned self, std::function<void()> &task) {
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Queue &victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned self) {
+    std::function<void()> task;
+    for (;;) {
+        if (take(self, task)) {
+            {
+                std::lock_guard<std::mutex> guard(stateLock);
+                --queued;
+            }
+            task();
+            task = nullptr;
+            std::lock_guard<std::mutex> guard(stateLock);
+            if (--pending == 0)
+                idle.notify_all();
+            continue;
+        }
+        // A task counted in `queued` may not be in its deque yet; the wait
+        // below then returns immediately and the loop simply tries again.
+        std::unique_lock<std::mutex> guard(stateLock);
+        if (stopping && queued == 0)
+            return;
+        wake.wait(guard, [this] { return stopping || queued > 0; });
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size work-stealing pool. Each worker owns a deque: submitted tasks are
+// dealt round-robin, a worker runs its own tasks newest-first and, when it
+// runs dry, steals the oldest task of another worker. Long and short jobs
+// therefore even out without a single shared queue becoming the bottleneck.
+class ThreadPool {
+public:
+    // threads == 0 uses one worker per hardware thread.
+    explicit ThreadPool(unsigned threads = 0);
+    // Finishes every submitted task, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task);
+    // Blocks until every task submitted so far has finished.
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateLock;
+    std::condition_variable wake;   // Signalled when work arrives or on shutdown.
+    std::condition_variable idle;   // Signalled when pending drops to zero.
+    size_t queued;                  // Tasks submitted but not yet taken by a worker.
+    size_t pending;                 // Tasks submitted but not yet finished.
+    unsigned nextQueue;
+    bool stopping;
+
+    bool take(unsigned self, std::function<void()> &task);
+    void workerLoop(unsigned self);
+};
+
+#endif // THREADPOOL_HPP
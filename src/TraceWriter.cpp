@@ -0,0 +1,117 @@
+#include "TraceWriter.hpp"
+#include <iostream>
+
+namespace {
+    const char *trackNames[] = {"IF", "ID", "EX", "MEM", "WB"};
+
+    std::string escape(const std::string &text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20)
+                escaped += c;
+        }
+        return escaped;
+    }
+}
+
+TraceWriter::TraceWriter() : events(0) {
+    for (auto &slice : current)
+        slice.instrId = -1;
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+int TraceWriter::track(PipelineLog::Stage stage) {
+    switch (stage) {
+        case PipelineLog::IF: return 0;
+        case PipelineLog::ID: return 1;
+        case PipelineLog::EX: return 2;
+        case PipelineLog::MEM: return 3;
+        case PipelineLog::WB: return 4;
+        default: return -1;
+    }
+}
+
+bool TraceWriter::open(const std::string &filename, const std::vector<TextView> &labels, const CodeMap &layout) {
+    close();
+    out.open(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error opening trace file: " << filename << std::endl;
+        return false;
+    }
+    names.clear();
+    code = layout;
+    for (size_t i = 0; i < labels.size(); ++i)
+        names.push_back(labels[i].empty() ? "I" + std::to_string(i + 1) : escape(labels[i].str()));
+    events = 0;
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    out << "{\"ph\": \"M\", \"pid\": 1, \"name\": \"process_name\", \"args\": {\"name\": \"pipeline\"}}";
+    // Tracks are listed in pipeline order rather than by name.
+    for (int t = 0; t < stageCount; ++t) {
+        out << ",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": " << t + 1 << ", \"name\": \"thread_name\", \"args\": {\"name\": \""
+            << trackNames[t] << "\"}},\n{\"ph\": \"M\", \"pid\": 1, \"tid\": " << t + 1
+            << ", \"name\": \"thread_sort_index\", \"args\": {\"sort_index\": " << t << "}}";
+    }
+    return true;
+}
+
+void TraceWriter::beginEvent() {
+    out << ",\n";
+    events++;
+}
+
+void TraceWriter::flushSlice(int t) {
+    Slice &slice = current[t];
+    if (slice.instrId < 0)
+        return;
+    beginEvent();
+    out << "{\"ph\": \"X\", \"pid\": 1, \"tid\": " << t + 1 << ", \"ts\": " << slice.start
+        << ", \"dur\": " << slice.end - slice.start << ", \"name\": \"";
+    if (static_cast<size_t>(slice.instrId) < names.size())
+        out << names[slice.instrId];
+    else
+        out << "I" << slice.instrId + 1;
+    uint32_t pc = static_cast<uint32_t>(slice.instrId) < code.instructions() ? code.addressOf(slice.instrId)
+                                                                             : slice.instrId * 4;
+    out << "\", \"args\": {\"pc\": " << pc << "}}";
+    slice.instrId = -1;
+}
+
+void TraceWriter::occupy(PipelineLog::Stage stage, int instrId, uint64_t cycle) {
+    int t = track(stage);
+    if (t < 0 || !out.is_open())
+        return;
+    Slice &slice = current[t];
+    if (slice.instrId == instrId && slice.end >= cycle) {
+        if (slice.end == cycle)
+            slice.end = cycle + 1;
+        return;
+    }
+    flushSlice(t);
+    slice.instrId = instrId;
+    slice.start = cycle;
+    slice.end = cycle + 1;
+}
+
+void TraceWriter::instant(PipelineLog::Stage stage, const char *name, uint64_t cycle) {
+    int t = track(stage);
+    if (t < 0 || !out.is_open())
+        return;
+    beginEvent();
+    out << "{\"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": " << t + 1 << ", \"ts\": " << cycle
+        << ", \"name\": \"" << name << "\"}";
+}
+
+void TraceWriter::close() {
+    if (!out.is_open())
+        return;
+    for (int t = 0; t < stageCount; ++t)
+        flushSlice(t);
+    out << "\n]}\n";
+    out.close();
+}
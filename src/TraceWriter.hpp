@@ -0,0 +1,64 @@
+#ifndef TRACEWRITER_HPP
+#define TRACEWRITER_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "PipelineLog.hpp"
+#include "CodeMap.hpp"
+#include "TextView.hpp"
+
+// Streams pipeline occupancy to a Chrome trace-event JSON file, which
+// chrome://tracing and the Perfetto UI open directly. Each pipeline stage is
+// one track (a "thread" of a single "process"), and each stay of an
+// instruction in a stage is one slice, one microsecond per cycle. Stalls,
+// flushes and cache freezes are instant events on the track where they
+// happen.
+//
+// Only the open slice of each stage is kept in memory: a slice is written
+// as soon as a different instruction takes its stage (or a cycle is skipped),
+// so arbitrarily long runs trace in constant memory.
+class TraceWriter {
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    // Starts a trace; labels name the instructions (empty entries become
+    // "I<n>") and code gives their addresses (4 bytes each if left out).
+    // Returns false (and reports on std::cerr) if the file cannot be opened.
+    bool open(const std::string &filename, const std::vector<TextView> &labels, const CodeMap &code = CodeMap());
+    // Records that the instruction occupies stage in cycle. STALL is ignored.
+    void occupy(PipelineLog::Stage stage, int instrId, uint64_t cycle);
+    // An instant event on the stage's track.
+    void instant(PipelineLog::Stage stage, const char *name, uint64_t cycle);
+    // Writes the open slices and terminates the JSON. Called by the destructor too.
+    void close();
+
+    bool isOpen() const { return out.is_open(); }
+    uint64_t eventCount() const { return events; }
+
+private:
+    static const int stageCount = 5;
+
+    struct Slice {
+        int instrId;      // -1 when the stage has no open slice.
+        uint64_t start;
+        uint64_t end;     // One past the last cycle.
+    };
+
+    std::ofstream out;
+    std::vector<std::string> names;   // JSON-escaped instruction names.
+    CodeMap code;
+    Slice current[stageCount];
+    uint64_t events;
+
+    static int track(PipelineLog::Stage stage);
+    void beginEvent();
+    void flushSlice(int track);
+};
+
+#endif // TRACEWRITER_HPP
@@ -0,0 +1,91 @@
+// batch.cpp
+// Runs many (input file, forwarding mode, cycle count) simulations in one
+// process on a work-stealing thread pool and prints a timing summary.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/stat.h>
+#include "BatchRunner.hpp"
+
+// "../inputfiles/tc_1.txt" -> "tc_1"
+static std::string stem(const std::string &path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return (dot == std::string::npos) ? name : name.substr(0, dot);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <job_file> [--threads N] [--output-dir DIR]" << std::endl;
+        std::cerr << "Each job line: <input_file> <forward|noforward> <cycles [table_cycles]|drain [max_cycles [table_cycles]]>"
+                  << std::endl;
+        return 1;
+    }
+
+    std::string jobFile = argv[1];
+    unsigned threads = 0;
+    std::string outputDir = "../outputfiles/batch";
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (arg == "--output-dir" && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BatchJob> jobs;
+    if (!readBatchJobs(jobFile, jobs))
+        return 1;
+    if (jobs.empty()) {
+        std::cerr << "No jobs in " << jobFile << std::endl;
+        return 1;
+    }
+    mkdir(outputDir.c_str(), 0755);  // Fine if it already exists.
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        BatchJob &job = jobs[i];
+        job.outputFile = outputDir + "/" + std::to_string(i + 1) + "_" + stem(job.inputFile) + "_"
+                       + (job.forwarding ? "forward" : "noforward") + "_"
+                       + (job.drain ? "drain" : std::to_string(job.cycles));
+        job.statsFile = job.outputFile + ".json";
+        job.outputFile += ".txt";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = runBatch(jobs, threads);
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(5) << "#" << std::setw(24) << "input" << std::setw(11) << "mode"
+              << std::right << std::setw(12) << "cycles" << std::setw(12) << "retired"
+              << std::setw(12) << "wall ms" << std::setw(14) << "cycles/s" << "  output" << std::endl;
+    int failed = 0;
+    uint64_t totalCycles = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob &job = jobs[i];
+        const BatchResult &r = results[i];
+        std::cout << std::left << std::setw(5) << (i + 1) << std::setw(24) << stem(job.inputFile)
+                  << std::setw(11) << (job.forwarding ? "forward" : "noforward") << std::right;
+        if (!r.ok) {
+            std::cout << "  FAILED: " << r.error << std::endl;
+            ++failed;
+            continue;
+        }
+        totalCycles += r.cycles;
+        double rate = r.seconds > 0 ? r.cycles / r.seconds : 0.0;
+        std::cout << std::setw(12) << r.cycles << std::setw(12) << r.retired
+                  << std::setw(12) << std::fixed << std::setprecision(3) << r.seconds * 1000
+                  << std::setw(14) << std::setprecision(0) << rate << "  " << job.outputFile << std::endl;
+    }
+    std::cout << jobs.size() << " jobs (" << failed << " failed), " << totalCycles << " cycles in "
+              << std::setprecision(3) << total << " s";
+    if (total > 0)
+        std::cout << " (" << std::setprecision(0) << totalCycles / total << " cycles/s overall)";
+    std::cout << std::endl;
+    return failed == 0 ? 0 : 1;
+}
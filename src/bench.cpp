@@ -0,0 +1,318 @@
+// bench.cpp
+// Simulator throughput benchmark ("make bench"): runs every program in
+// ../inputfiles plus scaled-up synthetic variants under both pipelines and
+// reports simulated cycles and instructions per host second, peak RSS and
+// heap allocations per run. Results go to a tab-separated file that can be
+// diffed against (or compared here with) a stored baseline.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Encode.hpp"
+#include "FunctionalCore.hpp"
+#include "Processor.hpp"
+#include "ProgramFile.hpp"
+#include "ProgramGenerator.hpp"
+
+// Every heap allocation in the process goes through here, so a run's
+// allocations are the difference of the counter around it.
+static uint64_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+// Programs that never drain (e.g. tc_2's endless loop) stop here.
+static const int cycleBudget = 500000;
+// A sample repeats the run until it has taken at least this long.
+static const double minSampleSeconds = 0.1;
+// Samples are taken until the last three agree within this fraction of their median.
+static const double stableSpread = 0.03;
+static const int minSamples = 3;
+static const int maxSamples = 10;
+
+struct Benchmark {
+    std::string name;
+    std::vector<MicroOp> program;
+    std::vector<std::string> hex;
+};
+
+// What one benchmark process reports back to the driver through a pipe.
+struct Measurement {
+    uint64_t cycles;          // Per run.
+    uint64_t retired;         // Per run.
+    uint64_t allocsPerRun;
+    double cyclesPerSecond;   // Median over the samples.
+    double spread;            // (max - min) / median of the last three samples.
+    int samples;
+};
+
+using Encode::bType;
+using Encode::iType;
+using Encode::jType;
+using Encode::rType;
+using Encode::sType;
+
+// arraysum.txt scaled to n (< 2^22) elements: a store loop fills the array
+// with n..1, then the original load/add loop sums it into x10. LUI adds the
+// PC in this simulator, so the constants are built with addi and slli.
+static Benchmark scaledArraySum(uint32_t n) {
+    std::vector<uint32_t> words = {
+        iType(0x13, 1, 0, 0, 8),         // addi x8 x0 1
+        iType(0x13, 12, 8, 1, 8),        // slli x8 x8 12       (array at 0x1000)
+        iType(0x13, n >> 11, 0, 0, 5),   // addi x5 x0 n >> 11
+        iType(0x13, 11, 5, 1, 5),        // slli x5 x5 11
+        iType(0x13, n & 0x7FF, 5, 0, 5), // addi x5 x5 n & 0x7ff
+        iType(0x13, 0, 8, 0, 6),         // addi x6 x8 0
+        iType(0x13, 0, 5, 0, 7),         // addi x7 x5 0
+        sType(0, 7, 6, 2),               // fill: sw x7 0(x6)
+        iType(0x13, 4, 6, 0, 6),         // addi x6 x6 4
+        iType(0x13, -1, 7, 0, 7),        // addi x7 x7 -1
+        bType(-12, 0, 7, 1),             // bne x7 x0 fill
+        iType(0x13, 0, 8, 0, 6),         // addi x6 x8 0
+        iType(0x13, 0, 5, 0, 7),         // addi x7 x5 0
+        iType(0x13, 0, 0, 0, 28),        // addi x28 x0 0
+        bType(24, 0, 7, 0),              // loop: beq x7 x0 finish
+        iType(0x03, 0, 6, 2, 29),        // lw x29 0(x6)
+        rType(0, 29, 28, 0, 28),         // add x28 x28 x29
+        iType(0x13, 4, 6, 0, 6),         // addi x6 x6 4
+        iType(0x13, -1, 7, 0, 7),        // addi x7 x7 -1
+        jType(-20, 0),                   // jal x0 loop
+        iType(0x13, 0, 28, 0, 10),       // finish: addi x10 x28 0
+    };
+    Benchmark b;
+    b.name = "arraysum_x" + std::to_string(n);
+    b.hex = Encode::hex(words);
+    b.program = Processor::decodeProgram(b.hex);
+    return b;
+}
+
+// True if a scaled arraysum program really sums n elements: x5 = n and x10 = n(n+1)/2.
+static bool sumsElements(const Benchmark &b, uint32_t n) {
+    FunctionalCore core(b.program);
+    core.run(16ull * n + 64);
+    return core.finished() && core.regs[5] == static_cast<int>(n) &&
+           static_cast<uint32_t>(core.regs[10]) == static_cast<uint32_t>(uint64_t(n) * (n + 1) / 2);
+}
+
+// A seeded synthetic workload with the generator's default mix.
+static Benchmark generated(uint32_t instructions) {
+    GeneratorConfig cfg;
+    cfg.instructions = instructions;
+    cfg.footprint = 64 * 1024;
+    GeneratedProgram program = ProgramGenerator(cfg).generate();
+    Benchmark b;
+    b.name = "synthetic_" + std::to_string(instructions);
+    b.hex = program.hex;
+    b.program = Processor::decodeProgram(b.hex);
+    return b;
+}
+
+// One complete simulation, without the pipeline table (logCycleCount = 0).
+static void runOnce(const Benchmark &b, bool forwarding, uint64_t &cycles, uint64_t &retired) {
+    Processor cpu(b.program, TextView::of(b.hex), forwarding, 0, std::vector<TextView>());
+    while (!cpu.isDrained() && cpu.currentCycle < cycleBudget)
+        cpu.runCycle();
+    cycles = cpu.currentCycle;
+    retired = cpu.instructionsRetired;
+}
+
+static Measurement measure(const Benchmark &b, bool forwarding) {
+    Measurement m = Measurement();
+    uint64_t before = allocations;
+    runOnce(b, forwarding, m.cycles, m.retired);
+    m.allocsPerRun = allocations - before;
+
+    std::vector<double> rates;
+    while (static_cast<int>(rates.size()) < maxSamples) {
+        uint64_t runs = 0, cycles = 0, retired = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do {
+            runOnce(b, forwarding, cycles, retired);
+            runs++;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < minSampleSeconds);
+        rates.push_back(runs * m.cycles / seconds);
+
+        if (static_cast<int>(rates.size()) >= minSamples) {
+            std::vector<double> last(rates.end() - 3, rates.end());
+            std::sort(last.begin(), last.end());
+            m.spread = (last[2] - last[0]) / last[1];
+            if (m.spread <= stableSpread)
+                break;
+        }
+    }
+    std::vector<double> sorted = rates;
+    std::sort(sorted.begin(), sorted.end());
+    m.cyclesPerSecond = sorted[sorted.size() / 2];
+    m.samples = rates.size();
+    return m;
+}
+
+// Runs the benchmark in a child process, so its peak RSS is its own.
+static bool measureInChild(const Benchmark &b, bool forwarding, Measurement &m, long &peakRssKb) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0) {
+        close(fds[0]);
+        Measurement result = measure(b, forwarding);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &m, sizeof(m));
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return false;
+    peakRssKb = usage.ru_maxrss;
+    return got == static_cast<ssize_t>(sizeof(m));
+}
+
+// Baseline rows keyed by "name mode" -> cycles per second.
+static std::map<std::string, double> readBaseline(const std::string &filename) {
+    std::map<std::string, double> rows;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string name, mode;
+        uint64_t cycles, retired;
+        double rate;
+        if (fields >> name >> mode >> cycles >> retired >> rate)
+            rows[name + " " + mode] = rate;
+    }
+    return rows;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputDir = "../inputfiles";
+    std::string outputFile = "bench_results.tsv";
+    std::string baselineFile;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--inputs" && i + 1 < argc) {
+            inputDir = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselineFile = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--inputs DIR] [--output FILE] [--baseline FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::string> files;
+    if (DIR *dir = opendir(inputDir.c_str())) {
+        while (dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                files.push_back(name);
+        }
+        closedir(dir);
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<Benchmark> benchmarks;
+    for (const std::string &file : files) {
+        ProgramFile loaded;
+        if (!loaded.load(inputDir + "/" + file) || loaded.program.empty())
+            continue;
+        Benchmark b;
+        b.name = file.substr(0, file.size() - 4);
+        b.program = loaded.program;
+        b.hex = loaded.hexStrings();
+        benchmarks.push_back(b);
+    }
+    for (uint32_t n : {1000u, 20000u}) {
+        benchmarks.push_back(scaledArraySum(n));
+        if (!sumsElements(benchmarks.back(), n)) {
+            std::cerr << benchmarks.back().name << " does not sum " << n << " elements" << std::endl;
+            return 1;
+        }
+    }
+    benchmarks.push_back(generated(16384));
+
+    std::map<std::string, double> baseline;
+    if (!baselineFile.empty()) {
+        baseline = readBaseline(baselineFile);
+        if (baseline.empty())
+            std::cout << "No baseline in " << baselineFile << "; reporting absolute numbers only" << std::endl;
+    }
+
+    std::ofstream out(outputFile);
+    if (!out) {
+        std::cerr << "Error opening " << outputFile << " for writing" << std::endl;
+        return 1;
+    }
+    out << "# name\tmode\tcycles\tretired\tcycles_per_sec\tinstructions_per_sec\tpeak_rss_kb\tallocs_per_run\tsamples\tspread"
+        << std::endl;
+    std::cout << std::left << std::setw(20) << "benchmark" << std::setw(11) << "mode" << std::right
+              << std::setw(10) << "cycles" << std::setw(14) << "cycles/s" << std::setw(14) << "instr/s"
+              << std::setw(10) << "RSS KiB" << std::setw(10) << "allocs" << std::setw(9) << "spread";
+    if (!baseline.empty())
+        std::cout << std::setw(10) << "vs base";
+    std::cout << std::endl;
+
+    int failed = 0;
+    for (const Benchmark &b : benchmarks) {
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            const char *mode = fwd ? "forward" : "noforward";
+            Measurement m;
+            long rss = 0;
+            if (!measureInChild(b, fwd == 1, m, rss)) {
+                std::cout << std::left << std::setw(20) << b.name << std::setw(11) << mode << "  FAILED" << std::endl;
+                ++failed;
+                continue;
+            }
+            double instrPerSecond = m.cycles ? m.cyclesPerSecond * m.retired / m.cycles : 0.0;
+            out << b.name << '\t' << mode << '\t' << m.cycles << '\t' << m.retired << '\t'
+                << std::fixed << std::setprecision(0) << m.cyclesPerSecond << '\t' << instrPerSecond << '\t'
+                << rss << '\t' << m.allocsPerRun << '\t' << m.samples << '\t'
+                << std::setprecision(4) << m.spread << std::endl;
+
+            std::cout << std::left << std::setw(20) << b.name << std::setw(11) << mode << std::right
+                      << std::setw(10) << m.cycles << std::fixed << std::setprecision(0)
+                      << std::setw(14) << m.cyclesPerSecond << std::setw(14) << instrPerSecond
+                      << std::setw(10) << rss << std::setw(10) << m.allocsPerRun
+                      << std::setw(8) << std::setprecision(1) << m.spread * 100 << "%";
+            auto base = baseline.find(b.name + " " + mode);
+            if (base != baseline.end() && base->second > 0)
+                std::cout << std::setw(9) << std::showpos << (m.cyclesPerSecond / base->second - 1) * 100
+                          << std::noshowpos << "%";
+            std::cout << std::endl;
+        }
+    }
+    std::cout << "Results written to " << outputFile << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -1,115 +1,553 @@
-// // main.cpp
-// #include <iostream>
-// #include <vector>
-// #include <string>
-// #include "Processor.hpp"
-// #include "Utils.hpp"
-
-// int main(int argc, char* argv[]) {
-//     // Default forwarding value is determined by compile-time flag.
-//     bool forwarding = false;
-// #ifdef FORWARDING
-//     forwarding = true;
-// #endif
-
-//     if (argc < 3) {
-//         std::cerr << "Usage: " << argv[0] << " <input_file> <cycle_count> [forward]" << std::endl;
-//         return 1;
-//     }
-
-//     std::string inputFile = argv[1];
-//     int cycleCount = std::stoi(argv[2]);
-
-//     // Allow runtime override if provided.
-//     if (argc > 3) {
-//         std::string mode = argv[3];
-//         if (mode == "forward") {
-//             forwarding = true;
-//         } else {
-//             forwarding = false;
-//         }
-//     }
-
-//     // Read instructions from file.
-//     std::vector<std::string> instructions = Utils::readInstructionsFromFile(inputFile);
-
-//     // Create Processor instance.
-//     Processor processor(instructions, forwarding, cycleCount);
-
-//     // Run simulation for the specified number of cycles.
-//     for (int cycle = 0; cycle < cycleCount; ++cycle) {
-//         std :: cout << "Cycle No: " << cycle + 1 << std::endl;
-//         processor.runCycle();
-//     }
-//     processor.printFullPipelineLog();
-//     processor.print_registers();
-//     std::cout << "Forwarding enabled: " << (forwarding ? "true" : "false") << std::endl;
-//     return 0;
-// }
-
-
-
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <string>
-#include "Processor.hpp"
-#include "Utils.hpp"
-
-int main(int argc, char* argv[]) {
-    // Default forwarding value is determined by compile-time flag.
-    bool forwarding = false;
-#ifdef FORWARDING
-    forwarding = true;
-#endif
-
-    if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <input_file> <cycle_count> [forward]" << std::endl;
-        return 1;
-    }
-
-    std::string inputFile = argv[1];
-    int cycleCount = std::stoi(argv[2]);
-
-    // Allow runtime override if provided.
-    if (argc > 3) {
-        std::string mode = argv[3];
-        if (mode == "forward") {
-            forwarding = true;
-        } else {
-            forwarding = false;
-        }
-    }
-
-    // Open "output.txt" in the current directory (src).
-    // All std::cout output will be redirected to this file.
-    std::ofstream outFile("../outputfiles/output.txt");
-    if (!outFile.is_open()) {
-        std::cerr << "Error: Could not open output.txt for writing.\n";
-        return 1;
-    }
-    // Backup the old buffer and redirect std::cout to output.txt
-    std::streambuf* oldCoutBuf = std::cout.rdbuf(outFile.rdbuf());
-
-    // Read instructions from file.
-    std::vector<std::string> instructions = Utils::readInstructionsFromFile(inputFile);
-    std::vector<std::string> asmStatements = Utils::readAssemblyStatementsFromFile(inputFile);
-
-    // Create Processor instance.
-    Processor processor(instructions, forwarding, cycleCount,asmStatements);
-
-    // Run simulation for the specified number of cycles.
-    for (int cycle = 0; cycle < cycleCount; ++cycle) {
-        // std::cout << "Cycle No: " << cycle + 1 << std::endl;
-        processor.runCycle();
-    }
-    // processor.printFullPipelineLog();
-    processor.printFullPipelineLogSimple();
-    // processor.print_registers();
-    // std::cout << "Forwarding enabled: " << (forwarding ? "true" : "false") << std::endl;
-
-    // Restore std::cout to its old buffer
-    std::cout.rdbuf(oldCoutBuf);
-
-    return 0;
-}
+// // main.cpp
+// #include <iostream>
+// #include <vector>
+// #include <string>
+// #include "Processor.hpp"
+// #include "Utils.hpp"
+
+// int main(int argc, char* argv[]) {
+//     // Default forwarding value is determined by compile-time flag.
+//     bool forwarding = false;
+// #ifdef FORWARDING
+//     forwarding = true;
+// #endif
+
+//     if (argc < 3) {
+//         std::cerr << "Usage: " << argv[0] << " <input_file> <cycle_count> [forward]" << std::endl;
+//         return 1;
+//     }
+
+//     std::string inputFile = argv[1];
+//     int cycleCount = std::stoi(argv[2]);
+
+//     // Allow runtime override if provided.
+//     if (argc > 3) {
+//         std::string mode = argv[3];
+//         if (mode == "forward") {
+//             forwarding = true;
+//         } else {
+//             forwarding = false;
+//         }
+//     }
+
+//     // Read instructions from file.
+//     std::vector<std::string> instructions = Utils::readInstructionsFromFile(inputFile);
+
+//     // Create Processor instance.
+//     Processor processor(instructions, forwarding, cycleCount);
+
+//     // Run simulation for the specified number of cycles.
+//     for (int cycle = 0; cycle < cycleCount; ++cycle) {
+//         std :: cout << "Cycle No: " << cycle + 1 << std::endl;
+//         processor.runCycle();
+//     }
+//     processor.printFullPipelineLog();
+//     processor.print_registers();
+//     std::cout << "Forwarding enabled: " << (forwarding ? "true" : "false") << std::endl;
+//     return 0;
+// }
+
+
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <climits>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include "Processor.hpp"
+#include "FunctionalCore.hpp"
+#include "Checkpoint.hpp"
+#include "Sampler.hpp"
+#include "ProgramFile.hpp"
+#include "Cache.hpp"
+#include "BranchPredictor.hpp"
+#include "PerfCounters.hpp"
+#include "TraceWriter.hpp"
+#include "Multicore.hpp"
+#include "OutOfOrderCore.hpp"
+
+int main(int argc, char* argv[]) {
+    // Both pipelines are in this one executable; the default mode follows the
+    // name it was started as ("forward" or "noforward", see the Makefile).
+    std::string program = argv[0];
+    size_t slash = program.find_last_of('/');
+    if (slash != std::string::npos)
+        program = program.substr(slash + 1);
+    bool forwarding = (program == "forward");
+
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <input_file> <cycle_count|drain|sample> [forward|noforward]"
+                  << " [--max-cycles N] [--max-retired N] [--fast-forward N] [--no-jit]"
+                  << " [--restore-checkpoint FILE] [--save-checkpoint FILE]"
+                  << " [--period N] [--warmup N] [--measure N] [--max-instructions N]"
+                  << " [--icache SPEC] [--dcache SPEC] [--predictor SPEC] [--stats-json FILE] [--trace FILE] [--memory-stats] [--load-stats]"
+                  << " [--cores N] [--threads N] [--quantum N] [--coherence SPEC] [--issue-width N] [--ooo SPEC]"
+                  << " [--units SPEC] [--fetch-block N] [--table-cycles N]" << std::endl;
+        return 1;
+    }
+
+    std::string inputFile = argv[1];
+    // "drain" instead of a cycle count runs until the program has finished and
+    // the pipeline is empty, optionally bounded by a cycle or retire cap.
+    bool drainMode = (std::string(argv[2]) == "drain");
+    // "sample" estimates CPI from short detailed windows between functional runs.
+    bool sampleMode = (std::string(argv[2]) == "sample");
+    int cycleCount = (drainMode || sampleMode) ? 0 : std::stoi(argv[2]);
+    int maxCycles = 0;
+    uint64_t maxRetired = 0;
+    bool memoryStats = false;   // Report the data-memory footprint at the end.
+    bool loadStats = false;     // Report how fast the program file was loaded.
+    bool jit = true;            // Compile hot blocks to native code during fast-forward.
+    uint64_t fastForward = 0;   // Instructions to execute functionally before the pipeline starts.
+    std::string restoreFile, saveFile;
+    std::string statsFile;      // JSON counter report ("-" = stdout).
+    std::string traceFile;      // Chrome trace-event JSON of stage occupancy.
+    SamplingConfig sampling;
+    CacheConfig icacheConfig, dcacheConfig;   // Disabled unless --icache / --dcache is given.
+    PredictorConfig predictorConfig;          // No prediction unless --predictor is given.
+    unsigned cores = 1;         // More than one runs a Multicore on shared, coherent memory.
+    unsigned threads = 1;       // Host threads for the cores (1 = deterministic lockstep).
+    unsigned quantum = 1000;    // Cycles the cores may run apart between barriers (threads > 1).
+    CoherenceConfig coherenceConfig;
+    unsigned issueWidth = 1;    // 2 = in-order dual issue.
+    bool ooo = false;           // Also run the out-of-order engine and compare it with the pipeline.
+    OooConfig oooConfig;
+    UnitConfig unitConfig;      // Single-cycle ALU and mul/div unless --units is given.
+    uint32_t fetchBlock = 0;    // Fetch-block width in bytes (0 = unlimited).
+    int tableCycles = -1;       // Pipeline-table columns (-1 = every cycle run, or none in drain mode).
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-cycles" && i + 1 < argc) {
+            maxCycles = std::stoi(argv[++i]);
+        } else if (arg == "--max-retired" && i + 1 < argc) {
+            maxRetired = std::stoull(argv[++i]);
+        } else if (arg == "--fast-forward" && i + 1 < argc) {
+            fastForward = std::stoull(argv[++i]);
+        } else if (arg == "--restore-checkpoint" && i + 1 < argc) {
+            restoreFile = argv[++i];
+        } else if (arg == "--save-checkpoint" && i + 1 < argc) {
+            saveFile = argv[++i];
+        } else if ((arg == "--icache" || arg == "--dcache") && i + 1 < argc) {
+            if (!Cache::parseConfig(argv[++i], arg == "--icache" ? icacheConfig : dcacheConfig))
+                return 1;
+        } else if (arg == "--predictor" && i + 1 < argc) {
+            if (!BranchPredictor::parseConfig(argv[++i], predictorConfig))
+                return 1;
+        } else if (arg == "--cores" && i + 1 < argc) {
+            cores = std::stoul(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (arg == "--quantum" && i + 1 < argc) {
+            quantum = std::stoul(argv[++i]);
+        } else if (arg == "--coherence" && i + 1 < argc) {
+            if (!CoherentMemory::parseConfig(argv[++i], coherenceConfig))
+                return 1;
+        } else if (arg == "--issue-width" && i + 1 < argc) {
+            issueWidth = std::stoul(argv[++i]);
+        } else if (arg == "--ooo" && i + 1 < argc) {
+            if (!OutOfOrderCore::parseConfig(argv[++i], oooConfig))
+                return 1;
+            ooo = true;
+        } else if (arg == "--units" && i + 1 < argc) {
+            if (!FunctionalUnits::parseConfig(argv[++i], unitConfig))
+                return 1;
+        } else if (arg == "--fetch-block" && i + 1 < argc) {
+            fetchBlock = std::stoul(argv[++i]);
+        } else if (arg == "--table-cycles" && i + 1 < argc) {
+            tableCycles = std::stoi(argv[++i]);
+        } else if (arg == "--stats-json" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--memory-stats") {
+            memoryStats = true;
+        } else if (arg == "--load-stats") {
+            loadStats = true;
+        } else if (arg == "--no-jit") {
+            jit = false;
+        } else if (arg == "--period" && i + 1 < argc) {
+            sampling.period = std::stoull(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            sampling.warmup = std::stoull(argv[++i]);
+        } else if (arg == "--measure" && i + 1 < argc) {
+            sampling.measure = std::stoull(argv[++i]);
+        } else if (arg == "--max-instructions" && i + 1 < argc) {
+            sampling.maxInstructions = std::stoull(argv[++i]);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        } else {
+            // Allow runtime override of the forwarding mode.
+            forwarding = (arg == "forward");
+        }
+    }
+    if (fastForward > 0 && !restoreFile.empty()) {
+        std::cerr << "--fast-forward and --restore-checkpoint cannot be combined" << std::endl;
+        return 1;
+    }
+    if (sampleMode && (fastForward > 0 || !restoreFile.empty() || !saveFile.empty())) {
+        std::cerr << "sample mode cannot be combined with fast-forward or checkpoints" << std::endl;
+        return 1;
+    }
+    if (sampleMode && sampling.measure == 0) {
+        std::cerr << "--measure must be at least 1" << std::endl;
+        return 1;
+    }
+    if (cores < 1 || cores > CoherentMemory::maxCores || threads < 1 || quantum < 1) {
+        std::cerr << "--cores must be 1 to " << CoherentMemory::maxCores << "; --threads and --quantum at least 1"
+                  << std::endl;
+        return 1;
+    }
+    if (cores > 1 && (sampleMode || fastForward > 0 || !restoreFile.empty() || !saveFile.empty() ||
+                      !traceFile.empty() || !statsFile.empty() || maxRetired > 0)) {
+        std::cerr << "--cores cannot be combined with sample mode, fast-forward, checkpoints, --trace,"
+                  << " --stats-json or --max-retired" << std::endl;
+        return 1;
+    }
+    if (issueWidth < 1 || issueWidth > Processor::maxIssueWidth) {
+        std::cerr << "--issue-width must be 1 or " << Processor::maxIssueWidth << std::endl;
+        return 1;
+    }
+    if (issueWidth > 1 && (!restoreFile.empty() || !saveFile.empty() || !traceFile.empty())) {
+        std::cerr << "--issue-width cannot be combined with checkpoints or --trace" << std::endl;
+        return 1;
+    }
+    if ((icacheConfig.enabled || dcacheConfig.enabled) && (!restoreFile.empty() || !saveFile.empty())) {
+        // Checkpoints hold architectural state only; a restored run would start with cold caches.
+        std::cerr << "--icache and --dcache cannot be combined with checkpoints" << std::endl;
+        return 1;
+    }
+    if (predictorConfig.kind != PredictorKind::NONE && (!restoreFile.empty() || !saveFile.empty())) {
+        // Nor the BTB, RAS and counters: a restored run would start untrained.
+        std::cerr << "--predictor cannot be combined with checkpoints" << std::endl;
+        return 1;
+    }
+    if (FunctionalUnits(unitConfig).enabled() && (!restoreFile.empty() || !saveFile.empty())) {
+        std::cerr << "--units cannot be combined with checkpoints" << std::endl;
+        return 1;
+    }
+    if (fetchBlock > 0 && (!restoreFile.empty() || !saveFile.empty())) {
+        std::cerr << "--fetch-block cannot be combined with checkpoints" << std::endl;
+        return 1;
+    }
+    if (sampleMode && (icacheConfig.enabled || dcacheConfig.enabled || predictorConfig.kind != PredictorKind::NONE ||
+                       FunctionalUnits(unitConfig).enabled() || issueWidth > 1 || fetchBlock > 0)) {
+        std::cerr << "sample mode cannot be combined with --icache, --dcache, --predictor, --units,"
+                  << " --issue-width or --fetch-block" << std::endl;
+        return 1;
+    }
+    if (ooo && (cores > 1 || sampleMode || fastForward > 0 || !restoreFile.empty() || !saveFile.empty() ||
+                maxRetired > 0)) {
+        std::cerr << "--ooo cannot be combined with --cores, sample mode, fast-forward, checkpoints"
+                  << " or --max-retired" << std::endl;
+        return 1;
+    }
+    if (tableCycles < -1) {
+        std::cerr << "--table-cycles must be at least 0" << std::endl;
+        return 1;
+    }
+    if (drainMode) {
+        // Only the cap (if any) bounds the run; columns stop where the run stops.
+        cycleCount = maxCycles > 0 ? maxCycles : INT_MAX;
+    }
+    // The table keeps a record per occupied cell, so a drained run of any
+    // length only logs the cycles asked for.
+    int logCycles = tableCycles < 0 ? (drainMode ? 0 : cycleCount) : std::min(tableCycles, cycleCount);
+
+    // Open "output.txt" in the current directory (src).
+    // All std::cout output will be redirected to this file.
+    std::ofstream outFile("../outputfiles/output.txt");
+    if (!outFile.is_open()) {
+        std::cerr << "Error: Could not open output.txt for writing.\n";
+        return 1;
+    }
+    // Backup the old buffer and redirect std::cout to output.txt
+    std::streambuf* oldCoutBuf = std::cout.rdbuf(outFile.rdbuf());
+
+    // Read and decode the program in one pass over the mapped file.
+    ProgramFile programFile;
+    if (!programFile.load(inputFile)) {
+        std::cout.rdbuf(oldCoutBuf);
+        return 1;
+    }
+
+    if (cores > 1) {
+        // One pipeline table per core (unless logCycles is 0); the summary goes to the console.
+        Multicore system(cores, programFile.program, programFile.hex, forwarding, logCycles, programFile.labels,
+                         coherenceConfig);
+        for (auto &core : system.cores) {
+            core->icache = Cache(icacheConfig);
+            core->dcache = Cache(dcacheConfig);
+            core->predictor = BranchPredictor(predictorConfig);
+            core->setIssueWidth(issueWidth);
+            core->setUnitTiming(unitConfig);
+            if (!core->setFetchBlock(fetchBlock)) {
+                std::cout.rdbuf(oldCoutBuf);
+                return 1;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        bool drained = system.run(drainMode ? maxCycles : cycleCount, threads, quantum);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (unsigned c = 0; c < cores && logCycles > 0; ++c) {
+            std::cout << "Core " << c << ":" << std::endl;
+            system.cores[c]->printFullPipelineLogSimple();
+        }
+        std::cout.rdbuf(oldCoutBuf);
+
+        uint64_t coreCycles = 0, invalidations = 0;
+        for (unsigned c = 0; c < cores; ++c) {
+            const Processor &core = *system.cores[c];
+            const CoherenceCounters k = system.memory.counters(c);
+            coreCycles += core.currentCycle;
+            invalidations += k.invalidationsSent;
+            std::cout << "Core " << c << ": " << (core.isDrained() ? "drained at cycle " : "stopped at cycle ")
+                      << core.currentCycle << ", " << core.instructionsRetired << " instructions retired, "
+                      << core.stallCycles << " stall cycles, " << core.cacheStallCycles << " memory stall cycles"
+                      << std::endl;
+            std::cout << "  coherence: " << k.accesses << " accesses, " << k.hits << " hits, " << k.coldMisses
+                      << " cold misses, " << k.coherenceMisses << " coherence misses, " << k.transfers
+                      << " cache-to-cache transfers, " << k.upgrades << " upgrades, " << k.invalidationsReceived
+                      << " invalidations received, " << k.scFailures << " failed SC" << std::endl;
+        }
+        std::cout << "Interconnect: " << system.memory.busTransactions() << " transactions, " << invalidations
+                  << " invalidations" << std::endl;
+        std::cout << (drained ? "All cores drained" : "Stopped") << " after " << system.cycles() << " cycles; "
+                  << coreCycles << " core-cycles in " << seconds * 1000 << " ms on " << threads
+                  << (threads == 1 ? " thread" : " threads") << " (" << coreCycles / std::max(seconds, 1e-9)
+                  << " core-cycles/s)" << std::endl;
+        if (memoryStats) {
+            const DataMemory shared = system.memory.memory();
+            std::cout << "Data memory: " << shared.residentPages() << " pages resident ("
+                      << shared.residentBytes() / 1024 << " KiB), " << system.memory.pageFaults() << " page faults"
+                      << std::endl;
+        }
+        return 0;
+    }
+
+    // Create Processor instance.
+    Processor processor(programFile.program, programFile.hex, forwarding, cycleCount, programFile.labels);
+    processor.logCycleCount = logCycles;
+    processor.icache = Cache(icacheConfig);
+    processor.dcache = Cache(dcacheConfig);
+    processor.predictor = BranchPredictor(predictorConfig);
+    processor.setIssueWidth(issueWidth);
+    processor.setUnitTiming(unitConfig);
+    if (!processor.setFetchBlock(fetchBlock)) {
+        std::cout.rdbuf(oldCoutBuf);
+        return 1;
+    }
+
+    if (sampleMode) {
+        // No pipeline log in this mode; only the estimate is reported.
+        std::cout.rdbuf(oldCoutBuf);
+        Sampler sampler(processor, sampling);
+        SamplingReport report = sampler.run();
+        std::cout << "Sampled " << report.samples.size() << " windows over "
+                  << report.instructions << " instructions" << std::endl;
+        if (report.samples.empty()) {
+            std::cout << "Program too short for a " << sampling.warmup << "+" << sampling.measure
+                      << " instruction window; run it in full instead" << std::endl;
+            return 0;
+        }
+        std::cout << "CPI: " << report.cpi.mean << " +/- " << report.cpi.halfWidth
+                  << " (95% CI, " << report.relativeError() * 100 << "% relative)" << std::endl;
+        std::cout << "Stall cycles per cycle: " << report.stallRate.mean << " +/- "
+                  << report.stallRate.halfWidth << std::endl;
+        std::cout << "Flushed fetches per cycle: " << report.flushRate.mean << " +/- "
+                  << report.flushRate.halfWidth << std::endl;
+        std::cout << "Estimated total cycles: "
+                  << static_cast<uint64_t>(report.cpi.mean * report.instructions) << std::endl;
+        if (report.suggestedSamples > 0)
+            std::cout << "Samples needed for +/-" << sampling.targetError * 100 << "% CPI: "
+                      << report.suggestedSamples << std::endl;
+        return 0;
+    }
+
+    // Optionally resume from a snapshot; the run (and its log) continues from there.
+    if (!restoreFile.empty() && !Checkpoint::restore(processor, restoreFile)) {
+        std::cout.rdbuf(oldCoutBuf);
+        return 1;
+    }
+
+    // Optionally skip ahead with the functional core and hand its state to the pipeline.
+    uint64_t fastForwarded = 0;
+    size_t fastForwardBlocks = 0;
+    size_t fastForwardCompiled = 0;
+    double fastForwardHitRate = 0.0;
+    if (fastForward > 0) {
+        FunctionalCore core(processor.instructionMemory);
+        core.setJitEnabled(jit);
+        fastForwarded = core.run(fastForward);
+        fastForwardBlocks = core.blockCount();
+        fastForwardCompiled = core.compiledBlocks();
+        fastForwardHitRate = core.blockHitRate();
+        core.handOff(processor);
+    }
+
+    // Streams while the pipeline runs; finished when it goes out of scope.
+    TraceWriter trace;
+    if (!traceFile.empty()) {
+        if (!trace.open(traceFile, processor.asmInstructions, processor.code)) {
+            std::cout.rdbuf(oldCoutBuf);
+            return 1;
+        }
+        processor.trace = &trace;
+    }
+
+    StopReason reason = StopReason::CYCLE_CAP;
+    if (drainMode) {
+        reason = processor.runUntilDrained(maxCycles, maxRetired);
+    } else {
+        // Run simulation for the specified number of cycles.
+        for (int cycle = 0; cycle < cycleCount; ++cycle) {
+            // std::cout << "Cycle No: " << cycle + 1 << std::endl;
+            processor.runCycle();
+        }
+    }
+    if (!saveFile.empty() && !Checkpoint::save(processor, saveFile)) {
+        std::cout.rdbuf(oldCoutBuf);
+        return 1;
+    }
+
+    // processor.printFullPipelineLog();
+    if (logCycles > 0)
+        processor.printFullPipelineLogSimple();
+    // processor.print_registers();
+    // std::cout << "Forwarding enabled: " << (forwarding ? "true" : "false") << std::endl;
+
+    // Restore std::cout to its old buffer
+    std::cout.rdbuf(oldCoutBuf);
+
+    if (fastForward > 0) {
+        std::cout << "Fast-forwarded " << fastForwarded << " instructions functionally (PC = "
+                  << processor.PC << ", " << fastForwardBlocks << " cached blocks, "
+                  << fastForwardCompiled << " compiled to native code, "
+                  << fastForwardHitRate * 100 << "% block cache hit rate)" << std::endl;
+    }
+    if (drainMode) {
+        if (reason == StopReason::DRAINED)
+            std::cout << "Pipeline drained at cycle " << processor.currentCycle;
+        else if (reason == StopReason::RETIRE_CAP)
+            std::cout << "Stopped at retire cap after " << processor.currentCycle << " cycles";
+        else
+            std::cout << "Stopped at cycle cap after " << processor.currentCycle << " cycles";
+        std::cout << " (" << processor.instructionsRetired << " instructions retired)" << std::endl;
+    }
+    if (issueWidth > 1) {
+        const PerfCounters &c = processor.counters;
+        uint64_t slots = static_cast<uint64_t>(processor.currentCycle) * issueWidth;
+        std::cout << "Issue: " << c.issued << " of " << slots << " slots used ("
+                  << (slots > 0 ? 100.0 * c.issued / slots : 0.0) << "%), " << c.pairsIssued
+                  << " pairs; second slot lost to " << c.pairDependency << " dependencies, " << c.pairMemoryPort
+                  << " memory port, " << c.pairMulDiv << " mul/div, " << c.pairControl << " branch/jump, "
+                  << c.pairHazard << " hazard, " << c.pairEmpty << " empty" << std::endl;
+    }
+    if (!processor.code.fixedWidth() || fetchBlock > 0) {
+        const CodeMap &code = processor.code;
+        const PerfCounters &c = processor.counters;
+        std::cout << "Code: " << code.instructions() << " instructions in " << code.bytes() << " bytes ("
+                  << code.compressedCount() << " compressed, "
+                  << (code.instructions() ? 100.0 * code.bytes() / (4.0 * code.instructions()) : 100.0)
+                  << "% of the uncompressed size)" << std::endl;
+        std::cout << "Fetch: " << c.fetchedBytes << " bytes fetched";
+        if (fetchBlock > 0) {
+            std::cout << ", " << c.fetchBlocks << " " << fetchBlock << "-byte blocks read, " << c.fetchSplits
+                      << " bubbles for instructions split across blocks";
+            if (issueWidth > 1)
+                std::cout << ", " << c.fetchBlockEnds << " fetches cut short at a block end";
+        }
+        std::cout << std::endl;
+    }
+    if (processor.units.enabled()) {
+        std::cout << "Functional units: " << processor.unitStallCycles << " frozen cycles, "
+                  << processor.counters.unitLatencyStalls << " stall cycles waiting for results";
+        for (int u = 0; u < FunctionalUnits::UNIT_KINDS; ++u) {
+            FunctionalUnits::Unit unit = static_cast<FunctionalUnits::Unit>(u);
+            const UnitCounters &k = processor.units.counters(unit);
+            std::cout << "; " << FunctionalUnits::unitName(unit) << ": " << k.operations << " operations, "
+                      << k.busyCycles << " busy cycles, " << k.issueStalls << " issue stalls, " << k.resultStalls
+                      << " result stalls";
+        }
+        std::cout << std::endl;
+    }
+    if (ooo) {
+        // Same program, caches and predictor on the out-of-order engine, for the same cycle budget.
+        OutOfOrderCore engine(programFile.program, oooConfig);
+        engine.icache = Cache(icacheConfig);
+        engine.dcache = Cache(dcacheConfig);
+        engine.predictor = BranchPredictor(predictorConfig);
+        engine.setUnitTiming(unitConfig);
+        bool drained = engine.runUntilDrained(drainMode ? maxCycles : cycleCount);
+        const OooCounters &o = engine.counters;
+        const PerfCounters &c = processor.counters;
+        std::cout << "Out-of-order (" << OutOfOrderCore::configString(oooConfig) << "): "
+                  << (drained ? "drained at cycle " : "stopped at cycle ") << engine.currentCycle << ", "
+                  << engine.instructionsRetired << " instructions retired (IPC "
+                  << (engine.currentCycle ? static_cast<double>(engine.instructionsRetired) / engine.currentCycle : 0.0)
+                  << ")" << std::endl;
+        std::cout << "  dispatch stalled " << o.robFullCycles << " cycles on a full ROB, " << o.rsFullCycles
+                  << " on full stations, " << o.lsqFullCycles << " on a full LSQ; " << o.mispredictions
+                  << " mispredictions squashed " << o.squashed << " instructions; " << o.storeForwards
+                  << " loads forwarded from the LSQ, " << o.loadWaits << " load waits on older stores" << std::endl;
+        std::cout << "In-order: " << processor.currentCycle << " cycles, " << processor.instructionsRetired
+                  << " instructions retired (IPC "
+                  << (processor.currentCycle ? static_cast<double>(processor.instructionsRetired) / processor.currentCycle
+                                             : 0.0)
+                  << "); " << c.loadUseStalls << " load-use, " << c.branchStalls << " branch, " << c.jalrStalls
+                  << " JALR, " << c.unitLatencyStalls << " unit latency and " << c.rawStalls << " RAW stall cycles, " << processor.flushedFetches
+                  << " flushed fetches" << std::endl;
+        uint64_t lost = processor.stallCycles + processor.flushedFetches + processor.unitStallCycles;
+        if (drainMode && drained && processor.isDrained() && lost > 0) {
+            int64_t recovered = static_cast<int64_t>(processor.currentCycle) - static_cast<int64_t>(engine.currentCycle);
+            std::cout << "Recovered " << recovered << " cycles against the in-order pipeline's " << lost
+                      << " stall and flush cycles (" << 100.0 * recovered / lost << "%)" << std::endl;
+        }
+    }
+    if (loadStats) {
+        std::cout << "Loaded " << programFile.program.size() << " instructions (" << programFile.bytes()
+                  << " bytes) in " << programFile.loadSeconds() * 1000 << " ms ("
+                  << programFile.throughputMBps() << " MB/s)" << std::endl;
+    }
+    const Cache *caches[] = {&processor.icache, &processor.dcache};
+    const char *cacheNames[] = {"I-cache", "D-cache"};
+    for (int c = 0; c < 2; ++c) {
+        if (!caches[c]->enabled())
+            continue;
+        std::cout << cacheNames[c] << ": " << caches[c]->accesses() << " accesses, "
+                  << caches[c]->hitCount() << " hits, " << caches[c]->missCount() << " misses ("
+                  << caches[c]->missRate() * 100 << "%), " << caches[c]->evictionCount() << " evictions, "
+                  << caches[c]->writebackCount() << " write-backs" << std::endl;
+    }
+    if (icacheConfig.enabled || dcacheConfig.enabled)
+        std::cout << "Cache stall cycles: " << processor.cacheStallCycles << std::endl;
+    const BranchPredictor &predictor = processor.predictor;
+    if (predictor.enabled()) {
+        std::cout << "Branch predictor (" << BranchPredictor::kindName(predictorConfig.kind) << "): "
+                  << predictor.branches() << " branches and jumps, " << predictor.mispredictions()
+                  << " mispredicted (" << predictor.accuracy() * 100 << "% accuracy)" << std::endl;
+        for (const auto &entry : predictor.branchStats()) {
+            int32_t index = processor.code.indexAt(entry.first);
+            std::string label = index >= 0 && static_cast<size_t>(index) < processor.asmInstructions.size()
+                                    ? processor.asmInstructions[index].str() : "";
+            const BranchPredictor::BranchStats &branch = entry.second;
+            std::cout << "  pc " << std::setw(6) << entry.first << "  " << std::left << std::setw(20) << label
+                      << std::right << std::setw(10) << branch.executed << " executed" << std::setw(10)
+                      << branch.mispredicted << " mispredicted ("
+                      << 100.0 * (branch.executed - branch.mispredicted) / branch.executed << "%)" << std::endl;
+        }
+    }
+    if (memoryStats) {
+        std::cout << "Data memory: " << processor.stack_memory.residentPages() << " pages resident ("
+                  << processor.stack_memory.residentBytes() / 1024 << " KiB), "
+                  << processor.stack_memory.pageFaults() << " page faults" << std::endl;
+    }
+    if (!statsFile.empty() && !PerfReport::writeJson(processor, statsFile))
+        return 1;
+
+    return 0;
+}
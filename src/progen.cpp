@@ -0,0 +1,100 @@
+// progen.cpp
+// Synthetic workload generator: writes a deterministic, seeded program in
+// the inputfiles format (see ProgramGenerator.hpp and the README).
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "ProgramGenerator.hpp"
+
+// "5000", "64K" or "2M".
+static bool parseCount(const std::string &text, uint32_t &value) {
+    uint64_t scale = 1;
+    std::string digits = text;
+    char suffix = text.empty() ? 0 : text[text.size() - 1];
+    if (suffix == 'K' || suffix == 'k')
+        scale = 1024;
+    else if (suffix == 'M' || suffix == 'm')
+        scale = 1024 * 1024;
+    if (scale != 1)
+        digits = text.substr(0, text.size() - 1);
+    if (digits.empty() || digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    uint64_t v = std::stoull(digits) * scale;
+    if (v > 0xFFFFFFFFull)
+        return false;
+    value = static_cast<uint32_t>(v);
+    return true;
+}
+
+// "ALU/MEM/BRANCH/JUMP" weights, e.g. "60/25/10/5".
+static bool parseMix(const std::string &text, GeneratorConfig &config) {
+    uint32_t *weights[] = {&config.aluWeight, &config.memoryWeight, &config.branchWeight, &config.jumpWeight};
+    size_t start = 0;
+    for (int i = 0; i < 4; ++i) {
+        size_t slash = text.find('/', start);
+        if ((slash == std::string::npos) != (i == 3))
+            return false;
+        if (!parseCount(text.substr(start, slash == std::string::npos ? std::string::npos : slash - start),
+                        *weights[i]))
+            return false;
+        start = slash + 1;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorConfig config;
+    std::string outputFile = "-";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = i + 1 < argc;
+        if (arg == "--compressed") {
+            config.compressed = true;
+            ok = true;
+        } else if (ok && arg == "--seed") {
+            uint32_t seed = 0;
+            ok = parseCount(argv[++i], seed);
+            config.seed = seed;
+        } else if (ok && arg == "--instructions") {
+            ok = parseCount(argv[++i], config.instructions);
+        } else if (ok && arg == "--mix") {
+            ok = parseMix(argv[++i], config);
+        } else if (ok && arg == "--dep-distance") {
+            ok = parseCount(argv[++i], config.dependencyDistance);
+        } else if (ok && arg == "--loop-depth") {
+            ok = parseCount(argv[++i], config.loopDepth);
+        } else if (ok && arg == "--iterations") {
+            ok = parseCount(argv[++i], config.iterations);
+        } else if (ok && arg == "--block") {
+            ok = parseCount(argv[++i], config.blockSize);
+        } else if (ok && arg == "--footprint") {
+            ok = parseCount(argv[++i], config.footprint);
+        } else if (ok && arg == "--output") {
+            outputFile = argv[++i];
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Usage: " << argv[0] << " [--seed N] [--instructions N] [--mix ALU/MEM/BRANCH/JUMP]"
+                      << " [--dep-distance N] [--loop-depth N] [--iterations N] [--block N]"
+                      << " [--footprint BYTES] [--compressed] [--output FILE]" << std::endl;
+            std::cerr << "Counts accept K and M suffixes; --output - (the default) writes to stdout." << std::endl;
+            return 1;
+        }
+    }
+    if (!ProgramGenerator::validate(config))
+        return 1;
+
+    GeneratedProgram program = ProgramGenerator(config).generate();
+    if (outputFile == "-") {
+        ProgramGenerator::write(program, std::cout);
+        return 0;
+    }
+    std::ofstream out(outputFile);
+    if (!out) {
+        std::cerr << "Error opening " << outputFile << " for writing" << std::endl;
+        return 1;
+    }
+    ProgramGenerator::write(program, out);
+    return out ? 0 : 1;
+}
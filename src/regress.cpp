@@ -0,0 +1,232 @@
+// regress.cpp
+// Golden-output regression runner ("make regress"): runs every program in
+// ../inputfiles under both pipelines in parallel, in-process, and compares
+// the printFullPipelineLogSimple table cell by cell with the matching
+// ../outputfiles/yes_<name>.txt (forwarding) or no_<name>.txt golden file.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include "Processor.hpp"
+#include "ProgramFile.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    // One row of a pipeline table: "<label>:<cell>;<cell>;...".
+    struct Row {
+        std::string label;
+        std::vector<std::string> cells;   // Trimmed; empty for an idle cycle.
+    };
+
+    struct CellDiff {
+        size_t row;
+        size_t cycle;
+        std::string expected, actual;
+    };
+
+    struct Case {
+        std::string name;
+        bool forwarding;
+        std::string inputFile, goldenFile;
+        // Results.
+        bool ok;
+        std::string error;
+        int cycles;
+        size_t cellsCompared;
+        std::vector<CellDiff> diffs;
+        double seconds;
+    };
+
+    std::string trim(const std::string &text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos)
+            return "";
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    bool parseRow(const std::string &line, Row &row) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || line.find(';', colon) == std::string::npos)
+            return false;
+        row.label = trim(line.substr(0, colon));
+        row.cells.clear();
+        std::stringstream cells(line.substr(colon + 1));
+        std::string cell;
+        while (std::getline(cells, cell, ';'))
+            row.cells.push_back(trim(cell));
+        if (!line.empty() && line[line.size() - 1] == ';')
+            row.cells.push_back("");   // getline drops a trailing empty cell.
+        return true;
+    }
+
+    // The table is the last block of consecutive table rows; golden files may
+    // carry a cycle-by-cycle debug dump before it.
+    std::vector<Row> parseTable(std::istream &in) {
+        std::vector<Row> table, block;
+        std::string line;
+        Row row;
+        while (std::getline(in, line)) {
+            if (parseRow(line, row)) {
+                block.push_back(row);
+            } else if (!block.empty()) {
+                table.swap(block);
+                block.clear();
+            }
+        }
+        if (!block.empty())
+            table.swap(block);
+        return table;
+    }
+
+    void runCase(Case &c) {
+        c.ok = false;
+        c.cycles = 0;
+        c.cellsCompared = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        std::ifstream golden(c.goldenFile);
+        if (!golden) {
+            c.error = "cannot read " + c.goldenFile;
+            return;
+        }
+        std::vector<Row> expected = parseTable(golden);
+        ProgramFile file;
+        if (!file.load(c.inputFile) || file.program.empty()) {
+            c.error = "cannot load " + c.inputFile;
+            return;
+        }
+        if (expected.size() != file.program.size()) {
+            c.error = "golden table has " + std::to_string(expected.size()) + " rows, program has "
+                    + std::to_string(file.program.size()) + " instructions";
+            return;
+        }
+        c.cycles = expected[0].cells.size();
+
+        Processor cpu(file.program, file.hex, c.forwarding, c.cycles, file.labels);
+        for (int cycle = 0; cycle < c.cycles; ++cycle)
+            cpu.runCycle();
+        std::stringstream rendered;
+        cpu.printFullPipelineLogSimple(rendered);
+        std::vector<Row> actual = parseTable(rendered);
+
+        for (size_t r = 0; r < expected.size(); ++r) {
+            const Row &want = expected[r];
+            Row got = r < actual.size() ? actual[r] : Row();
+            if (want.label != got.label)
+                c.diffs.push_back({r, SIZE_MAX, want.label, got.label});
+            size_t columns = std::max(want.cells.size(), got.cells.size());
+            for (size_t j = 0; j < columns; ++j) {
+                const std::string &w = j < want.cells.size() ? want.cells[j] : "";
+                const std::string &g = j < got.cells.size() ? got.cells[j] : "";
+                c.cellsCompared++;
+                if (w != g)
+                    c.diffs.push_back({r, j, w, g});
+            }
+        }
+        c.ok = c.diffs.empty();
+        c.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string shown(const std::string &cell) {
+        return cell.empty() ? "' '" : "'" + cell + "'";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputDir = "../inputfiles";
+    std::string goldenDir = "../outputfiles";
+    unsigned threads = 0;
+    size_t maxDiffs = 5;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--inputs" && i + 1 < argc) {
+            inputDir = argv[++i];
+        } else if (arg == "--goldens" && i + 1 < argc) {
+            goldenDir = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (arg == "--max-diffs" && i + 1 < argc) {
+            maxDiffs = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--inputs DIR] [--goldens DIR] [--threads N] [--max-diffs N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // A case for every input with a golden file in that mode.
+    std::vector<std::string> names;
+    if (DIR *dir = opendir(inputDir.c_str())) {
+        while (dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                names.push_back(name.substr(0, name.size() - 4));
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+    std::vector<Case> cases;
+    for (const std::string &name : names) {
+        for (int fwd = 1; fwd >= 0; --fwd) {
+            Case c;
+            c.name = name;
+            c.forwarding = fwd == 1;
+            c.inputFile = inputDir + "/" + name + ".txt";
+            c.goldenFile = goldenDir + "/" + (c.forwarding ? "yes_" : "no_") + name + ".txt";
+            c.seconds = 0.0;
+            if (std::ifstream(c.goldenFile))
+                cases.push_back(c);
+        }
+    }
+    if (cases.empty()) {
+        std::cerr << "No golden files for the inputs in " << inputDir << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for (Case &c : cases)
+            pool.submit([&c] { runCase(c); });
+        pool.wait();
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    for (const Case &c : cases) {
+        std::cout << std::left << std::setw(6) << (c.ok ? "PASS" : "FAIL") << std::setw(14) << c.name
+                  << std::setw(11) << (c.forwarding ? "forward" : "noforward") << std::right;
+        if (!c.error.empty()) {
+            std::cout << "  " << c.error << std::endl;
+            ++failed;
+            continue;
+        }
+        std::cout << std::setw(5) << c.cycles << " cycles" << std::setw(6) << c.diffs.size() << "/"
+                  << std::left << std::setw(6) << c.cellsCompared << std::right << " cells differ"
+                  << std::fixed << std::setprecision(2) << std::setw(9) << c.seconds * 1000 << " ms" << std::endl;
+        if (!c.ok)
+            ++failed;
+        for (size_t i = 0; i < c.diffs.size() && i < maxDiffs; ++i) {
+            const CellDiff &d = c.diffs[i];
+            std::cout << "        row " << d.row + 1;
+            if (d.cycle == SIZE_MAX)
+                std::cout << " label: expected '" << d.expected << "', got '" << d.actual << "'";
+            else
+                std::cout << " cycle " << d.cycle + 1 << ": expected " << shown(d.expected) << ", got "
+                          << shown(d.actual);
+            std::cout << std::endl;
+        }
+        if (c.diffs.size() > maxDiffs)
+            std::cout << "        ... " << c.diffs.size() - maxDiffs << " more" << std::endl;
+    }
+    std::cout << cases.size() - failed << "/" << cases.size() << " cases match their goldens in "
+              << std::fixed << std::setprecision(3) << wall << " s" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,796 @@
+// test_functional.cpp
+// Checks that the functional core computes the same architectural state as
+// the cycle-accurate pipeline, and that handing over mid-program is seamless.
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Processor.hpp"
+#include "FunctionalCore.hpp"
+#include "Utils.hpp"
+#include "ProgramFile.hpp"
+#include "ProgramGenerator.hpp"
+#include "Multicore.hpp"
+#include "OutOfOrderCore.hpp"
+#include "Compressed.hpp"
+#include "Encode.hpp"
+#include "BatchRunner.hpp"
+
+static const char *programs[] = {
+    "../inputfiles/arraysum.txt", "../inputfiles/strlen.txt",
+    "../inputfiles/tc_1.txt", "../inputfiles/tc_2.txt", "../inputfiles/tc_3.txt",
+    "../inputfiles/tc_4.txt", "../inputfiles/tc_5.txt", "../inputfiles/tc_6.txt",
+    "../inputfiles/tc_7.txt", "../inputfiles/tc_8.txt", "../inputfiles/tc_9.txt",
+};
+
+// Some of the test programs loop forever, so every run stops after at most
+// this many retired instructions.
+static const uint64_t retireCap = 300;
+
+// Runs the pipeline until it drains (or hits the retire cap), optionally after
+// a functional fast-forward of the first fastForward instructions.
+static Processor runPipeline(const std::vector<std::string> &hex, bool forwarding, uint64_t fastForward) {
+    Processor cpu(hex, forwarding, 100000, std::vector<std::string>());
+    if (fastForward > 0) {
+        FunctionalCore core(cpu.instructionMemory);
+        core.run(fastForward);
+        core.handOff(cpu);
+    }
+    cpu.runUntilDrained(0, retireCap - fastForward);
+    return cpu;
+}
+
+using Encode::aType;
+using Encode::bType;
+using Encode::iType;
+using Encode::jType;
+using Encode::rType;
+using Encode::sType;
+
+// An LR/SC retry loop and every AMO, ending with an SC that holds no reservation.
+static std::vector<std::string> atomicsProgram() {
+    return Encode::hex({
+        iType(0x13, 0x100, 0, 0, 10),   // addi x10 x0 256
+        iType(0x13, -7, 0, 0, 5),       // addi x5 x0 -7
+        sType(0, 5, 10, 2),             // sw x5 0(x10)
+        iType(0x13, 3, 0, 0, 6),        // addi x6 x0 3
+        aType(0x02, 0, 10, 7),          // retry: lr.w x7 (x10)
+        rType(0, 6, 7, 0, 7),           // add x7 x7 x6
+        aType(0x03, 7, 10, 8),          // sc.w x8 x7 (x10)
+        bType(-12, 0, 8, 1),            // bne x8 x0 retry
+        aType(0x00, 6, 10, 11),         // amoadd.w x11 x6 (x10)
+        aType(0x01, 5, 10, 12),         // amoswap.w x12 x5 (x10)
+        aType(0x04, 6, 10, 13),         // amoxor.w x13 x6 (x10)
+        aType(0x0C, 5, 10, 14),         // amoand.w x14 x5 (x10)
+        aType(0x08, 6, 10, 15),         // amoor.w x15 x6 (x10)
+        aType(0x10, 6, 10, 16),         // amomin.w x16 x6 (x10)
+        aType(0x14, 6, 10, 17),         // amomax.w x17 x6 (x10)
+        aType(0x18, 5, 10, 18),         // amominu.w x18 x5 (x10)
+        aType(0x1C, 5, 10, 19),         // amomaxu.w x19 x5 (x10)
+        aType(0x03, 6, 10, 20),         // sc.w x20 x6 (x10) (fails)
+        iType(0x03, 0, 10, 2, 21),      // lw x21 0(x10)
+    });
+}
+
+// Store data whose producer is two instructions ahead has left WB by the
+// time the store reaches MEM, so it must be forwarded in EX.
+static std::vector<std::string> storeForwardProgram() {
+    return Encode::hex({
+        iType(0x13, 0x100, 0, 0, 10),   // addi x10 x0 256
+        iType(0x13, 7, 0, 0, 5),        // addi x5 x0 7
+        iType(0x13, 1, 0, 0, 6),        // addi x6 x0 1
+        sType(0, 5, 10, 2),             // sw x5 0(x10)
+        iType(0x03, 0, 10, 2, 7),       // lw x7 0(x10)
+        rType(1, 7, 7, 0, 8),           // mul x8 x7 x7
+        rType(1, 6, 5, 0, 9),           // mul x9 x5 x6
+        sType(4, 8, 10, 2),             // sw x8 4(x10)
+        iType(0x03, 4, 10, 2, 11),      // lw x11 4(x10)
+    });
+}
+
+// Every core adds 1 to the word at 512 a hundred times with amoadd.w, then
+// 50 times to the word at 516 with an LR/SC loop.
+static std::vector<std::string> sharedCounterProgram() {
+    return Encode::hex({
+        iType(0x13, 0x200, 0, 0, 5),    // addi x5 x0 512
+        iType(0x13, 100, 0, 0, 6),      // addi x6 x0 100
+        iType(0x13, 1, 0, 0, 7),        // addi x7 x0 1
+        aType(0x00, 7, 5, 0),           // add: amoadd.w x0 x7 (x5)
+        iType(0x13, -1, 6, 0, 6),       // addi x6 x6 -1
+        bType(-8, 0, 6, 1),             // bne x6 x0 add
+        iType(0x13, 4, 5, 0, 9),        // addi x9 x5 4
+        iType(0x13, 50, 0, 0, 6),       // addi x6 x0 50
+        aType(0x02, 0, 9, 8),           // retry: lr.w x8 (x9)
+        iType(0x13, 1, 8, 0, 8),        // addi x8 x8 1
+        aType(0x03, 8, 9, 12),          // sc.w x12 x8 (x9)
+        bType(-12, 0, 12, 1),           // bne x12 x0 retry
+        iType(0x13, -1, 6, 0, 6),       // addi x6 x6 -1
+        bType(-20, 0, 6, 1),            // bne x6 x0 retry
+    });
+}
+
+// A counted loop over every instruction class the native tier translates,
+// followed by JAL/JALR out of the program.
+static std::vector<std::string> loopProgram() {
+    return Encode::hex({
+        iType(0x13, 300, 0, 0, 5),      // addi x5 x0 300
+        iType(0x13, 7, 0, 0, 6),        // addi x6 x0 7
+        iType(0x13, 0x100, 0, 0, 10),   // addi x10 x0 256
+        rType(0, 5, 7, 0, 7),           // loop: add x7 x7 x5
+        rType(0x20, 6, 8, 0, 8),        // sub x8 x8 x6
+        rType(1, 6, 5, 0, 9),           // mul x9 x5 x6
+        rType(1, 6, 9, 4, 11),          // div x11 x9 x6
+        rType(1, 0, 5, 4, 12),          // div x12 x5 x0
+        rType(0, 6, 5, 1, 13),          // sll x13 x5 x6
+        rType(0, 6, 8, 5, 14),          // srl x14 x8 x6
+        rType(0x20, 6, 8, 5, 15),       // sra x15 x8 x6
+        iType(0x13, 3, 5, 1, 16),       // slli x16 x5 3
+        iType(0x13, 0x402, 8, 5, 17),   // srai x17 x8 2
+        sType(0, 7, 10, 2),             // sw x7 0(x10)
+        iType(0x03, 0, 10, 2, 18),      // lw x18 0(x10)
+        sType(5, 8, 10, 0),             // sb x8 5(x10)
+        iType(0x03, 5, 10, 0, 19),      // lb x19 5(x10)
+        iType(0x03, 4, 10, 5, 20),      // lhu x20 4(x10)
+        sType(-2, 9, 10, 1),            // sh x9 -2(x10)
+        iType(0x03, -2, 10, 1, 21),     // lh x21 -2(x10)
+        0x12345AB7,                     // lui x21 0x12345
+        0x00001B17,                     // auipc x22 1
+        iType(0x13, 0, 0, 0, 0),        // addi x0 x0 0 (write to x0)
+        bType(8, 8, 5, 4),              // blt x5 x8 +8
+        iType(0x13, 1, 23, 0, 23),      // addi x23 x23 1
+        bType(8, 5, 6, 7),              // bgeu x6 x5 +8
+        iType(0x13, 1, 24, 0, 24),      // addi x24 x24 1
+        iType(0x13, -1, 5, 0, 5),       // addi x5 x5 -1
+        bType(-100, 0, 5, 1),           // bne x5 x0 loop
+        jType(8, 1),                    // jal x1 +8
+        iType(0x13, 1, 25, 0, 25),      // addi x25 x25 1 (skipped)
+        iType(0x67, 12, 1, 0, 26),      // jalr x26 x1 12 (past the end)
+    });
+}
+
+// The program re-encoded with every instruction that has an RV32C form
+// compressed (4-digit hex tokens), branch and jump offsets retargeted.
+static std::vector<std::string> compressed(const std::vector<std::string> &hex) {
+    std::vector<uint32_t> words;
+    for (const std::string &h : hex)
+        words.push_back(std::stoul(h, nullptr, 16));
+    std::vector<uint8_t> sizes;
+    std::vector<uint32_t> encoded = Compressed::compressProgram(words, sizes);
+    std::vector<std::string> out;
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        char text[9];
+        snprintf(text, sizeof(text), sizes[i] == 2 ? "%04x" : "%08x", encoded[i]);
+        out.push_back(text);
+    }
+    return out;
+}
+
+// Sums a 40-word array it first fills, in registers the 16-bit forms can
+// name and without PC-dependent instructions, so its compressed form ends in
+// exactly the same state.
+static std::vector<std::string> compressibleProgram() {
+    return Encode::hex({
+        iType(0x13, 0x200, 0, 0, 8),    // addi x8 x0 512
+        iType(0x13, 40, 0, 0, 9),       // addi x9 x0 40
+        iType(0x13, 0, 0, 0, 10),       // addi x10 x0 0
+        iType(0x13, 3, 0, 0, 12),       // addi x12 x0 3
+        sType(0, 9, 8, 2),              // fill: sw x9 0(x8)
+        iType(0x13, 4, 8, 0, 8),        // addi x8 x8 4
+        iType(0x13, -1, 9, 0, 9),       // addi x9 x9 -1
+        bType(-12, 0, 9, 1),            // bne x9 x0 fill
+        iType(0x13, 40, 0, 0, 9),       // addi x9 x0 40
+        iType(0x13, -4, 8, 0, 8),       // sum: addi x8 x8 -4
+        iType(0x03, 0, 8, 2, 11),       // lw x11 0(x8)
+        rType(0, 11, 10, 0, 10),        // add x10 x10 x11
+        rType(0x20, 12, 11, 0, 11),     // sub x11 x11 x12
+        iType(0x13, 2, 11, 1, 11),      // slli x11 x11 2
+        sType(4, 11, 8, 2),             // sw x11 4(x8)
+        iType(0x13, -1, 9, 0, 9),       // addi x9 x9 -1
+        bType(-28, 0, 9, 1),            // bne x9 x0 sum
+        rType(0, 10, 0, 0, 13),         // add x13 x0 x10 (c.mv)
+    });
+}
+
+int main() {
+    for (const char *file : programs) {
+        std::vector<std::string> hex = Utils::readInstructionsFromFile(file);
+        assert(!hex.empty());
+
+        // The single-pass mapped loader must agree with the stream-based readers.
+        ProgramFile loaded;
+        assert(loaded.load(file));
+        assert(loaded.hexStrings() == hex);
+        assert(loaded.labelStrings() == Utils::readAssemblyStatementsFromFile(file));
+        std::vector<MicroOp> decoded = Processor::decodeProgram(hex);
+        assert(loaded.program.size() == decoded.size());
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            const MicroOp &a = loaded.program[i], &b = decoded[i];
+            assert(a.type == b.type && a.opcode == b.opcode && a.rd == b.rd && a.rs1 == b.rs1 &&
+                   a.rs2 == b.rs2 && a.funct3 == b.funct3 && a.aluOp == b.aluOp && a.imm == b.imm &&
+                   a.id == b.id && a.regWrite == b.regWrite && a.memRead == b.memRead &&
+                   a.memWrite == b.memWrite && a.branch == b.branch);
+        }
+
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            Processor reference = runPipeline(hex, fwd == 1, 0);
+            bool drained = reference.isDrained();
+
+            // Registers are only written in WB, so after N retirements they hold
+            // exactly the effect of the first N instructions.
+            FunctionalCore core(reference.instructionMemory);
+            core.run(reference.instructionsRetired);
+            assert(core.instructionsExecuted == reference.instructionsRetired);
+            assert(core.regs == reference.regs);
+            if (drained) {
+                // Stores of younger in-flight instructions are only complete once drained.
+                assert(core.finished());
+                assert(core.stack_memory == reference.stack_memory);
+            }
+
+            // Hand over at every instruction boundary: the end state must not change.
+            for (uint64_t n = 1; n < reference.instructionsRetired; ++n) {
+                Processor resumed = runPipeline(hex, fwd == 1, n);
+                assert(resumed.regs == reference.regs);
+                if (drained)
+                    assert(resumed.stack_memory == reference.stack_memory);
+            }
+        }
+    }
+
+    // The table only logs its first logCycleCount cycles; the run itself is
+    // bounded by totalCycleCount alone.
+    {
+        Processor cpu(loopProgram(), true, INT_MAX, std::vector<std::string>());
+        cpu.logCycleCount = 10;
+        assert(cpu.runUntilDrained(0, 0) == StopReason::DRAINED && cpu.currentCycle > 10);
+        assert(cpu.loggedCycles() == 10 && !cpu.pipelineLog.events().empty());
+        for (const auto &e : cpu.pipelineLog.events())
+            assert(e.cycle < 10);
+        Processor quiet(loopProgram(), true, INT_MAX, std::vector<std::string>());
+        quiet.logCycleCount = 0;
+        assert(quiet.runUntilDrained(0, 0) == StopReason::DRAINED);
+        assert(quiet.loggedCycles() == 0 && quiet.pipelineLog.events().empty());
+    }
+
+    // Batch jobs follow the same rule: a drain job writes no table unless a
+    // table-cycles column asks for one.
+    {
+        const char *jobsPath = "/tmp/test_functional_jobs.txt";
+        {
+            std::ofstream out(jobsPath);
+            out << "../inputfiles/arraysum.txt forward drain\n"
+                << "../inputfiles/arraysum.txt forward drain 0 5\n"
+                << "../inputfiles/arraysum.txt forward 20\n";
+        }
+        std::vector<BatchJob> jobs;
+        assert(readBatchJobs(jobsPath, jobs) && jobs.size() == 3);
+        assert(jobs[0].tableCycles == -1 && jobs[1].tableCycles == 5 && jobs[2].tableCycles == -1);
+        for (size_t i = 0; i < jobs.size(); ++i)
+            jobs[i].outputFile = "/tmp/test_functional_job" + std::to_string(i) + ".txt";
+        std::vector<BatchResult> results = runBatch(jobs, 2);
+        std::vector<std::streamoff> sizes;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            assert(results[i].ok);
+            std::ifstream log(jobs[i].outputFile, std::ios::ate);
+            sizes.push_back(log.tellg());
+            std::remove(jobs[i].outputFile.c_str());
+        }
+        assert(results[0].cycles > 20 && sizes[0] == 0 && sizes[1] > 0 && sizes[2] > sizes[1]);
+        std::ofstream(jobsPath) << "../inputfiles/arraysum.txt forward drain 0 -1\n";
+        jobs.clear();
+        assert(!readBatchJobs(jobsPath, jobs));
+        std::remove(jobsPath);
+    }
+
+    // Stall causes add up to the stall total, and every retired load and store is counted.
+    for (const char *file : programs) {
+        std::vector<std::string> hex = Utils::readInstructionsFromFile(file);
+        std::vector<MicroOp> program = Processor::decodeProgram(hex);
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            Processor cpu = runPipeline(hex, fwd == 1, 0);
+            const PerfCounters &c = cpu.counters;
+            assert(c.loadUseStalls + c.branchStalls + c.jalrStalls + c.rawStalls + c.unitLatencyStalls ==
+                   cpu.stallCycles);
+            assert(fwd == 1 ? c.rawStalls == 0 : c.loadUseStalls == 0);
+            assert(c.unitLatencyStalls == 0 && cpu.unitStallCycles == 0);
+            assert(c.branchesTaken + c.branchesNotTaken + c.jumps == cpu.flushedFetches);
+            if (cpu.isDrained()) {
+                uint64_t loads = 0, stores = 0;
+                FunctionalCore core(program);
+                while (!core.finished()) {
+                    loads += program[core.PC / 4].memRead;
+                    stores += program[core.PC / 4].memWrite;
+                    core.step();
+                }
+                assert(c.loads == loads && c.stores == stores);
+            }
+        }
+    }
+
+    // L1 caches only change timing: every extra cycle is a frozen cycle, and
+    // the architectural end state is the same as with single-cycle memory.
+    for (const char *file : programs) {
+        std::vector<std::string> hex = Utils::readInstructionsFromFile(file);
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            Processor reference = runPipeline(hex, fwd == 1, 0);
+            Processor cached(hex, fwd == 1, 100000, std::vector<std::string>());
+            CacheConfig icfg, dcfg;
+            assert(Cache::parseConfig("size=64,ways=1,line=8,miss=4", icfg));
+            assert(Cache::parseConfig("size=128,ways=2,line=16,miss=7,policy=random", dcfg));
+            cached.icache = Cache(icfg);
+            cached.dcache = Cache(dcfg);
+            cached.runUntilDrained(0, retireCap);
+            assert(cached.instructionsRetired == reference.instructionsRetired);
+            assert(cached.regs == reference.regs);
+            assert(cached.stack_memory == reference.stack_memory);
+            assert(cached.icache.missCount() > 0);
+            if (reference.isDrained()) {
+                assert(cached.isDrained());
+                assert(cached.currentCycle == reference.currentCycle + static_cast<int>(cached.cacheStallCycles));
+            }
+        }
+    }
+
+    // Branch prediction only removes flushes: every predictor reaches the same
+    // state, only mispredicted branches and jumps flush, and a loop runs in
+    // fewer cycles once the predictor has learned it.
+    for (const char *file : programs) {
+        std::vector<std::string> hex = Utils::readInstructionsFromFile(file);
+        for (const char *spec : {"not-taken", "bimodal,btb=16", "gshare,entries=64,history=4,ras=2"}) {
+            Processor reference = runPipeline(hex, true, 0);
+            Processor predicted(hex, true, 100000, std::vector<std::string>());
+            PredictorConfig cfg;
+            assert(BranchPredictor::parseConfig(spec, cfg));
+            predicted.predictor = BranchPredictor(cfg);
+            predicted.runUntilDrained(0, retireCap);
+            assert(predicted.instructionsRetired == reference.instructionsRetired);
+            assert(predicted.regs == reference.regs);
+            assert(predicted.stack_memory == reference.stack_memory);
+            assert(predicted.flushedFetches == predicted.predictor.mispredictions());
+            assert(predicted.isDrained() == reference.isDrained());
+            if (reference.isDrained())
+                assert(predicted.currentCycle <= reference.currentCycle);
+        }
+    }
+    {
+        PredictorConfig cfg;
+        assert(BranchPredictor::parseConfig("bimodal", cfg));
+        Processor cpu(loopProgram(), true, 1000000, std::vector<std::string>());
+        cpu.predictor = BranchPredictor(cfg);
+        cpu.runUntilDrained(0, 0);
+        assert(cpu.predictor.accuracy() > 0.9);
+        assert(!BranchPredictor::parseConfig("perceptron", cfg));
+        assert(!BranchPredictor::parseConfig("gshare,entries=1000", cfg));
+    }
+
+    // The block-cached run() must match one-at-a-time step() over long runs,
+    // including stopping mid-block at an exact instruction count.
+    for (const char *file : programs) {
+        std::vector<std::string> hex = Utils::readInstructionsFromFile(file);
+        std::vector<MicroOp> program = Processor::decodeProgram(hex);
+        FunctionalCore threaded(program), interpreted(program);
+        for (uint64_t chunk : {7, 1000, 20000}) {
+            threaded.run(chunk);
+            for (uint64_t i = 0; i < chunk && interpreted.step(); ++i) {}
+            assert(threaded.instructionsExecuted == interpreted.instructionsExecuted);
+            assert(threaded.PC == interpreted.PC);
+            assert(threaded.regs == interpreted.regs);
+            assert(threaded.stack_memory == interpreted.stack_memory);
+        }
+        if (threaded.instructionsExecuted > 1000)
+            assert(threaded.blockHitRate() > 0.9);   // Loops re-use their blocks.
+    }
+
+    // Hot blocks compiled to native code must match the interpreter exactly.
+    {
+        std::vector<MicroOp> program = Processor::decodeProgram(loopProgram());
+        FunctionalCore native(program), threaded(program), interpreted(program);
+        threaded.setJitEnabled(false);
+        native.run(1000000);
+        threaded.run(1000000);
+        while (interpreted.step()) {}
+        assert(native.finished() && threaded.finished());
+        assert(native.instructionsExecuted == interpreted.instructionsExecuted);
+        assert(threaded.instructionsExecuted == interpreted.instructionsExecuted);
+        assert(native.regs == interpreted.regs && threaded.regs == interpreted.regs);
+        assert(native.stack_memory == interpreted.stack_memory);
+        assert(threaded.stack_memory == interpreted.stack_memory);
+        assert(threaded.compiledBlocks() == 0);
+        if (JitCompiler::available())
+            assert(native.compiledBlocks() > 0);
+    }
+
+    // Generated workloads are deterministic, load back through the input
+    // format, terminate, and run the same on the pipeline and the functional core.
+    {
+        GeneratorConfig cfg;
+        cfg.seed = 42;
+        cfg.instructions = 600;
+        cfg.footprint = 8192;
+        assert(ProgramGenerator::validate(cfg));
+        GeneratedProgram a = ProgramGenerator(cfg).generate();
+        GeneratedProgram b = ProgramGenerator(cfg).generate();
+        assert(a.hex.size() == cfg.instructions && a.hex == b.hex && a.assembly == b.assembly);
+        cfg.seed = 43;
+        assert(ProgramGenerator(cfg).generate().hex != a.hex);
+
+        const char *path = "/tmp/test_functional_generated.txt";
+        {
+            std::ofstream out(path);
+            ProgramGenerator::write(a, out);
+        }
+        ProgramFile loaded;
+        assert(loaded.load(path));
+        assert(loaded.hexStrings() == a.hex && loaded.labelStrings() == a.assembly);
+        std::remove(path);
+
+        FunctionalCore core(loaded.program);
+        core.run(10000000);
+        assert(core.finished());
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            Processor cpu(a.hex, fwd == 1, 0, std::vector<std::string>());
+            while (!cpu.isDrained())
+                cpu.runCycle();
+            assert(cpu.instructionsRetired == core.instructionsExecuted);
+            assert(cpu.regs == core.regs && cpu.stack_memory == core.stack_memory);
+        }
+
+        cfg.dependencyDistance = 0;
+        assert(!ProgramGenerator::validate(cfg));
+    }
+
+    // Store data is forwarded from a producer one or two instructions ahead
+    // in both forwarding modes, matching the functional core.
+    {
+        std::vector<std::string> hex = storeForwardProgram();
+        std::vector<MicroOp> program = Processor::decodeProgram(hex);
+        FunctionalCore core(program);
+        core.run(1000);
+        assert(core.finished() && core.regs[11] == 49);
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            Processor cpu(hex, fwd == 1, 0, std::vector<std::string>());
+            while (!cpu.isDrained())
+                cpu.runCycle();
+            assert(cpu.instructionsRetired == core.instructionsExecuted);
+            assert(cpu.regs == core.regs && cpu.stack_memory == core.stack_memory);
+        }
+    }
+
+    // RV32A on one core: the pipeline (both forwarding modes) and the
+    // functional core agree, and the values follow the spec.
+    {
+        std::vector<std::string> hex = atomicsProgram();
+        std::vector<MicroOp> program = Processor::decodeProgram(hex);
+        FunctionalCore core(program);
+        core.run(1000);
+        assert(core.finished());
+        assert(core.regs[8] == 0 && core.regs[11] == -4);   // -7 + 3
+        assert(core.regs[12] == -1 && core.regs[20] == 1);
+        assert(core.regs[21] == -7);   // amomaxu of 3 and -7
+        for (int fwd = 0; fwd < 2; ++fwd) {
+            Processor cpu(hex, fwd == 1, 0, std::vector<std::string>());
+            while (!cpu.isDrained())
+                cpu.runCycle();
+            assert(cpu.instructionsRetired == core.instructionsExecuted);
+            assert(cpu.regs == core.regs && cpu.stack_memory == core.stack_memory);
+        }
+    }
+
+    // Dual issue: the same architectural results as the functional core,
+    // fewer cycles, and every issued instruction accounted for.
+    {
+        std::vector<std::vector<std::string>> cases = {loopProgram(), atomicsProgram(), storeForwardProgram()};
+        for (const char *file : {"../inputfiles/arraysum.txt", "../inputfiles/strlen.txt", "../inputfiles/tc_9.txt"})
+            cases.push_back(Utils::readInstructionsFromFile(file));
+        GeneratorConfig cfg;
+        cfg.seed = 7;
+        cfg.instructions = 800;
+        cases.push_back(ProgramGenerator(cfg).generate().hex);
+        for (const auto &hex : cases) {
+            std::vector<MicroOp> program = Processor::decodeProgram(hex);
+            FunctionalCore core(program);
+            core.run(10000000);
+            assert(core.finished());
+            for (int fwd = 0; fwd < 2; ++fwd) {
+                Processor single(hex, fwd == 1, 0, std::vector<std::string>());
+                Processor dual(hex, fwd == 1, 100, std::vector<std::string>());
+                assert(dual.setIssueWidth(2));
+                while (!single.isDrained())
+                    single.runCycle();
+                while (!dual.isDrained())
+                    dual.runCycle();
+                assert(single.regs == core.regs && single.stack_memory == core.stack_memory);
+                assert(dual.regs == core.regs && dual.stack_memory == core.stack_memory);
+                assert(dual.instructionsRetired == core.instructionsExecuted);
+                assert(dual.counters.issued == dual.instructionsRetired);
+                assert(dual.currentCycle <= single.currentCycle);
+                if (hex.size() == cfg.instructions)
+                    assert(dual.counters.pairsIssued > 0 && dual.currentCycle < single.currentCycle);
+            }
+        }
+        Processor cpu(loopProgram(), true, 0, std::vector<std::string>());
+        assert(!cpu.setIssueWidth(3) && cpu.issueWidth == 1);
+    }
+
+    // Out-of-order engine: every configuration, with and without a predictor,
+    // ends in the functional core's state, and the default one beats the
+    // in-order pipeline on a generated workload.
+    {
+        std::vector<std::vector<std::string>> cases = {loopProgram(), atomicsProgram(), storeForwardProgram()};
+        for (const char *file : {"../inputfiles/arraysum.txt", "../inputfiles/strlen.txt", "../inputfiles/tc_9.txt"})
+            cases.push_back(Utils::readInstructionsFromFile(file));
+        GeneratorConfig cfg;
+        cfg.seed = 7;
+        cfg.instructions = 800;
+        cases.push_back(ProgramGenerator(cfg).generate().hex);
+        PredictorConfig gshare;
+        assert(BranchPredictor::parseConfig("gshare", gshare));
+        for (const auto &hex : cases) {
+            std::vector<MicroOp> program = Processor::decodeProgram(hex);
+            FunctionalCore core(program);
+            core.run(10000000);
+            for (const char *spec : {"default", "rob=2,width=1,rs=1,lsq=1,alu=1", "rob=64,width=4,rs=32,alu=3,mem=2"}) {
+                for (int pred = 0; pred < 2; ++pred) {
+                    OooConfig config;
+                    assert(OutOfOrderCore::parseConfig(spec, config));
+                    OutOfOrderCore ooo(program, config);
+                    if (pred)
+                        ooo.predictor = BranchPredictor(gshare);
+                    assert(ooo.runUntilDrained(1000000));
+                    assert(ooo.regs == core.regs && ooo.stack_memory == core.stack_memory);
+                    assert(ooo.instructionsRetired == core.instructionsExecuted);
+                }
+            }
+            if (hex.size() == cfg.instructions) {
+                Processor inOrder(hex, true, 0, std::vector<std::string>());
+                while (!inOrder.isDrained())
+                    inOrder.runCycle();
+                OutOfOrderCore ooo(program);
+                assert(ooo.runUntilDrained(0));
+                assert(ooo.currentCycle < static_cast<uint64_t>(inOrder.currentCycle));
+                assert(ooo.counters.stores == inOrder.counters.stores && ooo.counters.loads == inOrder.counters.loads);
+            }
+        }
+        // With two address units each load of storeForwardProgram() issues
+        // alongside its store and takes the value from the LSQ.
+        std::vector<MicroOp> program = Processor::decodeProgram(storeForwardProgram());
+        OooConfig config;
+        assert(OutOfOrderCore::parseConfig("width=4,mem=2", config));
+        OutOfOrderCore forwarding(program, config);
+        assert(forwarding.runUntilDrained(0));
+        assert(forwarding.counters.storeForwards == 2 && forwarding.regs[11] == 49);
+        config = OooConfig();
+        assert(OutOfOrderCore::parseConfig("rob=64,width=4", config));
+        assert(config.robSize == 64 && config.width == 4 && config.rsSize == 16);
+        assert(OutOfOrderCore::configString(config) == "rob=64,width=4,rs=16,lsq=16,alu=2,muldiv=1,mem=1");
+        assert(!OutOfOrderCore::parseConfig("rob=0", config) && !OutOfOrderCore::parseConfig("ports=2", config));
+        assert(!OutOfOrderCore::parseConfig("width=x", config) && config.robSize == 64);
+    }
+
+    // Multi-cycle functional units: single and dual issue, both forwarding
+    // modes and the out-of-order engine keep the functional core's results,
+    // longer latencies cost cycles, and unpipelined units cost more.
+    {
+        std::vector<std::vector<std::string>> cases = {loopProgram(), atomicsProgram(), storeForwardProgram()};
+        for (const char *file : {"../inputfiles/arraysum.txt", "../inputfiles/strlen.txt", "../inputfiles/tc_9.txt"})
+            cases.push_back(Utils::readInstructionsFromFile(file));
+        GeneratorConfig cfg;
+        cfg.seed = 7;
+        cfg.instructions = 800;
+        cases.push_back(ProgramGenerator(cfg).generate().hex);
+        UnitConfig pipelined, unpipelined, shifts;
+        assert(FunctionalUnits::parseConfig("mul=4,div=12,add=2", pipelined));
+        assert(FunctionalUnits::parseConfig("mul=4:4,div=12:12,add=2:2", unpipelined));
+        assert(FunctionalUnits::parseConfig("add=3:2,sll=2,srl=2,sra=2", shifts));
+        for (const auto &hex : cases) {
+            std::vector<MicroOp> program = Processor::decodeProgram(hex);
+            FunctionalCore core(program);
+            core.run(10000000);
+            for (int fwd = 0; fwd < 2; ++fwd) {
+                for (unsigned width = 1; width <= Processor::maxIssueWidth; ++width) {
+                    int cycles[4] = {0, 0, 0, 0};
+                    const UnitConfig configs[] = {UnitConfig(), pipelined, unpipelined, shifts};
+                    for (int k = 0; k < 4; ++k) {
+                        Processor cpu(hex, fwd == 1, 0, std::vector<std::string>());
+                        assert(cpu.setIssueWidth(width));
+                        cpu.setUnitTiming(configs[k]);
+                        while (!cpu.isDrained())
+                            cpu.runCycle();
+                        assert(cpu.regs == core.regs && cpu.stack_memory == core.stack_memory);
+                        assert(cpu.instructionsRetired == core.instructionsExecuted);
+                        const PerfCounters &c = cpu.counters;
+                        assert(c.loadUseStalls + c.branchStalls + c.jalrStalls + c.rawStalls + c.unitLatencyStalls ==
+                               cpu.stallCycles);
+                        uint64_t unitStalls = 0;
+                        for (int u = 0; u < FunctionalUnits::UNIT_KINDS; ++u) {
+                            const UnitCounters &k = cpu.units.counters(static_cast<FunctionalUnits::Unit>(u));
+                            unitStalls += k.issueStalls + k.resultStalls;
+                        }
+                        assert(unitStalls == cpu.unitStallCycles);
+                        cycles[k] = cpu.currentCycle;
+                    }
+                    assert(cycles[0] <= cycles[1] && cycles[1] <= cycles[2] && cycles[0] <= cycles[3]);
+                }
+            }
+            for (const UnitConfig &timing : {pipelined, unpipelined, shifts}) {
+                OutOfOrderCore ooo(program);
+                ooo.setUnitTiming(timing);
+                assert(ooo.runUntilDrained(1000000));
+                assert(ooo.regs == core.regs && ooo.stack_memory == core.stack_memory);
+            }
+        }
+        // storeForwardProgram()'s multiplies: the first feeds a store right
+        // behind it, so write-back waits for it and the store waits in ID.
+        Processor cpu(storeForwardProgram(), true, 0, std::vector<std::string>());
+        cpu.setUnitTiming(unpipelined);
+        while (!cpu.isDrained())
+            cpu.runCycle();
+        const UnitCounters &mul = cpu.units.counters(FunctionalUnits::MULDIV_UNIT);
+        assert(mul.operations == 2 && mul.busyCycles >= 5 && mul.issueStalls > 0 && mul.resultStalls > 0);
+        assert(cpu.counters.unitLatencyStalls > 0 && cpu.regs[11] == 49);
+
+        UnitConfig config;
+        assert(!FunctionalUnits(config).enabled());
+        assert(FunctionalUnits::parseConfig("sll=3:2", config));
+        assert(config.timing[static_cast<int>(ALUOp::SLLI)].latency == 3 &&
+               config.timing[static_cast<int>(ALUOp::SLLI)].interval == 2);
+        assert(FunctionalUnits(config).enabled());
+        assert(!FunctionalUnits::parseConfig("mul=0", config) && !FunctionalUnits::parseConfig("fma=2", config));
+        assert(!FunctionalUnits::parseConfig("mul=3:x", config) && !FunctionalUnits::parseConfig("div=", config));
+        assert(config.timing[static_cast<int>(ALUOp::MUL)].latency == 1);
+    }
+
+    // RV32C: compressed programs load from 4-digit tokens and end in the
+    // functional core's state on the pipeline (both forwarding modes, single
+    // and dual issue, every fetch-block width), the block-cached functional
+    // run and the out-of-order engine. A program without PC-dependent
+    // instructions ends as its 32-bit original does, in fewer bytes.
+    {
+        std::vector<std::vector<std::string>> cases = {compressibleProgram(), loopProgram(), storeForwardProgram()};
+        for (const char *file : {"../inputfiles/arraysum.txt", "../inputfiles/strlen.txt"})
+            cases.push_back(Utils::readInstructionsFromFile(file));
+        GeneratorConfig cfg;
+        cfg.seed = 7;
+        cfg.instructions = 800;
+        cases.push_back(ProgramGenerator(cfg).generate().hex);
+        cfg.compressed = true;
+        GeneratedProgram generated = ProgramGenerator(cfg).generate();
+        assert(generated.hex == compressed(cases.back()));
+        PredictorConfig gshare;
+        assert(BranchPredictor::parseConfig("gshare", gshare));
+        for (const auto &original : cases) {
+            std::vector<std::string> hex = compressed(original);
+            std::vector<MicroOp> program = Processor::decodeProgram(hex);
+            CodeMap code(program);
+            assert(code.compressedCount() > 0 && code.bytes() < 4 * hex.size());
+            FunctionalCore stepped(program), core(program);
+            while (stepped.step()) {
+            }
+            core.run(10000000);
+            assert(core.finished() && core.regs == stepped.regs && core.stack_memory == stepped.stack_memory);
+            assert(core.instructionsExecuted == stepped.instructionsExecuted);
+            for (int fwd = 0; fwd < 2; ++fwd) {
+                for (unsigned width = 1; width <= Processor::maxIssueWidth; ++width) {
+                    for (uint32_t block : {0u, 4u, 8u, 16u}) {
+                        Processor cpu(hex, fwd == 1, 0, std::vector<std::string>());
+                        assert(cpu.setIssueWidth(width) && cpu.setFetchBlock(block));
+                        if (block == 8)
+                            cpu.predictor = BranchPredictor(gshare);
+                        while (!cpu.isDrained())
+                            cpu.runCycle();
+                        assert(cpu.regs == core.regs && cpu.stack_memory == core.stack_memory);
+                        assert(cpu.instructionsRetired == core.instructionsExecuted);
+                        const PerfCounters &c = cpu.counters;
+                        assert(c.fetchedBytes >= code.bytes() || cpu.instructionsRetired < program.size());
+                        if (block == 0)
+                            assert(c.fetchBlocks == 0 && c.fetchSplits == 0 && c.fetchBlockEnds == 0);
+                        else
+                            assert(c.fetchBlocks > 0 && c.fetchBlocks * block >= c.fetchedBytes / 2);
+                    }
+                }
+            }
+            for (int pred = 0; pred < 2; ++pred) {
+                OutOfOrderCore ooo(program);
+                if (pred)
+                    ooo.predictor = BranchPredictor(gshare);
+                assert(ooo.runUntilDrained(1000000));
+                assert(ooo.regs == core.regs && ooo.stack_memory == core.stack_memory);
+            }
+        }
+
+        // The compressible program: same results as its 32-bit original,
+        // with less code, fewer bytes fetched and fewer fetch blocks read.
+        const char *path = "/tmp/test_functional_compressed.txt";
+        {
+            std::ofstream out(path);
+            for (const std::string &h : compressed(compressibleProgram()))
+                out << h << "\n";
+        }
+        ProgramFile loaded;
+        assert(loaded.load(path));
+        std::remove(path);
+        assert(loaded.program.size() == compressibleProgram().size() && loaded.program[2].size == 2);
+        Processor wide(compressibleProgram(), true, 0, std::vector<std::string>());
+        Processor dense(loaded.program, loaded.hex, true, 0, loaded.labels);
+        assert(wide.setFetchBlock(8) && dense.setFetchBlock(8));
+        while (!wide.isDrained())
+            wide.runCycle();
+        while (!dense.isDrained())
+            dense.runCycle();
+        assert(dense.regs == wide.regs && dense.stack_memory == wide.stack_memory && wide.regs[13] == 820);
+        assert(dense.instructionsRetired == wide.instructionsRetired);
+        assert(dense.code.bytes() * 10 < wide.code.bytes() * 6 && wide.code.fixedWidth());
+        assert(dense.counters.fetchedBytes < wide.counters.fetchedBytes);
+        assert(dense.counters.fetchBlocks < wide.counters.fetchBlocks);
+        assert(!dense.setFetchBlock(2) && !dense.setFetchBlock(12) && !dense.setFetchBlock(128));
+    }
+
+    // MSI directory transitions on a two-core memory, with the data moving along.
+    {
+        CoherenceConfig cfg;
+        CoherentMemory shared(2, cfg);
+        uint32_t latency;
+        assert(shared.load(0, 2, 0x40, latency) == 0 && latency == cfg.memoryLatency);   // I -> S (cold)
+        shared.load(0, 2, 0x44, latency);
+        assert(latency == 1);                                                        // Same line: hit
+        shared.load(1, 2, 0x40, latency);
+        assert(latency == cfg.memoryLatency);                                        // Both S
+        shared.store(0, 2, 0x40, 5, latency);
+        assert(latency == cfg.upgradeLatency);                                       // S -> M, core 1 invalidated
+        shared.store(0, 2, 0x40, 6, latency);
+        assert(latency == 1);
+        assert(shared.load(1, 2, 0x40, latency) == 6 && latency == cfg.transferLatency);  // M copy supplies core 1
+        assert(shared.counters(1).coherenceMisses == 1 && shared.counters(1).invalidationsReceived == 1);
+        shared.store(1, 2, 0x40, 7, latency);
+        assert(latency == cfg.upgradeLatency);
+        assert(shared.atomic(0, ALUOp::AMOADD, 0x40, 1, latency) == 7 && latency == cfg.transferLatency);
+        assert(shared.counters(0).transfers == 1 && shared.busTransactions() == 6);
+
+        // A word across a page (and shard) boundary, and a reservation left
+        // behind in another shard by a later LR.
+        shared.store(0, 2, DataMemory::pageSize - 2, 0xAABBCCDD, latency);
+        assert(shared.load(1, 2, DataMemory::pageSize - 2, latency) == 0xAABBCCDD);
+        assert(shared.load(1, 5, DataMemory::pageSize, latency) == 0xAABB);
+        shared.atomic(0, ALUOp::LR, 0x40, 0, latency);
+        shared.atomic(0, ALUOp::LR, 2 * DataMemory::pageSize, 0, latency);
+        assert(shared.atomic(0, ALUOp::SC, 0x40, 9, latency) == 1);
+        const DataMemory memory = shared.memory();
+        assert(memory.load(2, 0x40) == 8 && memory.load(2, DataMemory::pageSize - 2) == 0xAABBCCDD);
+        CoherenceConfig parsed;
+        assert(CoherentMemory::parseConfig("line=64,transfer=4", parsed));
+        assert(parsed.lineSize == 64 && parsed.transferLatency == 4 && parsed.memoryLatency == 10);
+        assert(!CoherentMemory::parseConfig("line=48", parsed));
+    }
+
+    // A shared counter on four cores: lockstep and quantum-skewed threads
+    // both keep every increment.
+    {
+        std::vector<std::string> hex = sharedCounterProgram();
+        std::vector<MicroOp> program = Processor::decodeProgram(hex);
+        std::vector<std::string> labels(hex.size());
+        for (unsigned threads = 1; threads <= 2; ++threads) {
+            for (int fwd = 0; fwd < 2; ++fwd) {
+                Multicore system(4, program, TextView::of(hex), fwd == 1, 0, TextView::of(labels));
+                for (auto &core : system.cores)
+                    core->setIssueWidth(threads);   // Dual-issue cores with two threads.
+                assert(system.run(1000000, threads, 50));
+                const DataMemory memory = system.memory.memory();
+                assert(memory.load(2, 0x200) == 400 && memory.load(2, 0x204) == 200);
+                uint64_t transfers = 0, invalidations = 0;
+                for (unsigned c = 0; c < 4; ++c) {
+                    transfers += system.memory.counters(c).transfers;
+                    invalidations += system.memory.counters(c).invalidationsReceived;
+                    assert(system.cores[c]->regs[10] == static_cast<int>(c));
+                }
+                assert(transfers > 0 && invalidations > 0);
+            }
+        }
+    }
+
+    std::cout << "All functional core tests passed" << std::endl;
+    return 0;
+}
+// End of test_functional.cpp
@@ -1,147 +1,249 @@
-// test_instruction.cpp
-#include <cassert>
-#include <iostream>
-#include "Instruction.hpp"  // Assumes Instruction.hpp defines Instruction, InstType, and the union 'info'
-
-int main() {
-    // -----------------------
-    // Test R-type Instruction
-    // Construct an R-type instruction with:
-    //  - opcode = 0x33 (R-type)
-    //  - rd = 5, funct3 = 0, rs1 = 1, rs2 = 2, funct7 = 0
-    // Encoding: rawOpcode = (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode
-    //           = (0 << 25) | (2 << 20) | (1 << 15) | (0 << 12) | (5 << 7) | 0x33 = 0x002082B3
-    // {
-    //     Instruction inst("002082B3");
-        
-    //     assert(inst.type == InstType::R_TYPE);
-    //     assert(inst.info.r.rd     == 5);
-    //     assert(inst.info.r.funct3 == 0);
-    //     assert(inst.info.r.rs1    == 1);
-    //     assert(inst.info.r.rs2    == 2);
-    //     assert(inst.info.r.funct7 == 0);
-    //     inst.print_inst_members();
-    // }
-
-    // -----------------------
-    // Test I-type Instruction (e.g. ADDI)
-    // Construct an I-type instruction with:
-    //  - opcode = 0x13 (ADDI)
-    //  - rd = 5, funct3 = 0, rs1 = 1, immediate = 10
-    // Encoding: immediate in bits[31:20] is 10, so:
-    //           rawOpcode = (10 << 20) | (1 << 15) | (0 << 12) | (5 << 7) | 0x13 = 0x00A08293
-    {
-        Instruction inst("00A08293");
-        assert(inst.type == InstType::I_TYPE);
-        assert(inst.info.i.rd     == 5);
-        assert(inst.info.i.funct3 == 0);
-        assert(inst.info.i.rs1    == 1);
-        // The immediate is sign-extended via: static_cast<int32_t>(rawOpcode) >> 20
-        assert(inst.info.i.imm    == 10);
-    }
-
-    // -----------------------
-    // Test S-type Instruction (e.g. Store)
-    // Construct an S-type instruction with:
-    //  - opcode = 0x23 (Store)
-    //  - rs1 = 3, rs2 = 2, funct3 = 0, immediate = 20
-    // Immediate is split: imm_high = immediate >> 5 = 0 and imm_low = immediate & 0x1F = 20.
-    // Encoding: rawOpcode = (imm_high << 25) | (rs2 << 20) | (rs1 << 15)
-    //           | (funct3 << 12) | (imm_low << 7) | opcode = 0x00218A23
-    {
-        Instruction inst("00218A23");
-        assert(inst.type == InstType::S_TYPE);
-        assert(inst.info.s.rs1    == 3);
-        assert(inst.info.s.rs2    == 2);
-        assert(inst.info.s.funct3 == 0);
-        assert(inst.info.s.imm    == 20);
-    }
-
-    // -----------------------
-    // Test B-type Instruction (e.g. Branch)
-    // Construct a B-type instruction with:
-    //  - opcode = 0x63 (Branch)
-    //  - rs1 = 1, rs2 = 2, funct3 = 0
-    //  - immediate = 16, encoded as:
-    //       imm_12 = 0, imm_11 = 0, imm_10_5 = 0, imm_4_1 = 8  (since 8 << 1 = 16)
-    // Encoding: rawOpcode = (imm_12 << 31) | (imm_10_5 << 25) | (rs2 << 20) | (rs1 << 15)
-    //           | (funct3 << 12) | (imm_4_1 << 8) | (imm_11 << 7) | opcode = 0x00208863
-    {
-        Instruction inst("00208863");
-        assert(inst.type == InstType::B_TYPE);
-        assert(inst.info.b.rs1    == 1);
-        assert(inst.info.b.rs2    == 2);
-        assert(inst.info.b.funct3 == 0);
-        assert(inst.info.b.imm    == 16);
-    }
-
-    // -----------------------
-    // Test U-type Instruction (e.g. LUI)
-    // Construct a U-type instruction with:
-    //  - opcode = 0x37 (LUI)
-    //  - rd = 5, and imm = 0x12345000 (the lower 12 bits are zero by definition)
-    // Encoding: rawOpcode = (0x12345 << 12) | (5 << 7) | 0x37 = 0x123452B7
-    {
-        Instruction inst("123452B7");
-        assert(inst.type == InstType::U_TYPE);
-        assert(inst.info.u.rd  == 5);
-        assert(inst.info.u.imm == 0x12345000);
-    }
-
-    // -----------------------
-    // Test J-type Instruction (e.g. JAL)
-    // Construct a J-type instruction with:
-    //  - opcode = 0x6F (JAL)
-    //  - rd = 1
-    //  - immediate = 2, which is encoded (note the immediate encoding is noncontiguous):
-    //       Let imm_20 = 0, imm_19_12 = 0, imm_11 = 0, and imm_10_1 = 1 (since 1 << 1 = 2).
-    // Encoding: rawOpcode = (imm_20 << 31) | (imm_10_1 << 21) | (imm_11 << 20)
-    //           | (imm_19_12 << 12) | (rd << 7) | opcode = 0x002000EF
-    {
-        Instruction inst("002000EF");
-        assert(inst.type == InstType::J_TYPE);
-        assert(inst.info.j.rd  == 1);
-        assert(inst.info.j.imm == 2);
-    }
-
-    // -----------------------
-    // Test Unknown Instruction
-    // Use an opcode that does not match any known type.
-
-    {
-        Instruction inst("0x402081b3");
-        // assert(inst.type == InstType::R_TYPE);
-        // assert(inst.info.r.rd     == 5);
-        // assert(inst.info.r.funct3 == 0);
-        // assert(inst.info.r.rs1    == 1);
-        // assert(inst.info.r.rs2    == 2);
-        // assert(inst.info.r.funct7 == 0);
-        inst.print_inst_members();
-    }
-
-    {
-        Instruction inst("0xfe015ee3");
-        assert(inst.type == InstType::B_TYPE);
-        assert(inst.info.b.rs1    == 2);
-        assert(inst.info.b.rs2    == 0);
-        assert(inst.info.b.funct3 == 5);
-        // assert(inst.info.b.imm    == -4);
-        inst.print_inst_members();
-        
-    }
-
-    {
-        Instruction inst("0x00c00093");
-        assert(inst.type == InstType::I_TYPE);
-        assert(inst.info.i.rd     == 1);
-        assert(inst.info.i.funct3 == 0);
-        assert(inst.info.i.rs1    == 0);
-        assert(inst.info.i.imm    == 12);
-        inst.print_inst_members();
-    }
-
-    std::cout << "All tests passed" << std::endl;
-    return 0;
-}
-// End of test_instruction.cpp
-// g++ test_instruction.cpp Instruction.cpp -o test_instruction
+// test_instruction.cpp
+#include <cassert>
+#include <iostream>
+#include "MicroOp.hpp"
+#include "Compressed.hpp"
+#include "Instruction.hpp"  // Assumes Instruction.hpp defines Instruction, InstType, and the union 'info'
+
+int main() {
+    // -----------------------
+    // Test R-type Instruction
+    // Construct an R-type instruction with:
+    //  - opcode = 0x33 (R-type)
+    //  - rd = 5, funct3 = 0, rs1 = 1, rs2 = 2, funct7 = 0
+    // Encoding: rawOpcode = (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode
+    //           = (0 << 25) | (2 << 20) | (1 << 15) | (0 << 12) | (5 << 7) | 0x33 = 0x002082B3
+    // {
+    //     Instruction inst("002082B3");
+        
+    //     assert(inst.type == InstType::R_TYPE);
+    //     assert(inst.info.r.rd     == 5);
+    //     assert(inst.info.r.funct3 == 0);
+    //     assert(inst.info.r.rs1    == 1);
+    //     assert(inst.info.r.rs2    == 2);
+    //     assert(inst.info.r.funct7 == 0);
+    //     inst.print_inst_members();
+    // }
+
+    // -----------------------
+    // Test I-type Instruction (e.g. ADDI)
+    // Construct an I-type instruction with:
+    //  - opcode = 0x13 (ADDI)
+    //  - rd = 5, funct3 = 0, rs1 = 1, immediate = 10
+    // Encoding: immediate in bits[31:20] is 10, so:
+    //           rawOpcode = (10 << 20) | (1 << 15) | (0 << 12) | (5 << 7) | 0x13 = 0x00A08293
+    {
+        Instruction inst("00A08293");
+        assert(inst.type == InstType::I_TYPE);
+        assert(inst.info.i.rd     == 5);
+        assert(inst.info.i.funct3 == 0);
+        assert(inst.info.i.rs1    == 1);
+        // The immediate is sign-extended via: static_cast<int32_t>(rawOpcode) >> 20
+        assert(inst.info.i.imm    == 10);
+    }
+
+    // -----------------------
+    // Test S-type Instruction (e.g. Store)
+    // Construct an S-type instruction with:
+    //  - opcode = 0x23 (Store)
+    //  - rs1 = 3, rs2 = 2, funct3 = 0, immediate = 20
+    // Immediate is split: imm_high = immediate >> 5 = 0 and imm_low = immediate & 0x1F = 20.
+    // Encoding: rawOpcode = (imm_high << 25) | (rs2 << 20) | (rs1 << 15)
+    //           | (funct3 << 12) | (imm_low << 7) | opcode = 0x00218A23
+    {
+        Instruction inst("00218A23");
+        assert(inst.type == InstType::S_TYPE);
+        assert(inst.info.s.rs1    == 3);
+        assert(inst.info.s.rs2    == 2);
+        assert(inst.info.s.funct3 == 0);
+        assert(inst.info.s.imm    == 20);
+    }
+
+    // -----------------------
+    // Test B-type Instruction (e.g. Branch)
+    // Construct a B-type instruction with:
+    //  - opcode = 0x63 (Branch)
+    //  - rs1 = 1, rs2 = 2, funct3 = 0
+    //  - immediate = 16, encoded as:
+    //       imm_12 = 0, imm_11 = 0, imm_10_5 = 0, imm_4_1 = 8  (since 8 << 1 = 16)
+    // Encoding: rawOpcode = (imm_12 << 31) | (imm_10_5 << 25) | (rs2 << 20) | (rs1 << 15)
+    //           | (funct3 << 12) | (imm_4_1 << 8) | (imm_11 << 7) | opcode = 0x00208863
+    {
+        Instruction inst("00208863");
+        assert(inst.type == InstType::B_TYPE);
+        assert(inst.info.b.rs1    == 1);
+        assert(inst.info.b.rs2    == 2);
+        assert(inst.info.b.funct3 == 0);
+        assert(inst.info.b.imm    == 16);
+    }
+
+    // -----------------------
+    // Test U-type Instruction (e.g. LUI)
+    // Construct a U-type instruction with:
+    //  - opcode = 0x37 (LUI)
+    //  - rd = 5, and imm = 0x12345000 (the lower 12 bits are zero by definition)
+    // Encoding: rawOpcode = (0x12345 << 12) | (5 << 7) | 0x37 = 0x123452B7
+    {
+        Instruction inst("123452B7");
+        assert(inst.type == InstType::U_TYPE);
+        assert(inst.info.u.rd  == 5);
+        assert(inst.info.u.imm == 0x12345000);
+    }
+
+    // -----------------------
+    // Test J-type Instruction (e.g. JAL)
+    // Construct a J-type instruction with:
+    //  - opcode = 0x6F (JAL)
+    //  - rd = 1
+    //  - immediate = 2, which is encoded (note the immediate encoding is noncontiguous):
+    //       Let imm_20 = 0, imm_19_12 = 0, imm_11 = 0, and imm_10_1 = 1 (since 1 << 1 = 2).
+    // Encoding: rawOpcode = (imm_20 << 31) | (imm_10_1 << 21) | (imm_11 << 20)
+    //           | (imm_19_12 << 12) | (rd << 7) | opcode = 0x002000EF
+    {
+        Instruction inst("002000EF");
+        assert(inst.type == InstType::J_TYPE);
+        assert(inst.info.j.rd  == 1);
+        assert(inst.info.j.imm == 2);
+    }
+
+    // -----------------------
+    // Test Unknown Instruction
+    // Use an opcode that does not match any known type.
+
+    {
+        Instruction inst("0x402081b3");
+        // assert(inst.type == InstType::R_TYPE);
+        // assert(inst.info.r.rd     == 5);
+        // assert(inst.info.r.funct3 == 0);
+        // assert(inst.info.r.rs1    == 1);
+        // assert(inst.info.r.rs2    == 2);
+        // assert(inst.info.r.funct7 == 0);
+        inst.print_inst_members();
+    }
+
+    {
+        Instruction inst("0xfe015ee3");
+        assert(inst.type == InstType::B_TYPE);
+        assert(inst.info.b.rs1    == 2);
+        assert(inst.info.b.rs2    == 0);
+        assert(inst.info.b.funct3 == 5);
+        // assert(inst.info.b.imm    == -4);
+        inst.print_inst_members();
+        
+    }
+
+    {
+        Instruction inst("0x00c00093");
+        assert(inst.type == InstType::I_TYPE);
+        assert(inst.info.i.rd     == 1);
+        assert(inst.info.i.funct3 == 0);
+        assert(inst.info.i.rs1    == 0);
+        assert(inst.info.i.imm    == 12);
+        inst.print_inst_members();
+    }
+
+    // -----------------------
+    // Test MicroOp pre-decoding
+    // The pipeline only sees MicroOps, so check that the register fields,
+    // immediate and resolved control signals survive the conversion.
+    {
+        // sub x3 x1 x2
+        MicroOp op = MicroOp::fromInstruction(Instruction("402081B3"), 7);
+        assert(op.type   == InstType::R_TYPE);
+        assert(op.id     == 7);
+        assert(op.rd     == 3);
+        assert(op.rs1    == 1);
+        assert(op.rs2    == 2);
+        assert(op.aluOp  == ALUOp::SUB);
+        assert(op.regWrite && !op.memRead && !op.memWrite);
+    }
+    {
+        // lw x29 0 x6: load, so rs2 must be left as x0
+        MicroOp op = MicroOp::fromInstruction(Instruction("00032E83"), 0);
+        assert(op.type   == InstType::I_TYPE);
+        assert(op.rd     == 29);
+        assert(op.rs1    == 6);
+        assert(op.rs2    == 0);
+        assert(op.funct3 == 2);
+        assert(op.memRead && op.regWrite);
+    }
+    {
+        // sw x5 4 x8: store, so rd must be left as x0
+        MicroOp op = MicroOp::fromInstruction(Instruction("00542223"), 0);
+        assert(op.type   == InstType::S_TYPE);
+        assert(op.rd     == 0);
+        assert(op.rs1    == 8);
+        assert(op.rs2    == 5);
+        assert(op.imm    == 4);
+        assert(op.memWrite && !op.regWrite);
+    }
+    {
+        // beq x7 x0 24 / jal x0 -20: sign-extended branch and jump offsets
+        MicroOp beq = MicroOp::fromInstruction(Instruction("00038C63"), 0);
+        assert(beq.type == InstType::B_TYPE && beq.branch && beq.imm == 24);
+        MicroOp jal = MicroOp::fromInstruction(Instruction("FEDFF06F"), 0);
+        assert(jal.type == InstType::J_TYPE && jal.imm == -20 && jal.regWrite);
+    }
+    {
+        MicroOp nop = MicroOp::nop();
+        assert(nop.type == InstType::NOP);
+        assert(nop.id   == -1);
+        assert(!nop.regWrite && nop.rd == 0);
+    }
+
+    {
+        // RV32C: common compressed encodings expand to their 32-bit forms and back.
+        const uint32_t pairs[][2] = {
+            {0x0505, 0x00150513},   // c.addi x10 1
+            {0x557D, 0xFFF00513},   // c.li x10 -1
+            {0x0001, 0x00000013},   // c.nop
+            {0x40C0, 0x0044A403},   // c.lw x8 4(x9)
+            {0xC188, 0x00A5A023},   // c.sw x10 0(x11)
+            {0x40B2, 0x00C12083},   // c.lwsp x1 12(x2)
+            {0xC606, 0x00112623},   // c.swsp x1 12(x2)
+            {0x1141, 0xFF010113},   // c.addi16sp -16
+            {0x0800, 0x01010413},   // c.addi4spn x8 x2 16
+            {0x852E, 0x00B00533},   // c.mv x10 x11
+            {0x952E, 0x00B50533},   // c.add x10 x11
+            {0x8082, 0x00008067},   // c.jr x1
+            {0xA001, 0x0000006F},   // c.j 0
+            {0xC101, 0x00050063},   // c.beqz x10 0
+        };
+        for (const auto &pair : pairs) {
+            assert(Compressed::expand(pair[0]) == pair[1]);
+            assert(Compressed::compress(pair[1]) == pair[0]);
+        }
+        // C.EBREAK, the all-zero halfword and floating-point C.FLW have no expansion.
+        assert(Compressed::expand(0x9002) == 0 && Compressed::expand(0x0000) == 0 && Compressed::expand(0x6000) == 0);
+        // Out of reach of any 16-bit form.
+        assert(Compressed::compress(0x7FF00513) == 0 && Compressed::compress(0x00B60533) == 0);
+
+        // Every halfword that compress() produces expands back to the same word,
+        // and decodes to the same micro-op apart from its size.
+        int roundTrips = 0;
+        for (uint32_t half = 0; half <= 0xFFFF; ++half) {
+            uint32_t word = Compressed::expand(half);
+            uint16_t again = word ? Compressed::compress(word) : 0;
+            if (!again)
+                continue;
+            assert(Compressed::expand(again) == word);
+            MicroOp c = MicroOp::fromCompressed(again, 3);
+            MicroOp w = MicroOp::fromInstruction(Instruction(word), 3);
+            assert(c.size == 2 && w.size == 4);
+            assert(c.type == w.type && c.rd == w.rd && c.rs1 == w.rs1 && c.rs2 == w.rs2 && c.imm == w.imm &&
+                   c.aluOp == w.aluOp && c.regWrite == w.regWrite && c.memRead == w.memRead);
+            roundTrips++;
+        }
+        assert(roundTrips > 28000);
+        const char *tokens[] = {"0505", "0x0505", "00150513", "505"};
+        assert(Compressed::isHalfwordToken(tokens[0], tokens[0] + 4));
+        assert(Compressed::isHalfwordToken(tokens[1], tokens[1] + 6));
+        assert(!Compressed::isHalfwordToken(tokens[2], tokens[2] + 8));
+        assert(!Compressed::isHalfwordToken(tokens[3], tokens[3] + 3));
+    }
+
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}
+// End of test_instruction.cpp
+// make test  (or: g++ test_instruction.cpp Instruction.cpp ControlUnit.cpp MicroOp.cpp Compressed.cpp -o test_instruction)
@@ -0,0 +1,104 @@
+// test_memory.cpp
+// Checks the sparse paged data memory: sign extension, accesses that span
+// pages, lazy allocation and comparisons against untouched memory. Also
+// checks the L1 cache timing model's hits, misses and replacement.
+#include <cassert>
+#include <iostream>
+#include "DataMemory.hpp"
+#include "Cache.hpp"
+
+int main() {
+    // -----------------------
+    // Aligned word/halfword/byte round trips with sign extension.
+    {
+        DataMemory mem;
+        mem.store(2, 0x100, 0x8081F0F1);              // sw
+        assert(mem.load(2, 0x100) == 0x8081F0F1);     // lw
+        assert(mem.load(0, 0x100) == 0xFFFFFFF1);     // lb
+        assert(mem.load(4, 0x100) == 0xF1);           // lbu
+        assert(mem.load(1, 0x102) == 0xFFFF8081);     // lh
+        assert(mem.load(5, 0x102) == 0x8081);         // lhu
+        mem.store(0, 0x101, 0x7F);                    // sb
+        assert(mem.load(2, 0x100) == 0x80817FF1);
+    }
+
+    // -----------------------
+    // Unaligned word spanning two pages, and addresses at the top of the space.
+    {
+        DataMemory mem;
+        mem.store(2, DataMemory::pageSize - 2, 0xAABBCCDD);
+        assert(mem.residentPages() == 2);
+        assert(mem.load(2, DataMemory::pageSize - 2) == 0xAABBCCDD);
+        assert(mem.load(5, DataMemory::pageSize) == 0xAABB);
+
+        mem.store(2, 0xFFFFFFFC, 0x12345678);
+        assert(mem.load(2, 0xFFFFFFFC) == 0x12345678);
+        assert(mem.residentPages() == 3);
+        assert(mem.pageFaults() == 3);
+    }
+
+    // -----------------------
+    // Loads never allocate; SD zero-fills the upper word.
+    {
+        DataMemory mem;
+        assert(mem.load(2, 0x40000000) == 0);
+        assert(mem.residentPages() == 0);
+        mem.store(2, 0x204, 0xFFFFFFFF);
+        mem.store(3, 0x200, 0x11223344);              // sd
+        assert(mem.load(2, 0x200) == 0x11223344);
+        assert(mem.load(2, 0x204) == 0);
+    }
+
+    // -----------------------
+    // A page of zeros equals a page that was never written; copies are deep.
+    {
+        DataMemory a, b;
+        a.store(2, 0x3000, 0);
+        assert(a == b);
+        DataMemory c = a;
+        c.store(0, 0x3001, 1);
+        assert(c != a);
+        assert(a.load(4, 0x3001) == 0);
+        c.clear();
+        assert(c == b && c.residentPages() == 0);
+    }
+
+    // -----------------------
+    // A 2-way, 2-set cache with 16-byte lines: LRU keeps the re-used line, FIFO
+    // evicts the oldest fill; dirty victims are written back.
+    {
+        CacheConfig cfg;
+        assert(Cache::parseConfig("size=64,ways=2,line=16,hit=1,miss=5", cfg));
+        Cache lru(cfg);
+        assert(lru.sets() == 2);
+        assert(lru.access(0x000, false) == 5);        // Set 0, tag 0.
+        assert(lru.access(0x00C, true) == 1);         // Same line, now dirty.
+        assert(lru.access(0x020, false) == 5);        // Set 0, tag 1.
+        assert(lru.access(0x004, false) == 1);        // Tag 0 becomes most recent.
+        assert(lru.access(0x040, false) == 5);        // Evicts tag 1.
+        assert(lru.access(0x000, false) == 1);
+        assert(lru.hitCount() == 3 && lru.missCount() == 3);
+        assert(lru.evictionCount() == 1 && lru.writebackCount() == 0);
+
+        assert(Cache::parseConfig("policy=fifo", cfg));
+        Cache fifo(cfg);
+        fifo.access(0x000, true);
+        fifo.access(0x020, false);
+        fifo.access(0x004, false);
+        assert(fifo.access(0x040, false) == 5);       // Evicts tag 0 (filled first), which is dirty.
+        assert(fifo.access(0x000, false) == 5);
+        assert(fifo.evictionCount() == 2 && fifo.writebackCount() == 1);
+
+        CacheConfig bad;
+        assert(!Cache::parseConfig("size=48", bad));
+        assert(!Cache::parseConfig("hit=4,miss=2", bad));
+        assert(!Cache::parseConfig("size=99999999999999999999K", bad));   // Rejected, not thrown.
+        assert(!Cache::parseConfig("size=1M,line=1M,ways=4096", bad));   // line * ways wraps to 0.
+        assert(!bad.enabled);
+        assert(Cache().access(0x1234, false) == 1);  // Disabled caches never stall.
+    }
+
+    std::cout << "All memory tests passed" << std::endl;
+    return 0;
+}
+// End of test_memory.cpp